@@ -0,0 +1,235 @@
+#include "PTBatchRunner.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	struct FPTBatchThresholds
+	{
+		float MaxAvgMs = 0.f;
+		float MaxP99Ms = 0.f;
+		float MinOnePercentLowFPS = 0.f;
+		int32 MaxHitchEpisodes = 0;
+		float MaxCVPercent = 0.f;
+
+		static FPTBatchThresholds FromCommandLine()
+		{
+			FPTBatchThresholds Out;
+			const TCHAR* CmdLine = FCommandLine::Get();
+			FParse::Value(CmdLine, TEXT("PTToolMaxAvgMs="), Out.MaxAvgMs);
+			FParse::Value(CmdLine, TEXT("PTToolMaxP99Ms="), Out.MaxP99Ms);
+			FParse::Value(CmdLine, TEXT("PTToolMinOnePercentLowFPS="), Out.MinOnePercentLowFPS);
+			FParse::Value(CmdLine, TEXT("PTToolMaxHitchEpisodes="), Out.MaxHitchEpisodes);
+			FParse::Value(CmdLine, TEXT("PTToolMaxCVPercent="), Out.MaxCVPercent);
+			return Out;
+		}
+
+		// Appends one message per crossed threshold
+		void Check(const FSampledGraphData& Node, TArray<FString>& OutFailures) const
+		{
+			const FPTGraphStatInfo& Info = Node.StatInfo;
+			if (MaxAvgMs > 0.f && Info.AvgFrameData.FrameMS > MaxAvgMs)
+			{
+				OutFailures.Add(FString::Printf(TEXT("avg frame %.2f ms > %.2f ms"), Info.AvgFrameData.FrameMS, MaxAvgMs));
+			}
+			if (MaxP99Ms > 0.f && Info.Percentiles.P99.FrameMS > MaxP99Ms)
+			{
+				OutFailures.Add(FString::Printf(TEXT("P99 frame %.2f ms > %.2f ms"), Info.Percentiles.P99.FrameMS, MaxP99Ms));
+			}
+			if (MinOnePercentLowFPS > 0.f && Info.Percentiles.OnePercentLowFPS < MinOnePercentLowFPS)
+			{
+				OutFailures.Add(FString::Printf(TEXT("1%% low %.1f FPS < %.1f FPS"), Info.Percentiles.OnePercentLowFPS, MinOnePercentLowFPS));
+			}
+			if (MaxHitchEpisodes > 0 && Node.Hitches.Episodes.Num() > MaxHitchEpisodes)
+			{
+				OutFailures.Add(FString::Printf(TEXT("%d hitch episodes > %d"), Node.Hitches.Episodes.Num(), MaxHitchEpisodes));
+			}
+		}
+
+		void CheckRepetitions(const FPTRepeatedNodeStats* Stats, TArray<FString>& OutFailures) const
+		{
+			if (Stats && MaxCVPercent > 0.f && Stats->NumPasses >= 2 && Stats->Curves[0].CVPercent > MaxCVPercent)
+			{
+				OutFailures.Add(FString::Printf(TEXT("frame avg CV %.1f%% over %d passes > %.1f%%"), Stats->Curves[0].CVPercent, Stats->NumPasses, MaxCVPercent));
+			}
+		}
+	};
+
+	TSharedRef<FJsonObject> MakeRepetitionSummary(const FPTRepeatedNodeStats& Stats)
+	{
+		auto MakeValue = [](const FPTRepeatedValueStats& Value)
+		{
+			TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetNumberField(TEXT("mean"), Value.MeanOfMeans);
+			Json->SetNumberField(TEXT("stdDev"), Value.StdDev);
+			Json->SetNumberField(TEXT("cvPercent"), Value.CVPercent);
+			Json->SetNumberField(TEXT("ci95Low"), Value.CILow);
+			Json->SetNumberField(TEXT("ci95High"), Value.CIHigh);
+			return MakeShared<FJsonValueObject>(Json);
+		};
+
+		TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetNumberField(TEXT("passes"), Stats.NumPasses);
+		Json->SetBoolField(TEXT("unstable"), Stats.bUnstable);
+		Json->SetField(TEXT("frameAvgMs"), MakeValue(Stats.Curves[0]));
+		Json->SetField(TEXT("gameAvgMs"), MakeValue(Stats.Curves[1]));
+		Json->SetField(TEXT("gpuAvgMs"), MakeValue(Stats.Curves[4]));
+		Json->SetField(TEXT("p99FrameMs"), MakeValue(Stats.FrameP99));
+		return Json;
+	}
+
+	TSharedRef<FJsonObject> MakeNodeSummary(const FSampledGraphData& Node, const TArray<FString>& Failures)
+	{
+		const FPTGraphStatInfo& Info = Node.StatInfo;
+		TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetStringField(TEXT("name"), Node.SplineName);
+		Json->SetBoolField(TEXT("passed"), Failures.Num() == 0);
+		Json->SetNumberField(TEXT("testTime"), Info.TestTime);
+		Json->SetNumberField(TEXT("samples"), Node.FrameData.Num());
+		Json->SetNumberField(TEXT("avgFrameMs"), Info.AvgFrameData.FrameMS);
+		Json->SetNumberField(TEXT("maxFrameMs"), Info.MaxFrameData.FrameMS);
+		Json->SetNumberField(TEXT("p50FrameMs"), Info.Percentiles.P50.FrameMS);
+		Json->SetNumberField(TEXT("p95FrameMs"), Info.Percentiles.P95.FrameMS);
+		Json->SetNumberField(TEXT("p99FrameMs"), Info.Percentiles.P99.FrameMS);
+		Json->SetNumberField(TEXT("onePercentLowFPS"), Info.Percentiles.OnePercentLowFPS);
+		Json->SetNumberField(TEXT("avgGameMs"), Info.AvgFrameData.GameMS);
+		Json->SetNumberField(TEXT("avgDrawMs"), Info.AvgFrameData.DrawMS);
+		Json->SetNumberField(TEXT("avgRHIMs"), Info.AvgFrameData.RHITMS);
+		Json->SetNumberField(TEXT("avgGPUMs"), Info.AvgFrameData.GPUMS);
+		Json->SetNumberField(TEXT("hitchEpisodes"), Node.Hitches.Episodes.Num());
+		Json->SetNumberField(TEXT("hitchFrames"), Node.Hitches.NumSpikeFrames);
+		if (Node.HasMemoryData())
+		{
+			TSharedRef<FJsonObject> Memory = MakeShared<FJsonObject>();
+			for (const FPTMemorySummary& Summary : FPTMemorySummary::Summarize(Node.MemoryColumns))
+			{
+				TSharedRef<FJsonObject> Column = MakeShared<FJsonObject>();
+				Column->SetNumberField(TEXT("minMB"), Summary.MinMB);
+				Column->SetNumberField(TEXT("maxMB"), Summary.MaxMB);
+				Column->SetNumberField(TEXT("growthMB"), Summary.GetGrowthMB());
+				Memory->SetObjectField(Summary.Name, Column);
+			}
+			Json->SetObjectField(TEXT("memory"), Memory);
+		}
+		if (Node.HasMetricData())
+		{
+			TSharedRef<FJsonObject> Metrics = MakeShared<FJsonObject>();
+			for (const FPTMetricSummary& Summary : FPTMetricSummary::Summarize(Node.MetricColumns, Node.MetricUnits, Node.IsBucketed() ? TConstArrayView<int32>(Node.BucketFrameCounts) : TConstArrayView<int32>()))
+			{
+				TSharedRef<FJsonObject> Column = MakeShared<FJsonObject>();
+				Column->SetStringField(TEXT("unit"), Summary.Unit);
+				Column->SetNumberField(TEXT("avg"), Summary.Avg);
+				Column->SetNumberField(TEXT("min"), Summary.Min);
+				Column->SetNumberField(TEXT("max"), Summary.Max);
+				Metrics->SetObjectField(Summary.Name, Column);
+			}
+			Json->SetObjectField(TEXT("metrics"), Metrics);
+		}
+		if (!Node.CsvProfilePath.IsEmpty())
+		{
+			Json->SetStringField(TEXT("csvProfile"), Node.CsvProfilePath);
+		}
+		if (!Node.TracePath.IsEmpty())
+		{
+			Json->SetStringField(TEXT("trace"), Node.TracePath);
+		}
+
+		TArray<TSharedPtr<FJsonValue>> FailureValues;
+		for (const FString& Failure : Failures)
+		{
+			FailureValues.Add(MakeShared<FJsonValueString>(Failure));
+		}
+		Json->SetArrayField(TEXT("failures"), FailureValues);
+		return Json;
+	}
+}
+
+bool FPTBatchRunner::IsEnabled()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("PTToolBatch"));
+}
+
+FString FPTBatchRunner::GetOutputDirectory()
+{
+	FString Dir;
+	FParse::Value(FCommandLine::Get(), TEXT("PTToolOutput="), Dir);
+	return Dir;
+}
+
+float FPTBatchRunner::GetTimeout()
+{
+	float Timeout = 0.f;
+	FParse::Value(FCommandLine::Get(), TEXT("PTToolTimeout="), Timeout);
+	return FMath::Max(Timeout, 0.f);
+}
+
+int32 FPTBatchRunner::GetRepetitions()
+{
+	int32 Repetitions = 1;
+	FParse::Value(FCommandLine::Get(), TEXT("PTToolRepeat="), Repetitions);
+	return FMath::Max(Repetitions, 1);
+}
+
+FPTBatchRunner::EExitCode FPTBatchRunner::Finish(TConstArrayView<FSampledGraphData> Nodes, const FString& CaptureFile, bool bCaptureWritten, const FString& MapName,
+	TConstArrayView<FPTRepeatedNodeStats> Repetitions)
+{
+	const FPTBatchThresholds Thresholds = FPTBatchThresholds::FromCommandLine();
+
+	EExitCode ExitCode = Nodes.Num() == 0 ? NoNodes : Passed;
+	TArray<TSharedPtr<FJsonValue>> NodeValues;
+	for (const FSampledGraphData& Node : Nodes)
+	{
+		const FPTRepeatedNodeStats* NodeRepetitions = Repetitions.FindByPredicate([&Node](const FPTRepeatedNodeStats& R) { return R.SplineName == Node.SplineName; });
+		TArray<FString> Failures;
+		Thresholds.Check(Node, Failures);
+		Thresholds.CheckRepetitions(NodeRepetitions, Failures);
+		for (const FString& Failure : Failures)
+		{
+			UE_LOG(LogTemp, Error, TEXT("PTToolBatch: %s failed: %s"), *Node.SplineName, *Failure);
+		}
+		if (Failures.Num() > 0)
+		{
+			ExitCode = ThresholdFailed;
+		}
+		TSharedRef<FJsonObject> NodeJson = MakeNodeSummary(Node, Failures);
+		if (NodeRepetitions)
+		{
+			NodeJson->SetObjectField(TEXT("repetitions"), MakeRepetitionSummary(*NodeRepetitions));
+		}
+		NodeValues.Add(MakeShared<FJsonValueObject>(NodeJson));
+	}
+	if (!bCaptureWritten)
+	{
+		ExitCode = WriteFailed;
+	}
+
+	TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+	Summary->SetStringField(TEXT("map"), MapName);
+	Summary->SetStringField(TEXT("capture"), bCaptureWritten ? FPaths::GetCleanFilename(CaptureFile) : FString());
+	Summary->SetNumberField(TEXT("exitCode"), ExitCode);
+	Summary->SetArrayField(TEXT("nodes"), NodeValues);
+
+	FString SummaryText;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SummaryText);
+	FJsonSerializer::Serialize(Summary, Writer);
+
+	const FString SummaryFile = FPaths::ChangeExtension(CaptureFile, TEXT(".summary.json"));
+	if (!FFileHelper::SaveStringToFile(SummaryText, *SummaryFile, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogTemp, Error, TEXT("PTToolBatch: cannot write %s"), *SummaryFile);
+		return WriteFailed;
+	}
+	UE_LOG(LogTemp, Log, TEXT("PTToolBatch: summary written to %s"), *SummaryFile);
+	return ExitCode;
+}
+
+void FPTBatchRunner::RequestExit(EExitCode ExitCode)
+{
+	UE_LOG(LogTemp, Display, TEXT("PTToolBatch: exiting with code %d"), (int32)ExitCode);
+	FPlatformMisc::RequestExitWithStatus(false, (uint8)ExitCode);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTDataType.h"
+#include "PTRepetitionStats.h"
+
+/**
+ * Unattended batch runs: the game mode runs every PTTool_Generated spline as usual, then writes the capture and
+ * a JSON summary and quits with an exit code instead of opening the analyzer window. Example (one map per run):
+ *
+ *   UnrealEditor <Project>.uproject /Game/Maps/MyMap?game=/Script/PTTool.PTGameMode -game -PTToolBatch
+ *       -nullrhi -unattended -nosound -PTToolOutput=/tmp/ptcaps -PTToolMaxP99Ms=40 -PTToolMaxHitchEpisodes=5
+ *
+ * Thresholds (all optional, checked per node, 0 / missing disables):
+ *   -PTToolMaxAvgMs=      average frame time
+ *   -PTToolMaxP99Ms=      P99 frame time
+ *   -PTToolMinOnePercentLowFPS=
+ *   -PTToolMaxHitchEpisodes=
+ *   -PTToolMaxCVPercent=  run-to-run CV of the average frame time (with -PTToolRepeat)
+ *   -PTToolTimeout=       seconds before the run is aborted
+ *
+ * -PTToolRepeat=N runs the whole test plan N times (also outside batch mode); every pass is written to its own
+ * capture and the summary gets per-node repetition statistics.
+ */
+class FPTBatchRunner
+{
+public:
+	enum EExitCode : uint8
+	{
+		Passed = 0,
+		ThresholdFailed = 1,
+		NoNodes = 2,
+		TimedOut = 3,
+		WriteFailed = 4,
+	};
+
+	// -PTToolBatch on the command line
+	static bool IsEnabled();
+
+	// -PTToolOutput, empty when the default capture directory should be used
+	static FString GetOutputDirectory();
+
+	// -PTToolTimeout in seconds, 0 when not set
+	static float GetTimeout();
+
+	// -PTToolRepeat, at least 1
+	static int32 GetRepetitions();
+
+	// Checks thresholds, writes <CaptureFile>.summary.json and returns the process exit code.
+	// Repetitions, when the plan ran several times, are per node aggregates over all passes.
+	static EExitCode Finish(TConstArrayView<FSampledGraphData> Nodes, const FString& CaptureFile, bool bCaptureWritten, const FString& MapName,
+		TConstArrayView<FPTRepeatedNodeStats> Repetitions = TConstArrayView<FPTRepeatedNodeStats>());
+
+	// Logs the result and asks the engine to quit with ExitCode
+	static void RequestExit(EExitCode ExitCode);
+};
@@ -0,0 +1,274 @@
+#include "PTCaptureComparison.h"
+#include "PTStatistics.h"
+#include <cmath>
+
+namespace
+{
+	// Every Stride-th value, so at most MaxSamples values go into the rank test
+	void StridedCopy(TConstArrayView<float> In, int32 MaxSamples, TArray<float>& Out)
+	{
+		const int32 Stride = FMath::Max(1, FMath::DivideAndRoundUp(In.Num(), FMath::Max(MaxSamples, 1)));
+		Out.Reset(In.Num() / Stride + 1);
+		for (int32 i = 0; i < In.Num(); i += Stride)
+		{
+			Out.Add(In[i]);
+		}
+	}
+
+	const FSampledFrameData* GetPercentileRows(const FPTFramePercentiles& P, int32 Rank)
+	{
+		const FSampledFrameData* Rows[] = { &P.P50, &P.P90, &P.P95, &P.P99, &P.P999 };
+		return Rows[Rank];
+	}
+}
+
+double FPTCaptureComparison::MannWhitney(TConstArrayView<float> A, TConstArrayView<float> B, double& OutZ, double& OutProbabilityOfSuperiority)
+{
+	OutZ = 0.0;
+	OutProbabilityOfSuperiority = 0.5;
+	const int64 N1 = A.Num();
+	const int64 N2 = B.Num();
+	if (N1 == 0 || N2 == 0)
+	{
+		return 1.0;
+	}
+
+	// (value, from A) pairs ranked together
+	TArray<TPair<float, bool>> Pooled;
+	Pooled.Reserve(A.Num() + B.Num());
+	for (float V : A)
+	{
+		Pooled.Emplace(V, true);
+	}
+	for (float V : B)
+	{
+		Pooled.Emplace(V, false);
+	}
+	Pooled.Sort([](const TPair<float, bool>& L, const TPair<float, bool>& R) { return L.Key < R.Key; });
+
+	// Average ranks over ties, sum of A's ranks, and the tie correction term
+	double RankSumA = 0.0;
+	double TieTerm = 0.0;
+	for (int32 i = 0; i < Pooled.Num();)
+	{
+		int32 j = i + 1;
+		while (j < Pooled.Num() && Pooled[j].Key == Pooled[i].Key)
+		{
+			++j;
+		}
+		const double AvgRank = 0.5 * (i + 1 + j); // ranks i+1..j
+		for (int32 k = i; k < j; ++k)
+		{
+			if (Pooled[k].Value)
+			{
+				RankSumA += AvgRank;
+			}
+		}
+		const double T = j - i;
+		TieTerm += T * T * T - T;
+		i = j;
+	}
+
+	const double N = (double)(N1 + N2);
+	const double U1 = RankSumA - 0.5 * N1 * (N1 + 1);
+	const double MeanU = 0.5 * N1 * N2;
+	const double VarU = (double)N1 * N2 / 12.0 * ((N + 1.0) - TieTerm / (N * (N - 1.0)));
+	OutProbabilityOfSuperiority = U1 / ((double)N1 * N2);
+	if (VarU <= 0.0)
+	{
+		return 1.0;
+	}
+
+	// Continuity correction toward the mean
+	const double Diff = U1 - MeanU;
+	OutZ = (Diff - 0.5 * FMath::Sign(Diff)) / FMath::Sqrt(VarU);
+	return std::erfc(FMath::Abs(OutZ) / UE_DOUBLE_SQRT_2);
+}
+
+void FPTCaptureComparison::ComputePathFractions(const FSampledGraphData& Node, TArray<float>& OutFractions)
+{
+	const int32 Num = Node.FrameData.Num();
+	OutFractions.SetNumUninitialized(Num + 1);
+	double Cum = 0.0;
+
+	// Recorded camera path: place along the spline, independent of speed and frame rate
+	if (Node.HasPathData())
+	{
+		TArray<double> Travelled;
+		Node.PathData.ComputeTravelledDistance(Travelled);
+		for (int32 i = 0; i <= Num; ++i)
+		{
+			OutFractions[i] = (float)Travelled[i];
+		}
+		Cum = Travelled[Num];
+	}
+	else
+	{
+		const TConstArrayView<float> FrameColumn = Node.FrameData.GetCurve(0);
+		const bool bBucketed = Node.IsBucketed();
+		const bool bDecimated = !bBucketed && Node.SamplingMode != EPTSamplingMode::EveryFrame && Node.SamplingInterval > 0.f;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			OutFractions[i] = (float)Cum;
+			Cum += bDecimated ? Node.SamplingInterval * 1000.0
+				: bBucketed ? (double)FrameColumn[i] * Node.BucketFrameCounts[i]
+				: FrameColumn[i];
+		}
+		OutFractions[Num] = (float)Cum;
+	}
+
+	const double InvTotal = Cum > 0.0 ? 1.0 / Cum : 0.0;
+	for (float& Fraction : OutFractions)
+	{
+		Fraction = (float)(Fraction * InvTotal);
+	}
+}
+
+FPTNodeComparison FPTCaptureComparison::CompareNodes(const FSampledGraphData& Baseline, const FSampledGraphData& Candidate, const FPTComparisonSettings& Settings)
+{
+	FPTNodeComparison Out;
+	Out.SplineName = Candidate.SplineName;
+
+	TArray<float> BaseSamples;
+	TArray<float> CandSamples;
+	for (int32 c = 0; c < PTFrameCurveNum; ++c)
+	{
+		FPTCurveComparison& Curve = Out.Curves[c];
+		Curve.BaselineAvg = Baseline.StatInfo.AvgFrameData.*PTFrameCurveMembers[c];
+		Curve.CandidateAvg = Candidate.StatInfo.AvgFrameData.*PTFrameCurveMembers[c];
+		Curve.DeltaAvg = Curve.CandidateAvg - Curve.BaselineAvg;
+		Curve.DeltaPercent = Curve.BaselineAvg > KINDA_SMALL_NUMBER ? Curve.DeltaAvg * 100.f / Curve.BaselineAvg : 0.f;
+
+		for (int32 p = 0; p < UE_ARRAY_COUNT(Curve.PercentileShift); ++p)
+		{
+			Curve.BaselinePercentiles[p] = GetPercentileRows(Baseline.StatInfo.Percentiles, p)->*PTFrameCurveMembers[c];
+			Curve.CandidatePercentiles[p] = GetPercentileRows(Candidate.StatInfo.Percentiles, p)->*PTFrameCurveMembers[c];
+			Curve.PercentileShift[p] = Curve.CandidatePercentiles[p] - Curve.BaselinePercentiles[p];
+		}
+
+		StridedCopy(Baseline.FrameData.GetCurve(c), Settings.MaxTestSamples, BaseSamples);
+		StridedCopy(Candidate.FrameData.GetCurve(c), Settings.MaxTestSamples, CandSamples);
+		Curve.PValue = MannWhitney(CandSamples, BaseSamples, Curve.ZScore, Curve.ProbabilityOfSuperiority);
+		Curve.bSignificant = Curve.PValue < Settings.Alpha;
+		Curve.bRegression = Curve.bSignificant && Curve.DeltaPercent > Settings.MinEffectPercent;
+	}
+
+	// Frame time per slice of the path, to show where in the level a change happened
+	const int32 NumBins = FMath::Max(Settings.NumPathBins, 1);
+	Out.PathBins.SetNum(NumBins);
+	for (int32 b = 0; b < NumBins; ++b)
+	{
+		Out.PathBins[b].StartFraction = (float)b / NumBins;
+		Out.PathBins[b].EndFraction = (float)(b + 1) / NumBins;
+	}
+
+	// Both sides recorded the camera path: bins are slices of spline distance, up to the furthest sample of either
+	const bool bByDistance = Baseline.HasPathData() && Candidate.HasPathData();
+	const float PathLength = bByDistance
+		? FMath::Max(FPTColumnKernels::MinMax(Baseline.PathData.GetColumn(FPTPathColumns::Distance)).Max,
+		             FPTColumnKernels::MinMax(Candidate.PathData.GetColumn(FPTPathColumns::Distance)).Max)
+		: 0.f;
+
+	auto AccumulateBins = [&Out, NumBins, bByDistance, PathLength](const FSampledGraphData& Node, bool bCandidate)
+	{
+		const TConstArrayView<float> FrameColumn = Node.FrameData.GetCurve(0);
+		TArray<double> Sums;
+		Sums.Init(0.0, NumBins);
+		TArray<int32> Counts;
+		Counts.Init(0, NumBins);
+		if (bByDistance)
+		{
+			// One sample range per loop through the slice, by binary search in the distance index
+			TArray<FPTPathColumns::FRun> Ranges;
+			for (int32 b = 0; b < NumBins; ++b)
+			{
+				const float MaxDistance = b == NumBins - 1 ? FLT_MAX : PathLength * (b + 1) / NumBins;
+				Node.PathData.FindSampleRanges(PathLength * b / NumBins, MaxDistance, Ranges);
+				for (const FPTPathColumns::FRun& Range : Ranges)
+				{
+					const int32 Count = Range.Last - Range.First + 1;
+					Sums[b] += FPTColumnKernels::Sum(FrameColumn.Slice(Range.First, Count));
+					Counts[b] += Count;
+				}
+			}
+		}
+		else
+		{
+			TArray<float> Fractions;
+			ComputePathFractions(Node, Fractions);
+			for (int32 i = 0; i < FrameColumn.Num(); ++i)
+			{
+				const int32 Bin = FMath::Clamp(FMath::FloorToInt(Fractions[i] * NumBins), 0, NumBins - 1);
+				Sums[Bin] += FrameColumn[i];
+				++Counts[Bin];
+			}
+		}
+		for (int32 b = 0; b < NumBins; ++b)
+		{
+			FPTPathBinComparison& Bin = Out.PathBins[b];
+			const float Mean = Counts[b] > 0 ? (float)(Sums[b] / Counts[b]) : 0.f;
+			(bCandidate ? Bin.CandidateFrameMs : Bin.BaselineFrameMs) = Mean;
+			(bCandidate ? Bin.CandidateSamples : Bin.BaselineSamples) = Counts[b];
+		}
+	};
+	AccumulateBins(Baseline, false);
+	AccumulateBins(Candidate, true);
+
+	float WorstDelta = 0.f;
+	for (int32 b = 0; b < NumBins; ++b)
+	{
+		const FPTPathBinComparison& Bin = Out.PathBins[b];
+		const float Delta = Bin.CandidateFrameMs - Bin.BaselineFrameMs;
+		if (Bin.BaselineSamples > 0 && Bin.CandidateSamples > 0 && Delta > WorstDelta)
+		{
+			WorstDelta = Delta;
+			Out.WorstBin = b;
+		}
+	}
+	return Out;
+}
+
+TArray<FPTNodeComparison> FPTCaptureComparison::Compare(TConstArrayView<FSampledGraphData> Baseline, TConstArrayView<FSampledGraphData> Candidate, const FPTComparisonSettings& Settings)
+{
+	TArray<FPTNodeComparison> Out;
+	for (int32 CandIndex = 0; CandIndex < Candidate.Num(); ++CandIndex)
+	{
+		const FSampledGraphData& CandNode = Candidate[CandIndex];
+		const int32 BaseIndex = Baseline.IndexOfByPredicate([&CandNode](const FSampledGraphData& Node) { return Node.SplineName == CandNode.SplineName; });
+		if (BaseIndex == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("PTCompare: %s has no baseline node"), *CandNode.SplineName);
+			continue;
+		}
+
+		FPTNodeComparison& Comparison = Out.Add_GetRef(CompareNodes(Baseline[BaseIndex], CandNode, Settings));
+		Comparison.BaselineIndex = BaseIndex;
+		Comparison.CandidateIndex = CandIndex;
+		UE_LOG(LogTemp, Log, TEXT("PTCompare: %s"), *FormatNodeComparison(Comparison));
+	}
+	return Out;
+}
+
+FString FPTCaptureComparison::FormatNodeComparison(const FPTNodeComparison& Comparison)
+{
+	const FPTCurveComparison& Frame = Comparison.Curves[0];
+	FString Out = FString::Printf(TEXT("%s: Frame %+.2f ms (%+.1f%%) p=%.4f%s | P50 %+.2f | P95 %+.2f | P99 %+.2f"),
+		*Comparison.SplineName, Frame.DeltaAvg, Frame.DeltaPercent, Frame.PValue,
+		Frame.bRegression ? TEXT(" REGRESSION") : Frame.bSignificant ? TEXT(" significant") : TEXT(""),
+		Frame.PercentileShift[0], Frame.PercentileShift[2], Frame.PercentileShift[3]);
+
+	const TCHAR* CurveNames[] = { TEXT("Frame"), TEXT("Game"), TEXT("Draw"), TEXT("RHI"), TEXT("GPU") };
+	for (int32 c = 1; c < PTFrameCurveNum; ++c)
+	{
+		const FPTCurveComparison& Curve = Comparison.Curves[c];
+		Out += FString::Printf(TEXT(" | %s %+.2f%s"), CurveNames[c], Curve.DeltaAvg, Curve.bRegression ? TEXT("!") : TEXT(""));
+	}
+
+	if (Comparison.PathBins.IsValidIndex(Comparison.WorstBin))
+	{
+		const FPTPathBinComparison& Bin = Comparison.PathBins[Comparison.WorstBin];
+		Out += FString::Printf(TEXT(" | worst at %.0f-%.0f%% of path %+.2f ms"),
+			Bin.StartFraction * 100.f, Bin.EndFraction * 100.f, Bin.CandidateFrameMs - Bin.BaselineFrameMs);
+	}
+	return Out;
+}
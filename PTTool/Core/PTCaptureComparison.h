@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTDataType.h"
+
+// Baseline vs candidate numbers for one curve of one node
+struct FPTCurveComparison
+{
+	float BaselineAvg = 0.f;
+	float CandidateAvg = 0.f;
+	float DeltaAvg = 0.f;          // candidate - baseline, ms
+	float DeltaPercent = 0.f;      // relative to the baseline average
+
+	// P50, P90, P95, P99, P99.9 of each side and their shift (candidate - baseline)
+	float BaselinePercentiles[5] = {};
+	float CandidatePercentiles[5] = {};
+	float PercentileShift[5] = {};
+
+	// Two-sided Mann-Whitney U test on the samples (normal approximation with tie correction)
+	double ZScore = 0.0;
+	double PValue = 1.0;
+	// P(candidate sample > baseline sample); 0.5 means no shift
+	double ProbabilityOfSuperiority = 0.5;
+	bool bSignificant = false;
+	// Significant and slower than the baseline by more than FPTComparisonSettings::MinEffectPercent
+	bool bRegression = false;
+};
+
+// Mean frame time of baseline and candidate in one slice of the path
+struct FPTPathBinComparison
+{
+	float StartFraction = 0.f;
+	float EndFraction = 0.f;
+	float BaselineFrameMs = 0.f;
+	float CandidateFrameMs = 0.f;
+	int32 BaselineSamples = 0;
+	int32 CandidateSamples = 0;
+};
+
+struct FPTNodeComparison
+{
+	FString SplineName;
+	int32 BaselineIndex = INDEX_NONE;
+	int32 CandidateIndex = INDEX_NONE;
+	FPTCurveComparison Curves[5];
+	TArray<FPTPathBinComparison> PathBins;
+	// PathBins index with the largest frame-time increase, INDEX_NONE when no bin got slower
+	int32 WorstBin = INDEX_NONE;
+
+	bool HasRegression() const
+	{
+		for (const FPTCurveComparison& Curve : Curves)
+		{
+			if (Curve.bRegression)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+struct FPTComparisonSettings
+{
+	double Alpha = 0.01;
+	float MinEffectPercent = 2.f;
+	int32 NumPathBins = 50;
+	// Samples per side fed to the rank test; longer captures are strided down to this
+	int32 MaxTestSamples = 200000;
+};
+
+/**
+ * Compares a candidate capture against a baseline. Nodes are matched by spline name; inside a node samples are
+ * aligned by their position along the path. When both sides have path columns, PathBins are slices of the spline
+ * distance, looked up through the FPTPathColumns distance index, so every loop of either run lands in the bin of
+ * the same place in the level. Otherwise they are slices of the node's sampled time (assumes constant SplineVelocity).
+ * Runs with different speeds, frame rates, loop counts or sampling modes line up.
+ *
+ * Frames within a run are autocorrelated, so p-values are optimistic; bRegression also requires MinEffectPercent.
+ */
+class FPTCaptureComparison
+{
+public:
+	static TArray<FPTNodeComparison> Compare(TConstArrayView<FSampledGraphData> Baseline, TConstArrayView<FSampledGraphData> Candidate, const FPTComparisonSettings& Settings = FPTComparisonSettings());
+
+	static FPTNodeComparison CompareNodes(const FSampledGraphData& Baseline, const FSampledGraphData& Candidate, const FPTComparisonSettings& Settings = FPTComparisonSettings());
+
+	// Start of each sample along the path in [0, 1), plus 1 at the end (Num() + 1 entries)
+	static void ComputePathFractions(const FSampledGraphData& Node, TArray<float>& OutFractions);
+
+	// Mann-Whitney U on two samples; returns the two-sided p-value
+	static double MannWhitney(TConstArrayView<float> A, TConstArrayView<float> B, double& OutZ, double& OutProbabilityOfSuperiority);
+
+	// One line per node: "Name: Frame +1.20 ms (+7.5%) p=0.0001 REGRESSION | P99 +3.10 | worst at 40-42% +6.00 ms"
+	static FString FormatNodeComparison(const FPTNodeComparison& Comparison);
+};
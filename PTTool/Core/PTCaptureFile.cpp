@@ -0,0 +1,566 @@
+#include "PTCaptureFile.h"
+#include "PTStatistics.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+
+namespace
+{
+	// Owns the mapping; nodes opened from the file hold it through their column Backing pointers
+	struct FPTMappedCapture
+	{
+		TUniquePtr<IMappedFileHandle> Handle;
+		TUniquePtr<IMappedFileRegion> Region;
+	};
+
+	void CurvesToFloats(const FSampledFrameData& In, float (&Out)[PTCaptureFormat::NumCurves])
+	{
+		for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+		{
+			Out[c] = In.*PTFrameCurveMembers[c];
+		}
+	}
+
+	FSampledFrameData FloatsToCurves(const float (&In)[PTCaptureFormat::NumCurves])
+	{
+		FSampledFrameData Out;
+		for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+		{
+			Out.*PTFrameCurveMembers[c] = In[c];
+		}
+		return Out;
+	}
+
+	FPTCaptureStatBlock MakeStatBlock(const FPTGraphStatInfo& Info)
+	{
+		FPTCaptureStatBlock Block;
+		CurvesToFloats(Info.AvgFrameData, Block.Avg);
+		CurvesToFloats(Info.MaxFrameData, Block.Max);
+		CurvesToFloats(Info.MinFrameData, Block.Min);
+		CurvesToFloats(Info.StdDevFrameData, Block.StdDev);
+		const FSampledFrameData* Ranks[PTCaptureFormat::NumPercentiles] = { &Info.Percentiles.P50, &Info.Percentiles.P90, &Info.Percentiles.P95, &Info.Percentiles.P99, &Info.Percentiles.P999 };
+		for (int32 p = 0; p < PTCaptureFormat::NumPercentiles; ++p)
+		{
+			CurvesToFloats(*Ranks[p], Block.Percentiles[p]);
+		}
+		Block.OnePercentLowFPS = Info.Percentiles.OnePercentLowFPS;
+		Block.bExactPercentiles = Info.Percentiles.bExact ? 1 : 0;
+		Block.SamplerOverheadAvgUs = Info.SamplerOverheadAvgUs;
+		Block.SamplerOverheadMaxUs = Info.SamplerOverheadMaxUs;
+		return Block;
+	}
+
+	void ReadStatBlock(const FPTCaptureStatBlock& Block, float TestTime, FPTGraphStatInfo& Out)
+	{
+		Out.TestTime = TestTime;
+		Out.AvgFrameData = FloatsToCurves(Block.Avg);
+		Out.MaxFrameData = FloatsToCurves(Block.Max);
+		Out.MinFrameData = FloatsToCurves(Block.Min);
+		Out.StdDevFrameData = FloatsToCurves(Block.StdDev);
+		FSampledFrameData* Ranks[PTCaptureFormat::NumPercentiles] = { &Out.Percentiles.P50, &Out.Percentiles.P90, &Out.Percentiles.P95, &Out.Percentiles.P99, &Out.Percentiles.P999 };
+		for (int32 p = 0; p < PTCaptureFormat::NumPercentiles; ++p)
+		{
+			*Ranks[p] = FloatsToCurves(Block.Percentiles[p]);
+		}
+		Out.Percentiles.OnePercentLowFPS = Block.OnePercentLowFPS;
+		Out.Percentiles.bExact = Block.bExactPercentiles != 0;
+		Out.SamplerOverheadAvgUs = Block.SamplerOverheadAvgUs;
+		Out.SamplerOverheadMaxUs = Block.SamplerOverheadMaxUs;
+	}
+
+	FPTCaptureHitchBlock MakeHitchBlock(const FPTHitchReport& Report)
+	{
+		FPTCaptureHitchBlock Block;
+		for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+		{
+			Block.ThresholdMs[c] = Report.ThresholdMs[c];
+			Block.SpikeCount[c] = Report.SpikeCount[c];
+			Block.SpikeTimeMs[c] = Report.SpikeTimeMs[c];
+			Block.TotalTimeMs[c] = Report.TotalTimeMs[c];
+		}
+		Block.NumSpikeFrames = Report.NumSpikeFrames;
+		Block.NumDroppedEvents = Report.NumDroppedEvents;
+		return Block;
+	}
+
+	void ReadHitchBlock(const FPTCaptureHitchBlock& Block, FPTHitchReport& Out)
+	{
+		for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+		{
+			Out.ThresholdMs[c] = Block.ThresholdMs[c];
+			Out.SpikeCount[c] = Block.SpikeCount[c];
+			Out.SpikeTimeMs[c] = Block.SpikeTimeMs[c];
+			Out.TotalTimeMs[c] = Block.TotalTimeMs[c];
+		}
+		Out.NumSpikeFrames = Block.NumSpikeFrames;
+		Out.NumDroppedEvents = Block.NumDroppedEvents;
+	}
+
+	void WritePadding(FArchive& Ar)
+	{
+		static const uint8 Zeros[PTCaptureFormat::ColumnAlignment] = {};
+		const int64 Pad = Align(Ar.Tell(), (int64)PTCaptureFormat::ColumnAlignment) - Ar.Tell();
+		if (Pad > 0)
+		{
+			Ar.Serialize((void*)Zeros, Pad);
+		}
+	}
+
+	void WriteString(FArchive& Ar, const FString& Str)
+	{
+		FTCHARToUTF8 Utf8(*Str);
+		uint32 Len = (uint32)Utf8.Length();
+		Ar << Len;
+		Ar.Serialize((void*)Utf8.Get(), Len);
+	}
+
+	void WriteColumn(FArchive& Ar, TConstArrayView<float> Column)
+	{
+		Ar.Serialize((void*)Column.GetData(), Column.Num() * sizeof(float));
+		WritePadding(Ar);
+	}
+
+	void WriteColumn(FArchive& Ar, TConstArrayView<int32> Column)
+	{
+		Ar.Serialize((void*)Column.GetData(), Column.Num() * sizeof(int32));
+		WritePadding(Ar);
+	}
+
+	void WriteNode(FArchive& Ar, const FSampledGraphData& Node, FPTCaptureNodeEntry& OutEntry)
+	{
+		WritePadding(Ar);
+		const int64 NodeStart = Ar.Tell();
+
+		// Written raw: zeroed first so padding and reserved fields are deterministic
+		FPTCaptureNodeHeader Header;
+		FMemory::Memzero(Header);
+		Header.NumFrames = (uint32)Node.FrameData.Num();
+		Header.NumThreads = (uint32)Node.ThreadTimings.NumThreads();
+		Header.NumThreadFrames = (uint32)Node.ThreadTimings.NumFrames;
+		Header.NumSmoothedFrames = Node.SmoothedFrameData.Num() == Node.FrameData.Num() ? (uint32)Node.SmoothedFrameData.Num() : 0;
+		Header.TestTime = Node.StatInfo.TestTime;
+		Header.SamplingMode = (uint32)Node.SamplingMode;
+		Header.SamplingInterval = Node.SamplingInterval;
+		Header.Stats = MakeStatBlock(Node.StatInfo);
+		Header.Hitches = MakeHitchBlock(Node.Hitches);
+		Header.NumHitchEvents = (uint32)Node.Hitches.Events.Num();
+		Header.NumHitchEpisodes = (uint32)Node.Hitches.Episodes.Num();
+		Header.NumPathSamples = Node.HasPathData() ? (uint32)Node.PathData.Num() : 0;
+		Header.NumMemoryColumns = Node.HasMemoryData() ? (uint32)Node.MemoryColumns.NumThreads() : 0;
+		Header.NumMetricColumns = Node.HasMetricData() ? (uint32)Node.MetricColumns.NumThreads() : 0;
+
+		// Placeholder, patched once the offsets are known
+		Ar.Serialize(&Header, sizeof(Header));
+
+		Header.StringsOffset = Ar.Tell() - NodeStart;
+		WriteString(Ar, Node.SplineName);
+		for (const FString& ThreadName : Node.ThreadTimings.ThreadNames)
+		{
+			WriteString(Ar, ThreadName);
+		}
+		WriteString(Ar, Node.CsvProfilePath);
+		WriteString(Ar, Node.TracePath);
+		for (uint32 m = 0; m < Header.NumMemoryColumns; ++m)
+		{
+			WriteString(Ar, Node.MemoryColumns.ThreadNames[m]);
+		}
+		for (uint32 m = 0; m < Header.NumMetricColumns; ++m)
+		{
+			WriteString(Ar, Node.MetricColumns.ThreadNames[m]);
+		}
+		for (uint32 m = 0; m < Header.NumMetricColumns; ++m)
+		{
+			WriteString(Ar, Node.MetricUnits.IsValidIndex(m) ? Node.MetricUnits[m] : FString());
+		}
+		WritePadding(Ar);
+
+		Header.CurvesOffset = Ar.Tell() - NodeStart;
+		for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+		{
+			WriteColumn(Ar, Node.FrameData.GetCurve(c));
+		}
+
+		Header.SmoothedCurvesOffset = Ar.Tell() - NodeStart;
+		for (int32 c = 0; c < PTCaptureFormat::NumCurves && Header.NumSmoothedFrames > 0; ++c)
+		{
+			WriteColumn(Ar, Node.SmoothedFrameData.GetCurve(c));
+		}
+
+		Header.ThreadsOffset = Ar.Tell() - NodeStart;
+		for (int32 ThreadId = 0; ThreadId < Node.ThreadTimings.NumThreads(); ++ThreadId)
+		{
+			WriteColumn(Ar, Node.ThreadTimings.GetColumn(ThreadId));
+		}
+
+		if (Node.IsBucketed())
+		{
+			Header.BucketMinOffset = Ar.Tell() - NodeStart;
+			for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+			{
+				WriteColumn(Ar, Node.BucketMin.GetCurve(c));
+			}
+			Header.BucketMaxOffset = Ar.Tell() - NodeStart;
+			for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+			{
+				WriteColumn(Ar, Node.BucketMax.GetCurve(c));
+			}
+			Header.BucketCountsOffset = Ar.Tell() - NodeStart;
+			WriteColumn(Ar, TConstArrayView<int32>(Node.BucketFrameCounts));
+		}
+		else if (Header.SamplingMode == (uint32)EPTSamplingMode::Bucketed)
+		{
+			// Bucket columns missing or mismatched; keep the means only
+			Header.SamplingMode = (uint32)EPTSamplingMode::Decimated;
+		}
+
+		Header.HitchEventsOffset = Ar.Tell() - NodeStart;
+		Ar.Serialize((void*)Node.Hitches.Events.GetData(), Node.Hitches.Events.Num() * sizeof(FPTHitchEvent));
+		WritePadding(Ar);
+		Header.HitchEpisodesOffset = Ar.Tell() - NodeStart;
+		Ar.Serialize((void*)Node.Hitches.Episodes.GetData(), Node.Hitches.Episodes.Num() * sizeof(FPTHitchEpisode));
+		WritePadding(Ar);
+
+		Header.PathOffset = Ar.Tell() - NodeStart;
+		for (int32 c = 0; c < FPTPathColumns::NumColumns && Header.NumPathSamples > 0; ++c)
+		{
+			WriteColumn(Ar, Node.PathData.GetColumn(c));
+		}
+
+		Header.MemoryOffset = Ar.Tell() - NodeStart;
+		for (uint32 m = 0; m < Header.NumMemoryColumns; ++m)
+		{
+			WriteColumn(Ar, Node.MemoryColumns.GetColumn(m));
+		}
+
+		Header.MetricOffset = Ar.Tell() - NodeStart;
+		for (uint32 m = 0; m < Header.NumMetricColumns; ++m)
+		{
+			WriteColumn(Ar, Node.MetricColumns.GetColumn(m));
+		}
+
+		const int64 NodeEnd = Ar.Tell();
+		Ar.Seek(NodeStart);
+		Ar.Serialize(&Header, sizeof(Header));
+		Ar.Seek(NodeEnd);
+
+		OutEntry.Offset = NodeStart;
+		OutEntry.Size = NodeEnd - NodeStart;
+	}
+
+	// Bounds-checked reads out of the mapped bytes
+	struct FMappedReader
+	{
+		const uint8* Data = nullptr;
+		uint64 Size = 0;
+
+		bool Contains(uint64 Offset, uint64 Bytes) const
+		{
+			return Offset <= Size && Bytes <= Size - Offset;
+		}
+
+		template <typename T>
+		bool Read(uint64 Offset, T& Out) const
+		{
+			if (!Contains(Offset, sizeof(T)))
+			{
+				return false;
+			}
+			FMemory::Memcpy(&Out, Data + Offset, sizeof(T));
+			return true;
+		}
+
+		bool ReadString(uint64& Offset, FString& Out) const
+		{
+			uint32 Len = 0;
+			if (!Read(Offset, Len) || !Contains(Offset + sizeof(uint32), Len))
+			{
+				return false;
+			}
+			const FUTF8ToTCHAR Conv((const ANSICHAR*)(Data + Offset + sizeof(uint32)), Len);
+			Out = FString(Conv.Length(), Conv.Get());
+			Offset += sizeof(uint32) + Len;
+			return true;
+		}
+	};
+}
+
+bool FPTCaptureFile::Write(const FString& Filename, TConstArrayView<FSampledGraphData> Nodes)
+{
+	const FString TempFilename = Filename + TEXT(".tmp");
+	TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*TempFilename));
+	if (!Ar)
+	{
+		UE_LOG(LogTemp, Error, TEXT("PTCapture: cannot open %s for writing"), *TempFilename);
+		return false;
+	}
+
+	FPTCaptureFileHeader Header;
+	Header.NumNodes = (uint32)Nodes.Num();
+	Ar->Serialize(&Header, sizeof(Header));
+
+	TArray<FPTCaptureNodeEntry> NodeTable;
+	NodeTable.SetNum(Nodes.Num());
+	for (int32 i = 0; i < Nodes.Num(); ++i)
+	{
+		WriteNode(*Ar, Nodes[i], NodeTable[i]);
+	}
+
+	WritePadding(*Ar);
+	Header.NodeTableOffset = Ar->Tell();
+	Ar->Serialize(NodeTable.GetData(), NodeTable.Num() * sizeof(FPTCaptureNodeEntry));
+
+	Ar->Seek(0);
+	Ar->Serialize(&Header, sizeof(Header));
+
+	const bool bWriteOk = !Ar->IsError() && Ar->Close();
+	Ar.Reset();
+
+	if (!bWriteOk || !IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+	{
+		UE_LOG(LogTemp, Error, TEXT("PTCapture: failed to write %s"), *Filename);
+		IFileManager::Get().Delete(*TempFilename);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("PTCapture: wrote %d node(s) to %s"), Nodes.Num(), *Filename);
+	return true;
+}
+
+bool FPTCaptureFile::Open(const FString& Filename, TArray<FSampledGraphData>& OutNodes, FString* OutError)
+{
+	OutNodes.Reset();
+
+	auto Fail = [&Filename, OutError](const TCHAR* Reason)
+	{
+		UE_LOG(LogTemp, Error, TEXT("PTCapture: %s: %s"), *Filename, Reason);
+		if (OutError)
+		{
+			*OutError = Reason;
+		}
+		return false;
+	};
+
+	TSharedRef<FPTMappedCapture> Mapped = MakeShared<FPTMappedCapture>();
+	Mapped->Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!Mapped->Handle || Mapped->Handle->GetFileSize() < (int64)sizeof(FPTCaptureFileHeader))
+	{
+		return Fail(TEXT("cannot map file"));
+	}
+	Mapped->Region.Reset(Mapped->Handle->MapRegion(0, Mapped->Handle->GetFileSize()));
+	if (!Mapped->Region)
+	{
+		return Fail(TEXT("cannot map file"));
+	}
+
+	FMappedReader Reader;
+	Reader.Data = Mapped->Region->GetMappedPtr();
+	Reader.Size = (uint64)Mapped->Region->GetMappedSize();
+
+	FPTCaptureFileHeader Header;
+	if (!Reader.Read(0, Header) || Header.Magic != PTCaptureFormat::Magic)
+	{
+		return Fail(TEXT("not a PTTool capture"));
+	}
+	if (Header.Version != PTCaptureFormat::Version)
+	{
+		return Fail(TEXT("unsupported capture version"));
+	}
+	if (!Reader.Contains(Header.NodeTableOffset, (uint64)Header.NumNodes * sizeof(FPTCaptureNodeEntry)))
+	{
+		return Fail(TEXT("node table out of range"));
+	}
+
+	const TSharedPtr<const void> Backing = Mapped;
+	OutNodes.Reserve(Header.NumNodes);
+
+	for (uint32 NodeIndex = 0; NodeIndex < Header.NumNodes; ++NodeIndex)
+	{
+		FPTCaptureNodeEntry Entry;
+		FPTCaptureNodeHeader NodeHeader;
+		Reader.Read(Header.NodeTableOffset + NodeIndex * sizeof(FPTCaptureNodeEntry), Entry);
+		if (!Reader.Contains(Entry.Offset, Entry.Size) || !Reader.Read(Entry.Offset, NodeHeader))
+		{
+			OutNodes.Reset();
+			return Fail(TEXT("node chunk out of range"));
+		}
+
+		const uint64 CurveStride = PTCaptureFormat::GetColumnStride(NodeHeader.NumFrames);
+		const uint64 ThreadStride = PTCaptureFormat::GetColumnStride(NodeHeader.NumThreadFrames);
+		const uint64 CurvesOffset = Entry.Offset + NodeHeader.CurvesOffset;
+		const uint64 SmoothedOffset = Entry.Offset + NodeHeader.SmoothedCurvesOffset;
+		const bool bHasSmoothed = NodeHeader.NumSmoothedFrames > 0;
+		const uint64 ThreadsOffset = Entry.Offset + NodeHeader.ThreadsOffset;
+		const bool bBucketed = NodeHeader.SamplingMode == (uint32)EPTSamplingMode::Bucketed;
+		const uint64 BucketMinOffset = Entry.Offset + NodeHeader.BucketMinOffset;
+		const uint64 BucketMaxOffset = Entry.Offset + NodeHeader.BucketMaxOffset;
+		const uint64 BucketCountsOffset = Entry.Offset + NodeHeader.BucketCountsOffset;
+		const uint64 HitchEventsOffset = Entry.Offset + NodeHeader.HitchEventsOffset;
+		const uint64 HitchEpisodesOffset = Entry.Offset + NodeHeader.HitchEpisodesOffset;
+		const bool bHasPath = NodeHeader.NumPathSamples > 0;
+		const uint64 PathOffset = Entry.Offset + NodeHeader.PathOffset;
+		const uint64 MemoryOffset = Entry.Offset + NodeHeader.MemoryOffset;
+		const uint64 MetricOffset = Entry.Offset + NodeHeader.MetricOffset;
+		if (NodeHeader.NumFrames > (uint32)MAX_int32 || NodeHeader.NumThreadFrames > (uint32)MAX_int32
+			|| (bHasSmoothed && NodeHeader.NumSmoothedFrames != NodeHeader.NumFrames)
+			|| !Reader.Contains(CurvesOffset, CurveStride * PTCaptureFormat::NumCurves)
+			|| (bHasSmoothed && (!Reader.Contains(SmoothedOffset, CurveStride * PTCaptureFormat::NumCurves) || (SmoothedOffset % PTCaptureFormat::ColumnAlignment) != 0))
+			|| !Reader.Contains(ThreadsOffset, ThreadStride * NodeHeader.NumThreads)
+			|| NodeHeader.SamplingMode > (uint32)EPTSamplingMode::Bucketed
+			|| !Reader.Contains(HitchEventsOffset, (uint64)NodeHeader.NumHitchEvents * sizeof(FPTHitchEvent))
+			|| !Reader.Contains(HitchEpisodesOffset, (uint64)NodeHeader.NumHitchEpisodes * sizeof(FPTHitchEpisode))
+			|| (bHasPath && (NodeHeader.NumPathSamples != NodeHeader.NumFrames
+				|| !Reader.Contains(PathOffset, CurveStride * FPTPathColumns::NumColumns) || (PathOffset % PTCaptureFormat::ColumnAlignment) != 0))
+			|| (NodeHeader.NumMemoryColumns > 0 && (!Reader.Contains(MemoryOffset, CurveStride * NodeHeader.NumMemoryColumns) || (MemoryOffset % PTCaptureFormat::ColumnAlignment) != 0))
+			|| (NodeHeader.NumMetricColumns > 0 && (!Reader.Contains(MetricOffset, CurveStride * NodeHeader.NumMetricColumns) || (MetricOffset % PTCaptureFormat::ColumnAlignment) != 0))
+			|| (bBucketed && (!Reader.Contains(BucketMinOffset, CurveStride * PTCaptureFormat::NumCurves)
+				|| !Reader.Contains(BucketMaxOffset, CurveStride * PTCaptureFormat::NumCurves)
+				|| !Reader.Contains(BucketCountsOffset, CurveStride)
+				|| (BucketMinOffset % PTCaptureFormat::ColumnAlignment) != 0 || (BucketMaxOffset % PTCaptureFormat::ColumnAlignment) != 0))
+			|| (CurvesOffset % PTCaptureFormat::ColumnAlignment) != 0 || (ThreadsOffset % PTCaptureFormat::ColumnAlignment) != 0)
+		{
+			OutNodes.Reset();
+			return Fail(TEXT("column data out of range"));
+		}
+
+		FSampledGraphData& Node = OutNodes.AddDefaulted_GetRef();
+		ReadStatBlock(NodeHeader.Stats, NodeHeader.TestTime, Node.StatInfo);
+		Node.SamplingMode = (EPTSamplingMode)NodeHeader.SamplingMode;
+		Node.SamplingInterval = NodeHeader.SamplingInterval;
+
+		// Hitch lists are short next to the columns, copy them out
+		ReadHitchBlock(NodeHeader.Hitches, Node.Hitches);
+		Node.Hitches.Events.SetNumUninitialized(NodeHeader.NumHitchEvents);
+		FMemory::Memcpy(Node.Hitches.Events.GetData(), Reader.Data + HitchEventsOffset, NodeHeader.NumHitchEvents * sizeof(FPTHitchEvent));
+		Node.Hitches.Episodes.SetNumUninitialized(NodeHeader.NumHitchEpisodes);
+		FMemory::Memcpy(Node.Hitches.Episodes.GetData(), Reader.Data + HitchEpisodesOffset, NodeHeader.NumHitchEpisodes * sizeof(FPTHitchEpisode));
+
+		uint64 StringCursor = Entry.Offset + NodeHeader.StringsOffset;
+		TArray<FString> ThreadNames;
+		ThreadNames.SetNum(NodeHeader.NumThreads);
+		bool bStringsOk = Reader.ReadString(StringCursor, Node.SplineName);
+		for (uint32 t = 0; t < NodeHeader.NumThreads && bStringsOk; ++t)
+		{
+			bStringsOk = Reader.ReadString(StringCursor, ThreadNames[t]);
+		}
+		bStringsOk = bStringsOk && Reader.ReadString(StringCursor, Node.CsvProfilePath) && Reader.ReadString(StringCursor, Node.TracePath);
+		TArray<FString> MemoryNames;
+		MemoryNames.SetNum(NodeHeader.NumMemoryColumns);
+		for (uint32 m = 0; m < NodeHeader.NumMemoryColumns && bStringsOk; ++m)
+		{
+			bStringsOk = Reader.ReadString(StringCursor, MemoryNames[m]);
+		}
+		TArray<FString> MetricNames;
+		MetricNames.SetNum(NodeHeader.NumMetricColumns);
+		for (uint32 m = 0; m < NodeHeader.NumMetricColumns && bStringsOk; ++m)
+		{
+			bStringsOk = Reader.ReadString(StringCursor, MetricNames[m]);
+		}
+		Node.MetricUnits.SetNum(NodeHeader.NumMetricColumns);
+		for (uint32 m = 0; m < NodeHeader.NumMetricColumns && bStringsOk; ++m)
+		{
+			bStringsOk = Reader.ReadString(StringCursor, Node.MetricUnits[m]);
+		}
+		if (!bStringsOk)
+		{
+			OutNodes.Reset();
+			return Fail(TEXT("string table out of range"));
+		}
+
+		const float* Curves[PTCaptureFormat::NumCurves];
+		for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+		{
+			Curves[c] = (const float*)(Reader.Data + CurvesOffset + c * CurveStride);
+		}
+		Node.FrameData.BindMapped(Curves, (int32)NodeHeader.NumFrames, Backing);
+
+		if (bHasSmoothed)
+		{
+			for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+			{
+				Curves[c] = (const float*)(Reader.Data + SmoothedOffset + c * CurveStride);
+			}
+			Node.SmoothedFrameData.BindMapped(Curves, (int32)NodeHeader.NumFrames, Backing);
+		}
+
+		if (bBucketed)
+		{
+			for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+			{
+				Curves[c] = (const float*)(Reader.Data + BucketMinOffset + c * CurveStride);
+			}
+			Node.BucketMin.BindMapped(Curves, (int32)NodeHeader.NumFrames, Backing);
+			for (int32 c = 0; c < PTCaptureFormat::NumCurves; ++c)
+			{
+				Curves[c] = (const float*)(Reader.Data + BucketMaxOffset + c * CurveStride);
+			}
+			Node.BucketMax.BindMapped(Curves, (int32)NodeHeader.NumFrames, Backing);
+
+			// Counts are small next to the curves and the analyzer wants a TArray; copy them out
+			Node.BucketFrameCounts.SetNumUninitialized(NodeHeader.NumFrames);
+			FMemory::Memcpy(Node.BucketFrameCounts.GetData(), Reader.Data + BucketCountsOffset, NodeHeader.NumFrames * sizeof(int32));
+		}
+
+		if (bHasPath)
+		{
+			const float* PathColumns[FPTPathColumns::NumColumns];
+			for (int32 c = 0; c < FPTPathColumns::NumColumns; ++c)
+			{
+				PathColumns[c] = (const float*)(Reader.Data + PathOffset + c * CurveStride);
+			}
+			Node.PathData.BindMapped(PathColumns, (int32)NodeHeader.NumFrames, Backing);
+		}
+
+		if (NodeHeader.NumMemoryColumns > 0)
+		{
+			TArray<const float*> MemoryColumns;
+			MemoryColumns.SetNum(NodeHeader.NumMemoryColumns);
+			for (uint32 m = 0; m < NodeHeader.NumMemoryColumns; ++m)
+			{
+				MemoryColumns[m] = (const float*)(Reader.Data + MemoryOffset + m * CurveStride);
+			}
+			Node.MemoryColumns.BindMapped(MoveTemp(MemoryNames), MoveTemp(MemoryColumns), (int32)NodeHeader.NumFrames, Backing);
+		}
+
+		if (NodeHeader.NumMetricColumns > 0)
+		{
+			TArray<const float*> MetricColumns;
+			MetricColumns.SetNum(NodeHeader.NumMetricColumns);
+			for (uint32 m = 0; m < NodeHeader.NumMetricColumns; ++m)
+			{
+				MetricColumns[m] = (const float*)(Reader.Data + MetricOffset + m * CurveStride);
+			}
+			Node.MetricColumns.BindMapped(MoveTemp(MetricNames), MoveTemp(MetricColumns), (int32)NodeHeader.NumFrames, Backing);
+		}
+
+		TArray<const float*> ThreadColumns;
+		ThreadColumns.SetNum(NodeHeader.NumThreads);
+		for (uint32 t = 0; t < NodeHeader.NumThreads; ++t)
+		{
+			ThreadColumns[t] = (const float*)(Reader.Data + ThreadsOffset + t * ThreadStride);
+		}
+		Node.ThreadTimings.BindMapped(MoveTemp(ThreadNames), MoveTemp(ThreadColumns), (int32)NodeHeader.NumThreadFrames, Backing);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("PTCapture: mapped %d node(s) from %s (%llu bytes)"), OutNodes.Num(), *Filename, Reader.Size);
+	return true;
+}
+
+FString FPTCaptureFile::MakeCaptureFilename(const FString& BaseName, const FString& Directory)
+{
+	FString Dir = Directory;
+	if (Dir.IsEmpty())
+	{
+		Dir = FPaths::Combine(FPaths::ProjectSavedDir(), PTTOOL_CAPTURE_SAVE_SUBDIR);
+	}
+	else if (FPaths::IsRelative(Dir))
+	{
+		Dir = FPaths::Combine(FPaths::ProjectSavedDir(), Dir);
+	}
+	IFileManager::Get().MakeDirectory(*Dir, true);
+
+	const FString Timestamp = FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S"));
+	const FString SafeName = FPaths::MakeValidFileName(BaseName, TEXT('_'));
+	return FPaths::Combine(Dir, FString::Printf(TEXT("%s_%s%s"), *SafeName, *Timestamp, PTTOOL_CAPTURE_FILE_EXTENSION));
+}
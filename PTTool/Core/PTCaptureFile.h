@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTDataType.h"
+
+// Capture files are written under ProjectSavedDir unless a spline overrides SavePath.
+#ifndef PTTOOL_CAPTURE_SAVE_SUBDIR
+#define PTTOOL_CAPTURE_SAVE_SUBDIR TEXT("PTTool/Captures")
+#endif
+
+#define PTTOOL_CAPTURE_FILE_EXTENSION TEXT(".ptcap")
+
+/**
+ * Binary capture file (.ptcap), versioned and columnar so it can be opened through a memory map.
+ *
+ *   FPTCaptureFileHeader
+ *   Node chunk 0..N-1 (16-byte aligned):
+ *     FPTCaptureNodeHeader                       stats + offsets relative to the chunk start
+ *     strings                                    spline name, thread names, CSV profile path, trace path, memory column names,
+ *                                                metric column names, metric units
+ *                                                (uint32 byte count + UTF-8 each)
+ *     curve columns   [5][ColumnStride]          raw FrameMS/GameMS/DrawMS/RHITMS/GPUMS floats
+ *     smoothed columns [5][ColumnStride]         EMA-smoothed curves, only when NumSmoothedFrames == NumFrames
+ *     thread columns  [NumThreads][ColumnStride] per-thread floats, ThreadTimings.ThreadNames order
+ *     bucket columns  min[5], max[5], count[1]   Bucketed nodes only, count is int32 frames per bucket
+ *     hitch events    FPTHitchEvent[NumHitchEvents], then FPTHitchEpisode[NumHitchEpisodes] (16-byte aligned)
+ *     path columns    [7][ColumnStride]          distance, location XYZ, pitch/yaw/roll; only when NumPathSamples == NumFrames
+ *     memory columns  [NumMemoryColumns][ColumnStride]  MB per sample, parallel to the curves
+ *     metric columns  [NumMetricColumns][ColumnStride]  IPTMetricProvider values per sample, parallel to the curves
+ *   FPTCaptureNodeEntry[NumNodes]                node table, found through the header
+ *
+ * Every column starts on a 16-byte boundary. Values are stored in native (little-endian) byte order.
+ */
+namespace PTCaptureFormat
+{
+	static constexpr uint32 Magic = 0x46435450; // "PTCF"
+	// Open only reads its own version: bump it with any layout change, the node header is not append-only
+	static constexpr uint32 Version = 1;
+	static constexpr uint32 ColumnAlignment = 16;
+	static constexpr int32 NumCurves = FPTFrameColumns::NumCurves;
+	static constexpr int32 NumPercentiles = 5;
+
+	inline uint64 GetColumnStride(uint32 NumFrames)
+	{
+		return Align((uint64)NumFrames * sizeof(float), (uint64)ColumnAlignment);
+	}
+}
+
+struct FPTCaptureFileHeader
+{
+	uint32 Magic = PTCaptureFormat::Magic;
+	uint32 Version = PTCaptureFormat::Version;
+	uint32 NumNodes = 0;
+	uint32 Flags = 0;
+	uint64 NodeTableOffset = 0;
+};
+static_assert(sizeof(FPTCaptureFileHeader) == 24, "FPTCaptureFileHeader layout is part of the file format");
+
+struct FPTCaptureNodeEntry
+{
+	uint64 Offset = 0;
+	uint64 Size = 0;
+};
+
+// FPTGraphStatInfo flattened to curve arrays (EPerfCurve order)
+struct FPTCaptureStatBlock
+{
+	float Avg[PTCaptureFormat::NumCurves] = {};
+	float Max[PTCaptureFormat::NumCurves] = {};
+	float Min[PTCaptureFormat::NumCurves] = {};
+	float StdDev[PTCaptureFormat::NumCurves] = {};
+	// P50, P90, P95, P99, P99.9
+	float Percentiles[PTCaptureFormat::NumPercentiles][PTCaptureFormat::NumCurves] = {};
+	float OnePercentLowFPS = 0.f;
+	uint32 bExactPercentiles = 1;
+	float SamplerOverheadAvgUs = 0.f;
+	float SamplerOverheadMaxUs = 0.f;
+};
+
+// FPTHitchReport totals (the event and episode arrays are stored after the columns)
+struct FPTCaptureHitchBlock
+{
+	float ThresholdMs[PTCaptureFormat::NumCurves] = {};
+	int32 SpikeCount[PTCaptureFormat::NumCurves] = {};
+	float SpikeTimeMs[PTCaptureFormat::NumCurves] = {};
+	float TotalTimeMs[PTCaptureFormat::NumCurves] = {};
+	int32 NumSpikeFrames = 0;
+	int32 NumDroppedEvents = 0;
+};
+
+struct FPTCaptureNodeHeader
+{
+	uint32 NumFrames = 0;
+	uint32 NumThreads = 0;
+	uint32 NumThreadFrames = 0;
+	uint32 NumSmoothedFrames = 0;
+	float TestTime = 0.f;
+	uint32 Reserved = 0;
+	uint64 StringsOffset = 0;
+	uint64 CurvesOffset = 0;
+	uint64 SmoothedCurvesOffset = 0;
+	uint64 ThreadsOffset = 0;
+	// EPTSamplingMode; the bucket offsets are only valid for Bucketed nodes
+	uint32 SamplingMode = 0;
+	float SamplingInterval = 0.f;
+	uint64 BucketMinOffset = 0;
+	uint64 BucketMaxOffset = 0;
+	uint64 BucketCountsOffset = 0;
+	uint32 NumHitchEvents = 0;
+	uint32 NumHitchEpisodes = 0;
+	uint64 HitchEventsOffset = 0;
+	uint64 HitchEpisodesOffset = 0;
+	uint32 NumPathSamples = 0;
+	uint32 PathReserved = 0;
+	uint64 PathOffset = 0;
+	uint32 NumMemoryColumns = 0;
+	uint32 MemoryReserved = 0;
+	uint64 MemoryOffset = 0;
+	uint32 NumMetricColumns = 0;
+	uint32 MetricReserved = 0;
+	uint64 MetricOffset = 0;
+	FPTCaptureStatBlock Stats;
+	FPTCaptureHitchBlock Hitches;
+	// Explicit tail padding to the 8-byte alignment, so no uninitialized bytes reach the file
+	uint32 TailReserved = 0;
+};
+static_assert(sizeof(FPTCaptureStatBlock) == 196, "FPTCaptureStatBlock layout is part of the file format");
+static_assert(sizeof(FPTCaptureHitchBlock) == 88, "FPTCaptureHitchBlock layout is part of the file format");
+static_assert(sizeof(FPTCaptureNodeHeader) == 448, "FPTCaptureNodeHeader layout is part of the file format");
+
+class FPTCaptureFile
+{
+public:
+	// Writes Nodes to Filename (via a temp file, so a failed write never leaves a truncated capture behind)
+	static bool Write(const FString& Filename, TConstArrayView<FSampledGraphData> Nodes);
+
+	// Maps Filename and returns one FSampledGraphData per node whose frame and thread columns view the mapping.
+	// The mapping stays open as long as any returned node (or a copy of it) is alive.
+	static bool Open(const FString& Filename, TArray<FSampledGraphData>& OutNodes, FString* OutError = nullptr);
+
+	// <Dir>/<BaseName>_<timestamp>.ptcap, Dir defaults to ProjectSavedDir/PTTOOL_CAPTURE_SAVE_SUBDIR
+	static FString MakeCaptureFilename(const FString& BaseName, const FString& Directory = FString());
+};
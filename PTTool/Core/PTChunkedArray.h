@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Append-only array stored in fixed-size chunks.
+ * Reserve() allocates every chunk up front; growing past the reservation allocates one more chunk and
+ * never moves or copies elements already written, so Add() on the sampling hot path stays O(1) without reallocation.
+ */
+template <typename T, int32 ChunkShift = 14>
+class TPTChunkedArray
+{
+public:
+	static constexpr int32 ChunkSize = 1 << ChunkShift;
+
+	int32 Num() const { return NumElements; }
+
+	int32 Capacity() const { return Chunks.Num() * ChunkSize; }
+
+	// Chunks allocated by Add() after the reservation ran out
+	int32 NumOverflowChunks() const { return OverflowChunks; }
+
+	void Reserve(int32 InNum)
+	{
+		while (Capacity() < InNum)
+		{
+			AllocateChunk();
+		}
+	}
+
+	void Add(const T& Value)
+	{
+		if (NumElements == Capacity())
+		{
+			AllocateChunk();
+			++OverflowChunks;
+		}
+		Chunks[NumElements >> ChunkShift].Add(Value);
+		++NumElements;
+	}
+
+	const T& operator[](int32 Index) const
+	{
+		return Chunks[Index >> ChunkShift][Index & (ChunkSize - 1)];
+	}
+
+	T& operator[](int32 Index)
+	{
+		return Chunks[Index >> ChunkShift][Index & (ChunkSize - 1)];
+	}
+
+	// Calls Func with each filled chunk as a contiguous view, in order
+	template <typename FuncType>
+	void ForEachChunk(FuncType&& Func) const
+	{
+		for (const TArray<T>& Chunk : Chunks)
+		{
+			if (Chunk.Num() == 0)
+			{
+				break;
+			}
+			Func(TConstArrayView<T>(Chunk));
+		}
+	}
+
+	// Copies all elements into Out, which must hold Num() elements
+	void CopyTo(TArrayView<T> Out) const
+	{
+		check(Out.Num() >= NumElements);
+		int32 Offset = 0;
+		ForEachChunk([&Out, &Offset](TConstArrayView<T> Chunk)
+		{
+			FMemory::Memcpy(Out.GetData() + Offset, Chunk.GetData(), Chunk.Num() * sizeof(T));
+			Offset += Chunk.Num();
+		});
+	}
+
+	// Drops the elements but keeps the chunks for reuse
+	void Reset()
+	{
+		for (TArray<T>& Chunk : Chunks)
+		{
+			Chunk.Reset();
+		}
+		NumElements = 0;
+		OverflowChunks = 0;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Chunks.GetAllocatedSize() + (SIZE_T)Chunks.Num() * ChunkSize * sizeof(T);
+	}
+
+	struct FConstIterator
+	{
+		const TPTChunkedArray* Array;
+		int32 Index;
+
+		const T& operator*() const { return (*Array)[Index]; }
+		FConstIterator& operator++() { ++Index; return *this; }
+		bool operator!=(const FConstIterator& Other) const { return Index != Other.Index; }
+	};
+
+	FConstIterator begin() const { return { this, 0 }; }
+	FConstIterator end() const { return { this, NumElements }; }
+
+private:
+	void AllocateChunk()
+	{
+		Chunks.AddDefaulted_GetRef().Reserve(ChunkSize);
+	}
+
+	TArray<TArray<T>> Chunks;
+	int32 NumElements = 0;
+	int32 OverflowChunks = 0;
+};
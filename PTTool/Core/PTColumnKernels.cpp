@@ -0,0 +1,91 @@
+#include "PTColumnKernels.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+	constexpr int32 DefaultBenchmarkSamples = 10 * 1000 * 1000;
+	constexpr int32 BenchmarkRuns = 5;
+	constexpr int32 BenchmarkBins = 128;
+
+	// Best of BenchmarkRuns, in ms; the first run also warms the caches for the scalar/vector pair
+	template <typename FunctionType>
+	double TimeBest(FunctionType&& Function)
+	{
+		double Best = DBL_MAX;
+		for (int32 Run = 0; Run < BenchmarkRuns; ++Run)
+		{
+			const double Start = FPlatformTime::Seconds();
+			Function();
+			Best = FMath::Min(Best, (FPlatformTime::Seconds() - Start) * 1000.0);
+		}
+		return Best;
+	}
+
+	void LogKernel(const TCHAR* Name, double ScalarMs, double VectorMs, bool bMatch, int32 NumSamples)
+	{
+		UE_LOG(LogTemp, Log, TEXT(" %-20s scalar %8.2f ms | vector %8.2f ms | %5.2fx | %6.2f GB/s%s"),
+		       Name, ScalarMs, VectorMs, VectorMs > 0.0 ? ScalarMs / VectorMs : 0.0,
+		       VectorMs > 0.0 ? NumSamples * sizeof(float) / (VectorMs * 1.0e6) : 0.0,
+		       bMatch ? TEXT("") : TEXT("  MISMATCH"));
+	}
+
+	void BenchmarkKernels(const TArray<FString>& Args)
+	{
+		const int32 NumSamples = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : DefaultBenchmarkSamples;
+
+		// Frame times around 16.6 ms with noise and a spike every ~200 frames, like a real capture
+		TArray<float> Values;
+		Values.SetNumUninitialized(NumSamples);
+		FRandomStream Random(42);
+		for (float& Value : Values)
+		{
+			Value = 16.6f + Random.FRandRange(-1.5f, 1.5f) + (Random.FRand() < 0.005f ? Random.FRandRange(10.f, 60.f) : 0.f);
+		}
+		const TConstArrayView<float> Column(Values);
+
+#if PTTOOL_VECTOR_KERNELS
+		UE_LOG(LogTemp, Log, TEXT("PTTool kernels: %d samples, best of %d runs"), NumSamples, BenchmarkRuns);
+
+		double ScalarSum = 0.0, VectorSum = 0.0;
+		const double SumScalarMs = TimeBest([&] { ScalarSum = FPTScalarKernels::Sum(Column); });
+		const double SumVectorMs = TimeBest([&] { VectorSum = FPTVectorKernels::Sum(Column); });
+		LogKernel(TEXT("Sum"), SumScalarMs, SumVectorMs, FMath::IsNearlyEqual(ScalarSum, VectorSum, FMath::Abs(ScalarSum) * 1.0e-6), NumSamples);
+
+		const double Mean = ScalarSum / NumSamples;
+		double ScalarM2 = 0.0, VectorM2 = 0.0;
+		const double M2ScalarMs = TimeBest([&] { ScalarM2 = FPTScalarKernels::SumSquaredDeviation(Column, Mean); });
+		const double M2VectorMs = TimeBest([&] { VectorM2 = FPTVectorKernels::SumSquaredDeviation(Column, Mean); });
+		LogKernel(TEXT("SumSquaredDeviation"), M2ScalarMs, M2VectorMs, FMath::IsNearlyEqual(ScalarM2, VectorM2, ScalarM2 * 1.0e-5), NumSamples);
+
+		FPTColumnRange ScalarRange, VectorRange;
+		const double RangeScalarMs = TimeBest([&] { ScalarRange = FPTScalarKernels::MinMax(Column); });
+		const double RangeVectorMs = TimeBest([&] { VectorRange = FPTVectorKernels::MinMax(Column); });
+		LogKernel(TEXT("MinMax"), RangeScalarMs, RangeVectorMs, ScalarRange.Min == VectorRange.Min && ScalarRange.Max == VectorRange.Max, NumSamples);
+
+		const float Threshold = 2.f * (float)Mean;
+		int64 ScalarCount = 0, VectorCount = 0;
+		const double CountScalarMs = TimeBest([&] { ScalarCount = FPTScalarKernels::CountAbove(Column, Threshold); });
+		const double CountVectorMs = TimeBest([&] { VectorCount = FPTVectorKernels::CountAbove(Column, Threshold); });
+		LogKernel(TEXT("CountAbove"), CountScalarMs, CountVectorMs, ScalarCount == VectorCount, NumSamples);
+
+		TArray<int64> ScalarBins, VectorBins;
+		const double HistogramScalarMs = TimeBest([&] { ScalarBins.Init(0, BenchmarkBins); FPTScalarKernels::Histogram(Column, 0.f, 0.5f, ScalarBins); });
+		const double HistogramVectorMs = TimeBest([&] { VectorBins.Init(0, BenchmarkBins); FPTVectorKernels::Histogram(Column, 0.f, 0.5f, VectorBins); });
+		LogKernel(TEXT("Histogram"), HistogramScalarMs, HistogramVectorMs, ScalarBins == VectorBins, NumSamples);
+
+		UE_LOG(LogTemp, Log, TEXT(" mean %.3f ms | range %.2f-%.2f ms | %lld above %.1f ms"), Mean, VectorRange.Min, VectorRange.Max, VectorCount, Threshold);
+#else
+		UE_LOG(LogTemp, Warning, TEXT("PTTool kernels: vector kernels are compiled out (PTTOOL_VECTOR_KERNELS=0), only the scalar ones run"));
+		double Sum = 0.0;
+		const double SumMs = TimeBest([&] { Sum = FPTScalarKernels::Sum(Column); });
+		UE_LOG(LogTemp, Log, TEXT(" Sum scalar %.2f ms (%d samples, mean %.3f)"), SumMs, NumSamples, Sum / NumSamples);
+#endif
+	}
+
+	FAutoConsoleCommand BenchmarkKernelsCommand(
+		TEXT("pttool.BenchmarkKernels"),
+		TEXT("Times the scalar and vector column kernels (sum, squared deviation, min/max, threshold count, histogram) and checks they agree.\n")
+		TEXT("Usage: pttool.BenchmarkKernels [NumSamples], 10M by default."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkKernels));
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/VectorRegister.h"
+
+// 0 forces the scalar kernels on every platform
+#ifndef PTTOOL_VECTOR_KERNELS
+#define PTTOOL_VECTOR_KERNELS (PLATFORM_ENABLE_VECTORINTRINSICS || PLATFORM_ENABLE_VECTORINTRINSICS_NEON)
+#endif
+
+// Min/Max of a column; FLT_MAX/-FLT_MAX when it is empty, so ranges merge with FMath::Min/Max
+struct FPTColumnRange
+{
+	float Min = FLT_MAX;
+	float Max = -FLT_MAX;
+
+	bool IsEmpty() const { return Min > Max; }
+};
+
+/**
+ * Reductions over contiguous float columns (FPTFrameColumns curves, thread/memory/metric columns).
+ * FPTScalarKernels is the reference; FPTVectorKernels computes the same results four lanes at a time through
+ * VectorRegister4Float (SSE/NEON), and FPTColumnKernels is whichever one the platform runs.
+ * pttool.BenchmarkKernels compares the two.
+ */
+struct FPTScalarKernels
+{
+	static double Sum(TConstArrayView<float> Values)
+	{
+		double Total = 0.0;
+		for (const float V : Values)
+		{
+			Total += V;
+		}
+		return Total;
+	}
+
+	// Sum of (V - Mean)^2, the M2 of a Welford accumulator over Values
+	static double SumSquaredDeviation(TConstArrayView<float> Values, double Mean)
+	{
+		double Total = 0.0;
+		for (const float V : Values)
+		{
+			const double D = (double)V - Mean;
+			Total += D * D;
+		}
+		return Total;
+	}
+
+	static FPTColumnRange MinMax(TConstArrayView<float> Values)
+	{
+		FPTColumnRange Range;
+		for (const float V : Values)
+		{
+			Range.Min = FMath::Min(Range.Min, V);
+			Range.Max = FMath::Max(Range.Max, V);
+		}
+		return Range;
+	}
+
+	// Number of values strictly above Threshold
+	static int64 CountAbove(TConstArrayView<float> Values, float Threshold)
+	{
+		int64 Count = 0;
+		for (const float V : Values)
+		{
+			Count += V > Threshold ? 1 : 0;
+		}
+		return Count;
+	}
+
+	// Adds Values to OutCounts, bin b covering [First + b * BinWidth, First + (b + 1) * BinWidth).
+	// Values outside land in the first/last bin.
+	static void Histogram(TConstArrayView<float> Values, float First, float BinWidth, TArrayView<int64> OutCounts)
+	{
+		if (OutCounts.Num() == 0 || BinWidth <= 0.f)
+		{
+			return;
+		}
+		const float InvWidth = 1.f / BinWidth;
+		const float LastBin = (float)(OutCounts.Num() - 1);
+		for (const float V : Values)
+		{
+			++OutCounts[(int32)FMath::Min(FMath::Max((V - First) * InvWidth, 0.f), LastBin)];
+		}
+	}
+};
+
+#if PTTOOL_VECTOR_KERNELS
+struct FPTVectorKernels
+{
+	// Four registers in flight per loop, so the add/min/max latency chains overlap
+	static constexpr int32 Unroll = 16;
+	// Float lanes only sum this many values before the block total moves to double, so long columns keep
+	// their precision (and a lane count stays exact)
+	static constexpr int32 BlockSize = 4096;
+
+	static double Sum(TConstArrayView<float> Values)
+	{
+		const float* Data = Values.GetData();
+		const int32 VectorEnd = Values.Num() - Values.Num() % Unroll;
+		double Total = 0.0;
+		for (int32 BlockStart = 0; BlockStart < VectorEnd; BlockStart += BlockSize)
+		{
+			const int32 BlockEnd = FMath::Min(BlockStart + BlockSize, VectorEnd);
+			VectorRegister4Float Acc0 = VectorZeroFloat(), Acc1 = VectorZeroFloat(), Acc2 = VectorZeroFloat(), Acc3 = VectorZeroFloat();
+			for (int32 i = BlockStart; i < BlockEnd; i += Unroll)
+			{
+				Acc0 = VectorAdd(Acc0, VectorLoad(Data + i));
+				Acc1 = VectorAdd(Acc1, VectorLoad(Data + i + 4));
+				Acc2 = VectorAdd(Acc2, VectorLoad(Data + i + 8));
+				Acc3 = VectorAdd(Acc3, VectorLoad(Data + i + 12));
+			}
+			Total += ReduceAdd(VectorAdd(VectorAdd(Acc0, Acc1), VectorAdd(Acc2, Acc3)));
+		}
+		return Total + FPTScalarKernels::Sum(Values.RightChop(VectorEnd));
+	}
+
+	static double SumSquaredDeviation(TConstArrayView<float> Values, double Mean)
+	{
+		const float* Data = Values.GetData();
+		const int32 VectorEnd = Values.Num() - Values.Num() % Unroll;
+		const VectorRegister4Float M = VectorSetFloat1((float)Mean);
+		double Total = 0.0;
+		for (int32 BlockStart = 0; BlockStart < VectorEnd; BlockStart += BlockSize)
+		{
+			const int32 BlockEnd = FMath::Min(BlockStart + BlockSize, VectorEnd);
+			VectorRegister4Float Acc0 = VectorZeroFloat(), Acc1 = VectorZeroFloat(), Acc2 = VectorZeroFloat(), Acc3 = VectorZeroFloat();
+			for (int32 i = BlockStart; i < BlockEnd; i += Unroll)
+			{
+				const VectorRegister4Float D0 = VectorSubtract(VectorLoad(Data + i), M);
+				const VectorRegister4Float D1 = VectorSubtract(VectorLoad(Data + i + 4), M);
+				const VectorRegister4Float D2 = VectorSubtract(VectorLoad(Data + i + 8), M);
+				const VectorRegister4Float D3 = VectorSubtract(VectorLoad(Data + i + 12), M);
+				Acc0 = VectorMultiplyAdd(D0, D0, Acc0);
+				Acc1 = VectorMultiplyAdd(D1, D1, Acc1);
+				Acc2 = VectorMultiplyAdd(D2, D2, Acc2);
+				Acc3 = VectorMultiplyAdd(D3, D3, Acc3);
+			}
+			Total += ReduceAdd(VectorAdd(VectorAdd(Acc0, Acc1), VectorAdd(Acc2, Acc3)));
+		}
+		return Total + FPTScalarKernels::SumSquaredDeviation(Values.RightChop(VectorEnd), Mean);
+	}
+
+	static FPTColumnRange MinMax(TConstArrayView<float> Values)
+	{
+		const float* Data = Values.GetData();
+		const int32 VectorEnd = Values.Num() - Values.Num() % Unroll;
+		FPTColumnRange Range = FPTScalarKernels::MinMax(Values.RightChop(VectorEnd));
+		if (VectorEnd == 0)
+		{
+			return Range;
+		}
+		VectorRegister4Float Min0 = VectorLoad(Data), Min1 = Min0;
+		VectorRegister4Float Max0 = Min0, Max1 = Min0;
+		for (int32 i = 0; i < VectorEnd; i += Unroll)
+		{
+			const VectorRegister4Float V0 = VectorLoad(Data + i);
+			const VectorRegister4Float V1 = VectorLoad(Data + i + 4);
+			const VectorRegister4Float V2 = VectorLoad(Data + i + 8);
+			const VectorRegister4Float V3 = VectorLoad(Data + i + 12);
+			Min0 = VectorMin(Min0, VectorMin(V0, V1));
+			Min1 = VectorMin(Min1, VectorMin(V2, V3));
+			Max0 = VectorMax(Max0, VectorMax(V0, V1));
+			Max1 = VectorMax(Max1, VectorMax(V2, V3));
+		}
+		alignas(16) float Lanes[4];
+		VectorStoreAligned(VectorMin(Min0, Min1), Lanes);
+		Range.Min = FMath::Min(Range.Min, FMath::Min(FMath::Min(Lanes[0], Lanes[1]), FMath::Min(Lanes[2], Lanes[3])));
+		VectorStoreAligned(VectorMax(Max0, Max1), Lanes);
+		Range.Max = FMath::Max(Range.Max, FMath::Max(FMath::Max(Lanes[0], Lanes[1]), FMath::Max(Lanes[2], Lanes[3])));
+		return Range;
+	}
+
+	static int64 CountAbove(TConstArrayView<float> Values, float Threshold)
+	{
+		const float* Data = Values.GetData();
+		const int32 VectorEnd = Values.Num() - Values.Num() % Unroll;
+		const VectorRegister4Float T = VectorSetFloat1(Threshold);
+		const VectorRegister4Float One = VectorOneFloat();
+		int64 Count = 0;
+		for (int32 BlockStart = 0; BlockStart < VectorEnd; BlockStart += BlockSize)
+		{
+			const int32 BlockEnd = FMath::Min(BlockStart + BlockSize, VectorEnd);
+			// Compare masks ANDed with 1.0 add one per lane above the threshold, no branch per value
+			VectorRegister4Float Acc0 = VectorZeroFloat(), Acc1 = VectorZeroFloat(), Acc2 = VectorZeroFloat(), Acc3 = VectorZeroFloat();
+			for (int32 i = BlockStart; i < BlockEnd; i += Unroll)
+			{
+				Acc0 = VectorAdd(Acc0, VectorBitwiseAnd(VectorCompareGT(VectorLoad(Data + i), T), One));
+				Acc1 = VectorAdd(Acc1, VectorBitwiseAnd(VectorCompareGT(VectorLoad(Data + i + 4), T), One));
+				Acc2 = VectorAdd(Acc2, VectorBitwiseAnd(VectorCompareGT(VectorLoad(Data + i + 8), T), One));
+				Acc3 = VectorAdd(Acc3, VectorBitwiseAnd(VectorCompareGT(VectorLoad(Data + i + 12), T), One));
+			}
+			Count += (int64)ReduceAdd(VectorAdd(VectorAdd(Acc0, Acc1), VectorAdd(Acc2, Acc3)));
+		}
+		return Count + FPTScalarKernels::CountAbove(Values.RightChop(VectorEnd), Threshold);
+	}
+
+	static void Histogram(TConstArrayView<float> Values, float First, float BinWidth, TArrayView<int64> OutCounts)
+	{
+		const int32 NumBins = OutCounts.Num();
+		if (NumBins == 0 || BinWidth <= 0.f)
+		{
+			return;
+		}
+		const float* Data = Values.GetData();
+		const int32 VectorEnd = Values.Num() - Values.Num() % Unroll;
+		const VectorRegister4Float F = VectorSetFloat1(First);
+		const VectorRegister4Float InvWidth = VectorSetFloat1(1.f / BinWidth);
+		const VectorRegister4Float LastBin = VectorSetFloat1((float)(NumBins - 1));
+		const VectorRegister4Float Zero = VectorZeroFloat();
+
+		// Bin indices are computed four at a time; the increments go to one table per lane, so runs of equal
+		// frame times don't serialize on a single counter
+		TArray<int32> LaneCounts;
+		LaneCounts.SetNumZeroed(NumBins * 4);
+		int32* Lane[4] = { LaneCounts.GetData(), LaneCounts.GetData() + NumBins, LaneCounts.GetData() + 2 * NumBins, LaneCounts.GetData() + 3 * NumBins };
+		alignas(16) float Bins[Unroll];
+		for (int32 i = 0; i < VectorEnd; i += Unroll)
+		{
+			for (int32 v = 0; v < Unroll; v += 4)
+			{
+				const VectorRegister4Float X = VectorMultiply(VectorSubtract(VectorLoad(Data + i + v), F), InvWidth);
+				VectorStoreAligned(VectorMin(VectorMax(X, Zero), LastBin), Bins + v);
+			}
+			for (int32 v = 0; v < Unroll; ++v)
+			{
+				++Lane[v & 3][(int32)Bins[v]];
+			}
+		}
+		for (int32 b = 0; b < NumBins; ++b)
+		{
+			OutCounts[b] += (int64)Lane[0][b] + Lane[1][b] + Lane[2][b] + Lane[3][b];
+		}
+		FPTScalarKernels::Histogram(Values.RightChop(VectorEnd), First, BinWidth, OutCounts);
+	}
+
+private:
+	static float ReduceAdd(const VectorRegister4Float& V)
+	{
+		alignas(16) float Lanes[4];
+		VectorStoreAligned(V, Lanes);
+		return (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+	}
+};
+
+using FPTColumnKernels = FPTVectorKernels;
+#else
+using FPTColumnKernels = FPTScalarKernels;
+#endif
@@ -1,20 +1,22 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "Algo/BinarySearch.h"
+#include "PTColumnKernels.h"
 #include "PTDataType.generated.h"
 
 #define PT_PERFORMANCE_GRAPH_WINDOW_SIZE_X 1280
 #define PT_PERFORMANCE_GRAPH_WINDOW_SIZE_Y 720
 
-USTRUCT()
-struct FThreadSample
+// How a sampler turns frames into stored samples
+UENUM()
+enum class EPTSamplingMode : uint8
 {
-	GENERATED_BODY()
-
-	UPROPERTY()
-	FString ThreadName;
-
-	UPROPERTY()
-	float TimeMs = 0.f;
+	// One sample per frame
+	EveryFrame,
+	// One frame kept per SamplingInterval, the rest only feed the node stats
+	Decimated,
+	// One sample per SamplingInterval holding the min/max/mean/count of every frame inside it
+	Bucketed
 };
 
 USTRUCT()
@@ -27,11 +29,364 @@ struct FSampledFrameData
 	float DrawMS;
 	float RHITMS;
 	float GPUMS;
+};
+
+// Per-curve frame timings of a capture, stored column-wise in FSampledFrameData member order (Frame/Game/Draw/RHI/GPU).
+// Columns are either owned, or views into a memory-mapped capture file that Backing keeps alive,
+// so reopening a saved capture never rebuilds a TArray<FSampledFrameData>.
+USTRUCT()
+struct FPTFrameColumns
+{
+	GENERATED_BODY()
+
+	static constexpr int32 NumCurves = 5;
+
+	int32 Num() const { return NumFrames; }
+
+	bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumFrames; }
+
+	bool IsMapped() const { return Backing.IsValid(); }
+
+	TConstArrayView<float> GetCurve(int32 CurveIndex) const
+	{
+		return Backing.IsValid() ? TConstArrayView<float>(Mapped[CurveIndex], NumFrames) : TConstArrayView<float>(Owned[CurveIndex]);
+	}
+
+	FSampledFrameData GetFrame(int32 Index) const
+	{
+		FSampledFrameData Out;
+		Out.FrameMS = GetCurve(0)[Index];
+		Out.GameMS = GetCurve(1)[Index];
+		Out.DrawMS = GetCurve(2)[Index];
+		Out.RHITMS = GetCurve(3)[Index];
+		Out.GPUMS = GetCurve(4)[Index];
+		return Out;
+	}
+
+	// Transposes sampled frames into owned columns
+	void Assign(TConstArrayView<FSampledFrameData> Frames)
+	{
+		Reset();
+		Reserve(Frames.Num());
+		AppendFrames(Frames);
+	}
+
+	void Reserve(int32 InNumFrames)
+	{
+		for (TArray<float>& Column : Owned)
+		{
+			Column.Reserve(InNumFrames);
+		}
+	}
+
+	// Appends frames to owned columns (not valid on a mapped capture)
+	void AppendFrames(TConstArrayView<FSampledFrameData> Frames)
+	{
+		check(!Backing.IsValid());
+		for (const FSampledFrameData& S : Frames)
+		{
+			Owned[0].Add(S.FrameMS);
+			Owned[1].Add(S.GameMS);
+			Owned[2].Add(S.DrawMS);
+			Owned[3].Add(S.RHITMS);
+			Owned[4].Add(S.GPUMS);
+		}
+		NumFrames += Frames.Num();
+	}
+
+	// Points the columns at externally owned memory (a mapped capture). InBacking must own that memory.
+	void BindMapped(const float* const (&InCurves)[NumCurves], int32 InNumFrames, TSharedPtr<const void> InBacking)
+	{
+		Reset();
+		for (int32 c = 0; c < NumCurves; ++c)
+		{
+			Mapped[c] = InCurves[c];
+		}
+		NumFrames = InNumFrames;
+		Backing = MoveTemp(InBacking);
+	}
+
+	void Reset()
+	{
+		for (int32 c = 0; c < NumCurves; ++c)
+		{
+			Owned[c].Reset();
+			Mapped[c] = nullptr;
+		}
+		NumFrames = 0;
+		Backing.Reset();
+	}
+
+private:
+	int32 NumFrames = 0;
+	TArray<float> Owned[NumCurves];
+	const float* Mapped[NumCurves] = {};
+	TSharedPtr<const void> Backing;
+};
+
+// Camera state when a sample was taken
+struct FPTSamplePose
+{
+	float Distance = 0.f;            // along the node's spline, restarts at 0 on every loop
+	FVector3f Location = FVector3f::ZeroVector;
+	FRotator3f Rotation = FRotator3f::ZeroRotator;
+};
+
+// Camera path per sample, parallel to FrameData, column-wise like FPTFrameColumns (owned or mapped).
+// Distance rises within a loop and restarts on the next one; BuildDistanceIndex splits the samples into those
+// monotonic runs so a spline distance maps to one sample range per loop by binary search.
+struct FPTPathColumns
+{
+	enum EColumn : int32 { Distance, LocationX, LocationY, LocationZ, Pitch, Yaw, Roll, NumColumns };
+
+	// Samples [First, Last] of one pass over the spline
+	struct FRun
+	{
+		int32 First = 0;
+		int32 Last = 0;
+	};
+
+	int32 Num() const { return NumSamples; }
 
-	// Per-thread breakdown (optional, may be empty if sampler doesn't provide detailed thread timings)
+	bool IsMapped() const { return Backing.IsValid(); }
+
+	TConstArrayView<float> GetColumn(int32 Column) const
+	{
+		return Backing.IsValid() ? TConstArrayView<float>(Mapped[Column], NumSamples) : TConstArrayView<float>(Owned[Column]);
+	}
+
+	FPTSamplePose GetPose(int32 Index) const
+	{
+		FPTSamplePose Out;
+		Out.Distance = GetColumn(Distance)[Index];
+		Out.Location = FVector3f(GetColumn(LocationX)[Index], GetColumn(LocationY)[Index], GetColumn(LocationZ)[Index]);
+		Out.Rotation = FRotator3f(GetColumn(Pitch)[Index], GetColumn(Yaw)[Index], GetColumn(Roll)[Index]);
+		return Out;
+	}
+
+	void Reserve(int32 InNumSamples)
+	{
+		for (TArray<float>& Column : Owned)
+		{
+			Column.Reserve(InNumSamples);
+		}
+	}
+
+	// Appends to owned columns (not valid on a mapped capture); call BuildDistanceIndex when done
+	void AppendPoses(TConstArrayView<FPTSamplePose> Poses)
+	{
+		check(!Backing.IsValid());
+		for (const FPTSamplePose& Pose : Poses)
+		{
+			Owned[Distance].Add(Pose.Distance);
+			Owned[LocationX].Add(Pose.Location.X);
+			Owned[LocationY].Add(Pose.Location.Y);
+			Owned[LocationZ].Add(Pose.Location.Z);
+			Owned[Pitch].Add(Pose.Rotation.Pitch);
+			Owned[Yaw].Add(Pose.Rotation.Yaw);
+			Owned[Roll].Add(Pose.Rotation.Roll);
+		}
+		NumSamples += Poses.Num();
+	}
+
+	// Points the columns at externally owned memory (a mapped capture) and indexes it. InBacking must own that memory.
+	void BindMapped(const float* const (&InColumns)[NumColumns], int32 InNumSamples, TSharedPtr<const void> InBacking)
+	{
+		Reset();
+		for (int32 c = 0; c < NumColumns; ++c)
+		{
+			Mapped[c] = InColumns[c];
+		}
+		NumSamples = InNumSamples;
+		Backing = MoveTemp(InBacking);
+		BuildDistanceIndex();
+	}
+
+	void BuildDistanceIndex()
+	{
+		Runs.Reset();
+		const TConstArrayView<float> Column = GetColumn(Distance);
+		for (int32 i = 0; i < Column.Num(); ++i)
+		{
+			if (Runs.Num() == 0 || Column[i] < Column[i - 1])
+			{
+				Runs.Add({ i, i });
+			}
+			Runs.Last().Last = i;
+		}
+	}
+
+	TConstArrayView<FRun> GetRuns() const { return Runs; }
+
+	// Sample ranges (one per loop that reaches it) whose distance lies in [MinDistance, MaxDistance), so adjacent
+	// slices of the spline never share a sample
+	void FindSampleRanges(float MinDistance, float MaxDistance, TArray<FRun>& OutRanges) const
+	{
+		OutRanges.Reset();
+		const TConstArrayView<float> Column = GetColumn(Distance);
+		for (const FRun& Run : Runs)
+		{
+			const TConstArrayView<float> RunView = Column.Slice(Run.First, Run.Last - Run.First + 1);
+			const int32 First = Algo::LowerBound(RunView, MinDistance);
+			const int32 End = Algo::LowerBound(RunView, MaxDistance);
+			if (First < End)
+			{
+				OutRanges.Add({ Run.First + First, Run.First + End - 1 });
+			}
+		}
+	}
+
+	// Distance travelled from the first sample with loops unwrapped, Num() + 1 entries (last one is the total)
+	void ComputeTravelledDistance(TArray<double>& Out) const
+	{
+		const TConstArrayView<float> Column = GetColumn(Distance);
+		Out.SetNumUninitialized(NumSamples + 1);
+		double Cum = 0.0;
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			if (i > 0)
+			{
+				Cum += Column[i] >= Column[i - 1] ? Column[i] - Column[i - 1] : Column[i];
+			}
+			Out[i] = Cum;
+		}
+		// The last sample covers as much path as the one before it
+		Out[NumSamples] = NumSamples > 1 ? Cum + (Out[NumSamples - 1] - Out[NumSamples - 2]) : Cum;
+	}
+
+	void Reset()
+	{
+		for (int32 c = 0; c < NumColumns; ++c)
+		{
+			Owned[c].Reset();
+			Mapped[c] = nullptr;
+		}
+		NumSamples = 0;
+		Backing.Reset();
+		Runs.Reset();
+	}
+
+private:
+	int32 NumSamples = 0;
+	TArray<float> Owned[NumColumns];
+	const float* Mapped[NumColumns] = {};
+	TSharedPtr<const void> Backing;
+	TArray<FRun> Runs;
+};
+
+// Per-thread timings for a whole capture, stored column-wise.
+// Thread names are interned once into an ID table; each thread owns one contiguous float column indexed by frame,
+// so sampling a frame appends a float per thread instead of allocating per-frame arrays and strings.
+// A store opened from a capture file views mapped columns instead and is read-only.
+USTRUCT()
+struct FPTThreadTimingStore
+{
+	GENERATED_BODY()
+
+	// ThreadId -> name
 	UPROPERTY()
-	TArray<FThreadSample> ThreadData;
+	TArray<FString> ThreadNames;
+
+	// Columns[ThreadId][FrameIndex], all columns have NumFrames entries
+	TArray<TArray<float>> Columns;
+
+	int32 NumFrames = 0;
+
+	int32 NumThreads() const { return ThreadNames.Num(); }
+
+	int32 FindThread(const FString& Name) const
+	{
+		return ThreadNames.IndexOfByKey(Name);
+	}
+
+	// Returns the existing id for Name, or registers a new column (zero-filled for frames already recorded)
+	int32 InternThread(const FString& Name)
+	{
+		const int32 Existing = FindThread(Name);
+		if (Existing != INDEX_NONE)
+		{
+			return Existing;
+		}
+		ThreadNames.Add(Name);
+		TArray<float>& Column = Columns.AddDefaulted_GetRef();
+		Column.Reserve(FMath::Max(NumFrames, ReservedFrames));
+		Column.AddZeroed(NumFrames);
+		return ThreadNames.Num() - 1;
+	}
+
+	void Reserve(int32 InNumFrames)
+	{
+		ReservedFrames = InNumFrames;
+		for (TArray<float>& Column : Columns)
+		{
+			Column.Reserve(InNumFrames);
+		}
+	}
+
+	// Appends one zeroed frame to every column and returns its index
+	int32 AddFrame()
+	{
+		for (TArray<float>& Column : Columns)
+		{
+			Column.Add(0.f);
+		}
+		return NumFrames++;
+	}
+
+	void SetTime(int32 ThreadId, int32 FrameIndex, float TimeMs)
+	{
+		Columns[ThreadId][FrameIndex] = TimeMs;
+	}
+
+	float GetTime(int32 ThreadId, int32 FrameIndex) const
+	{
+		return GetColumn(ThreadId)[FrameIndex];
+	}
+
+	TConstArrayView<float> GetColumn(int32 ThreadId) const
+	{
+		return Backing.IsValid() ? TConstArrayView<float>(MappedColumns[ThreadId], NumFrames) : TConstArrayView<float>(Columns[ThreadId]);
+	}
+
+	// Resizes every owned column to InNumFrames (new entries zeroed), for bulk fills through GetMutableColumn
+	void SetNumFrames(int32 InNumFrames)
+	{
+		for (TArray<float>& Column : Columns)
+		{
+			Column.SetNumZeroed(InNumFrames);
+		}
+		NumFrames = InNumFrames;
+	}
+
+	TArrayView<float> GetMutableColumn(int32 ThreadId)
+	{
+		return Columns[ThreadId];
+	}
+
+	// Read-only view over mapped columns; InBacking must own the memory they point into
+	void BindMapped(TArray<FString>&& InNames, TArray<const float*>&& InColumns, int32 InNumFrames, TSharedPtr<const void> InBacking)
+	{
+		Reset();
+		ThreadNames = MoveTemp(InNames);
+		MappedColumns = MoveTemp(InColumns);
+		NumFrames = InNumFrames;
+		Backing = MoveTemp(InBacking);
+	}
+
+	void Reset()
+	{
+		ThreadNames.Reset();
+		Columns.Reset();
+		MappedColumns.Reset();
+		Backing.Reset();
+		NumFrames = 0;
+	}
+
+private:
+	int32 ReservedFrames = 0;
 
+	TArray<const float*> MappedColumns;
+	TSharedPtr<const void> Backing;
 };
 
 // Aggregated per-thread stats (avg/min/max) for a whole capture or a selected range.
@@ -63,6 +418,25 @@ struct FFrameThreadStats
 	TArray<FThreadStatSummary> Threads;
 };
 
+// Frame-time percentiles per curve for a capture or a selected range.
+USTRUCT()
+struct FPTFramePercentiles
+{
+	GENERATED_BODY()
+
+	FSampledFrameData P50 = {};
+	FSampledFrameData P90 = {};
+	FSampledFrameData P95 = {};
+	FSampledFrameData P99 = {};
+	FSampledFrameData P999 = {};
+
+	// "1% low": FPS over the slowest 1% of frames (mean FrameMS at or above P99)
+	float OnePercentLowFPS = 0.f;
+
+	// False when estimated from the histogram sketch (long captures)
+	bool bExact = true;
+};
+
 USTRUCT()
 struct FPTGraphStatInfo
 {
@@ -76,15 +450,261 @@ struct FPTGraphStatInfo
 
 	FSampledFrameData MinFrameData;
 
-	
+	FSampledFrameData StdDevFrameData;
+
+	FPTFramePercentiles Percentiles;
+
+	// Cost of UPTPerformanceSampler::SampleFrame itself, in microseconds per sampled frame
+	float SamplerOverheadAvgUs = 0.f;
+	float SamplerOverheadMaxUs = 0.f;
+};
+// A sample is a spike on a curve when it exceeds max(AbsoluteMs, RelativeToAvg x running average).
+// Either part can be disabled with 0.
+USTRUCT(BlueprintType)
+struct FPTHitchThreshold
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Hitch", meta = (ClampMin = "0"))
+	float AbsoluteMs = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Hitch", meta = (ClampMin = "0"))
+	float RelativeToAvg = 1.5f;
+
+	float GetThresholdMs(float AvgMs) const
+	{
+		return FMath::Max(AbsoluteMs, RelativeToAvg > 0.f ? RelativeToAvg * AvgMs : 0.f);
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FPTHitchSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Hitch")
+	FPTHitchThreshold Frame;
+
+	UPROPERTY(EditAnywhere, Category = "Hitch")
+	FPTHitchThreshold Game;
+
+	UPROPERTY(EditAnywhere, Category = "Hitch")
+	FPTHitchThreshold Draw;
+
+	UPROPERTY(EditAnywhere, Category = "Hitch")
+	FPTHitchThreshold RHIT;
+
+	UPROPERTY(EditAnywhere, Category = "Hitch")
+	FPTHitchThreshold GPU;
+
+	// Spikes separated by at most this many normal frames belong to the same episode
+	UPROPERTY(EditAnywhere, Category = "Hitch", meta = (ClampMin = "0"))
+	int32 EpisodeMergeGapFrames = 2;
+
+	// Relative thresholds are ignored until the running average has this many frames
+	UPROPERTY(EditAnywhere, Category = "Hitch", meta = (ClampMin = "0"))
+	int32 WarmupFrames = 30;
+
+	// Spike frames kept per node; episodes and time shares keep counting past it
+	UPROPERTY(EditAnywhere, Category = "Hitch", meta = (ClampMin = "0"))
+	int32 MaxEvents = 10000;
+
+	// EPerfCurve / FSampledFrameData member order
+	const FPTHitchThreshold& GetCurve(int32 CurveIndex) const
+	{
+		const FPTHitchThreshold* Curves[] = { &Frame, &Game, &Draw, &RHIT, &GPU };
+		return *Curves[CurveIndex];
+	}
+};
+
+// One spike frame. CurveMask bit c is set for each curve (EPerfCurve order) above its threshold.
+struct FPTHitchEvent
+{
+	int32 FrameIndex = 0;      // frame number since the node started
+	int32 SampleIndex = 0;     // FrameData index holding this frame (differs from FrameIndex when decimated/bucketed)
+	float TimeSeconds = 0.f;   // node time when the frame was sampled
+	float SplineDistance = 0.f;
+	float FrameMS = 0.f;
+	uint32 CurveMask = 0;
+};
+static_assert(sizeof(FPTHitchEvent) == 24, "FPTHitchEvent is written to captures as-is");
+
+// Adjacent spikes merged, see FPTHitchSettings::EpisodeMergeGapFrames
+struct FPTHitchEpisode
+{
+	int32 FirstFrame = 0;
+	int32 LastFrame = 0;
+	int32 FirstSample = 0;
+	int32 LastSample = 0;
+	float StartSeconds = 0.f;
+	float SplineDistance = 0.f; // at the first spike
+	float SpikeTimeMs = 0.f;    // FrameMS summed over the spike frames
+	float PeakFrameMS = 0.f;
+	int32 NumSpikeFrames = 0;
+	uint32 CurveMask = 0;
+};
+static_assert(sizeof(FPTHitchEpisode) == 40, "FPTHitchEpisode is written to captures as-is");
+
+struct FPTHitchReport
+{
+	TArray<FPTHitchEvent> Events;
+	TArray<FPTHitchEpisode> Episodes;
+	int32 NumSpikeFrames = 0;
+	int32 NumDroppedEvents = 0;
+
+	// Per curve (EPerfCurve order): threshold at the final average, spike count,
+	// time spent in that curve's spike frames and the curve's total time
+	float ThresholdMs[5] = {};
+	int32 SpikeCount[5] = {};
+	float SpikeTimeMs[5] = {};
+	float TotalTimeMs[5] = {};
+
+	// Share of this thread's total time spent in its spikes, in percent
+	float GetTimeSharePercent(int32 CurveIndex) const
+	{
+		return TotalTimeMs[CurveIndex] > 0.f ? SpikeTimeMs[CurveIndex] * 100.f / TotalTimeMs[CurveIndex] : 0.f;
+	}
+
+	void Reset()
+	{
+		*this = FPTHitchReport();
+	}
+};
+
+// Memory of one column (MB) over a node: range, and growth from the first to the last sample
+struct FPTMemorySummary
+{
+	FString Name;
+	float StartMB = 0.f;
+	float EndMB = 0.f;
+	float MinMB = 0.f;
+	float MaxMB = 0.f;
+
+	float GetGrowthMB() const { return EndMB - StartMB; }
+
+	static TArray<FPTMemorySummary> Summarize(const FPTThreadTimingStore& Columns)
+	{
+		TArray<FPTMemorySummary> Out;
+		if (Columns.NumFrames <= 0)
+		{
+			return Out;
+		}
+		for (int32 Id = 0; Id < Columns.NumThreads(); ++Id)
+		{
+			const TConstArrayView<float> Column = Columns.GetColumn(Id);
+			FPTMemorySummary& Summary = Out.AddDefaulted_GetRef();
+			Summary.Name = Columns.ThreadNames[Id];
+			Summary.StartMB = Column[0];
+			Summary.EndMB = Column.Last();
+			const FPTColumnRange Range = FPTColumnKernels::MinMax(Column);
+			Summary.MinMB = Range.Min;
+			Summary.MaxMB = Range.Max;
+		}
+		return Out;
+	}
+
+	// "Physical 1812.4-1930.0 MB (+96.2)"
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("%s %.1f-%.1f MB (%+.1f)"), *Name, MinMB, MaxMB, GetGrowthMB());
+	}
 };
+
+// One IPTMetricProvider metric over a node. Bucketed samples are weighted by their frame count, so Avg stays per frame.
+struct FPTMetricSummary
+{
+	FString Name;
+	FString Unit;
+	float Avg = 0.f;
+	float Min = 0.f;
+	float Max = 0.f;
+
+	static TArray<FPTMetricSummary> Summarize(const FPTThreadTimingStore& Columns, TConstArrayView<FString> Units, TConstArrayView<int32> BucketFrameCounts)
+	{
+		TArray<FPTMetricSummary> Out;
+		if (Columns.NumFrames <= 0)
+		{
+			return Out;
+		}
+		const bool bWeighted = BucketFrameCounts.Num() == Columns.NumFrames;
+		for (int32 Id = 0; Id < Columns.NumThreads(); ++Id)
+		{
+			const TConstArrayView<float> Column = Columns.GetColumn(Id);
+			FPTMetricSummary& Summary = Out.AddDefaulted_GetRef();
+			Summary.Name = Columns.ThreadNames[Id];
+			Summary.Unit = Units.IsValidIndex(Id) ? Units[Id] : FString();
+			const FPTColumnRange Range = FPTColumnKernels::MinMax(Column);
+			Summary.Min = Range.Min;
+			Summary.Max = Range.Max;
+			if (!bWeighted)
+			{
+				Summary.Avg = (float)(FPTColumnKernels::Sum(Column) / Column.Num());
+				continue;
+			}
+			double Sum = 0.0;
+			int64 Weight = 0;
+			for (int32 i = 0; i < Column.Num(); ++i)
+			{
+				const int32 W = FMath::Max(BucketFrameCounts[i], 1);
+				Sum += (double)Column[i] * W;
+				Weight += W;
+			}
+			Summary.Avg = (float)(Sum / Weight);
+		}
+		return Out;
+	}
+
+	// "Draw Calls avg 1843.2 calls (1502-2230)"
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("%s avg %.1f %s (%.0f-%.0f)"), *Name, Avg, *Unit, Min, Max);
+	}
+};
+
 USTRUCT()
 struct FSampledGraphData
 {
 	GENERATED_BODY()
-	TArray<FSampledFrameData> FrameData;
+	// Raw per-frame values; all stats are computed from these
+	FPTFrameColumns FrameData;
+	// EMA-smoothed values (stat unit style), parallel to FrameData; empty for captures recorded without them
+	FPTFrameColumns SmoothedFrameData;
+
+	// EveryFrame: one sample per frame. Decimated/Bucketed: one sample per SamplingInterval seconds,
+	// and for Bucketed FrameData holds bucket means with the bucket extremes and frame counts below
+	EPTSamplingMode SamplingMode = EPTSamplingMode::EveryFrame;
+	float SamplingInterval = 0.f;
+	FPTFrameColumns BucketMin;
+	FPTFrameColumns BucketMax;
+	TArray<int32> BucketFrameCounts;
+
+	// Camera pose per sample (Bucketed: at the start of the bucket); empty for captures recorded without it
+	FPTPathColumns PathData;
+
+	bool HasPathData() const { return PathData.Num() == FrameData.Num() && PathData.Num() > 0; }
+
+	bool IsBucketed() const { return SamplingMode == EPTSamplingMode::Bucketed && BucketFrameCounts.Num() == FrameData.Num(); }
+
+	FPTThreadTimingStore ThreadTimings;
 	FString SplineName;
 	FPTGraphStatInfo StatInfo;
+	FPTHitchReport Hitches;
+
+	// Memory in MB per sample (process, RHI textures, LLM tags), parallel to FrameData; empty when the sampler
+	// did not record memory. Same named-column store as the thread timings.
+	FPTThreadTimingStore MemoryColumns;
+
+	bool HasMemoryData() const { return MemoryColumns.NumThreads() > 0 && MemoryColumns.NumFrames == FrameData.Num(); }
+
+	// Metrics of the registered IPTMetricProvider (draw calls, agents, ...) per sample, Bucketed: bucket means.
+	// Parallel to FrameData; MetricUnits is parallel to the column names.
+	FPTThreadTimingStore MetricColumns;
+	TArray<FString> MetricUnits;
+
+	bool HasMetricData() const { return MetricColumns.NumThreads() > 0 && MetricColumns.NumFrames == FrameData.Num(); }
+
+	// CSV profiler capture / Insights trace recorded while the node sampled; empty when none was
+	FString CsvProfilePath;
+	FString TracePath;
 };
 
-//@TODO: 在分析中点出总共存在多少次样本远高于平均值的峰值，并列出这些峰值所在的帧数和对应的时间戳。同时应当设定一个阈值，只有超过该阈值的峰值才会被记录和显示。并列出这些远高于均值的样本占当前线程的总时间百分比，以便用户了解这些异常峰值对整体性能的影响程度。
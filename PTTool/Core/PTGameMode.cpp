@@ -5,6 +5,21 @@
 #include "PTCameraPawn.h"
 #include "EngineUtils.h"
 #include "PerformanceWindow.h"
+#include "PTCaptureFile.h"
+#include "PTBatchRunner.h"
+#include "Misc/App.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarPTToolAsyncFinalize(
+		TEXT("pttool.AsyncFinalize"),
+		true,
+		TEXT("Finalize completed nodes (stats, percentiles, per-node capture file) on worker tasks so the next node starts at once.\n")
+		TEXT("Off: finalize on the game thread before the next node."));
+}
+
 APTGameMode::APTGameMode()
 {
 	PrimaryActorTick.bCanEverTick = true;
@@ -14,13 +29,32 @@ APTGameMode::APTGameMode()
 void APTGameMode::Tick(float DeltaTimeSeconds)
 {
 	Super::Tick(DeltaTimeSeconds);
+	ProfilerCapture.Tick();
 	if (UniqueCameraPawn&&bShouldTick)
 	{
+		// 预热帧：相机停在起点，不推进也不采样，结束时才开始采样
+		if (WarmupFramesRemaining > 0)
+		{
+			if (--WarmupFramesRemaining == 0)
+			{
+				StartNodeSampling();
+			}
+			return;
+		}
+
 		//@todo: tick Target Actor
 		UniqueCameraPawn->TargetSplineActor->TickSpline(DeltaTimeSeconds);
 		if (bShouldSample)
 		{
-			PerformanceSampler[TestID]->SampleFrame(DeltaTimeSeconds);
+			const APTSplinePathActor* Spline = UniqueCameraPawn->TargetSplineActor;
+			FPTSamplePose Pose;
+			Pose.Distance = Spline->DistanceAlongSpline;
+			if (Spline->PreviewCamera)
+			{
+				Pose.Location = FVector3f(Spline->PreviewCamera->GetComponentLocation());
+				Pose.Rotation = FRotator3f(Spline->PreviewCamera->GetComponentRotation());
+			}
+			PerformanceSampler[TestID]->SampleFrame(DeltaTimeSeconds, Pose);
 
 			
 		}
@@ -37,6 +71,10 @@ void APTGameMode::BeginPlay()
 
 	GetCameraPawn();
 
+	NumRepetitions = FPTBatchRunner::GetRepetitions();
+	RepetitionIndex = 0;
+	CompletedPasses.Reset();
+
 	OnProcessTestNodeDelegate.AddUObject(UniqueCameraPawn, &APTCameraPawn::OnProcessingTestNode);
 
 	OnProcessTestNodeCompleteDelegate.AddUObject(UniqueCameraPawn, &APTCameraPawn::OnProcessTestNodeComplete);
@@ -48,10 +86,37 @@ void APTGameMode::BeginPlay()
 	FTimerHandle TimerHandle;
 	GetWorld()->GetTimerManager().SetTimer(TimerHandle, this,&APTGameMode::StartTest, 1, false, GetGlobalTestDelay());
 
+	// Build agents must never hang on a map that doesn't finish
+	if (FPTBatchRunner::IsEnabled() && FPTBatchRunner::GetTimeout() > 0.f)
+	{
+		FTimerHandle TimeoutHandle;
+		GetWorld()->GetTimerManager().SetTimer(TimeoutHandle, FTimerDelegate::CreateLambda([]()
+		{
+			UE_LOG(LogTemp, Error, TEXT("PTToolBatch: timed out after %.0f s"), FPTBatchRunner::GetTimeout());
+			FPTBatchRunner::RequestExit(FPTBatchRunner::TimedOut);
+		}), FPTBatchRunner::GetTimeout(), false);
+	}
+
 
 	UE_LOG(LogTemp, Warning, TEXT("测试即将开始"));
 }
 
+void APTGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Stopped in the middle of a node: don't leave a trace/CSV capture or the fixed timestep running
+	if (ProfilerCapture.IsActive())
+	{
+		FString CsvPath, TracePath;
+		ProfilerCapture.EndNode(CsvPath, TracePath);
+	}
+	EndFixedTimestep();
+	// Tasks still reading samplers that are about to be collected, or writing a capture
+	WaitForFinalizeTasks();
+	CaptureWriteTask.Wait();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void APTGameMode::GetSplines()
 {
 	for (TActorIterator<APTSplinePathActor> It(GetWorld()); It; ++It)
@@ -150,7 +215,33 @@ void APTGameMode::OnCompleteTestNode()
 {
 	bShouldTick = false;
 	bShouldSample = false;
-	PerformanceSampler[TestID]->OnCompleteSampling();
+	EndFixedTimestep();
+	UPTPerformanceSampler* Sampler = PerformanceSampler[TestID];
+	Sampler->StopSampling();
+	ProfilerCapture.EndNode(Sampler->CsvProfilePath, Sampler->TracePath);
+
+	// Everything the task needs from the spline is read here, actors are game thread only
+	const APTSplinePathActor* Spline = SplineActors.IsValidIndex(TestID) ? SplineActors[TestID] : nullptr;
+	const FString SplineName = Spline ? Spline->GetName() : FString(TEXT("UnknownSpline"));
+	const FString IndividualFile = Spline && Spline->bUseIndividualFile ? FPTCaptureFile::MakeCaptureFilename(SplineName, Spline->SavePath) : FString();
+	auto Finalize = [Sampler, SplineName, IndividualFile]()
+	{
+		Sampler->FinalizeSampling();
+		if (!IndividualFile.IsEmpty())
+		{
+			Sampler->SaveCapture(IndividualFile, SplineName);
+		}
+	};
+
+	// The sampler is only touched by its task from here on; the next node samples into its own sampler
+	if (CVarPTToolAsyncFinalize.GetValueOnGameThread())
+	{
+		NodeFinalizeTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Finalize)));
+	}
+	else
+	{
+		Finalize();
+	}
 	TestID++;
 }
 
@@ -158,54 +249,167 @@ void APTGameMode::OnTestNodeStartTest()
 {
 	bShouldTick = true;
 	bShouldSample = true;
+	const APTSplinePathActor* Spline = UniqueCameraPawn->TargetSplineActor;
+	PerformanceSampler[TestID]->ExpectedDuration = Spline->GetExpectedTestDuration();
+	PerformanceSampler[TestID]->SamplingMode = Spline->SamplingMode;
+	PerformanceSampler[TestID]->SamplingInterval = Spline->SamplingInterval;
+	PerformanceSampler[TestID]->HitchSettings = Spline->HitchSettings;
+	PerformanceSampler[TestID]->bRecordFPS = Spline->bRecordFPS;
+	PerformanceSampler[TestID]->bRecordThreadTimes = Spline->bRecordThreadTimes;
+	PerformanceSampler[TestID]->bRecordMemory = Spline->bRecordMemory;
+
+	if (Spline->bFixedTimestep)
+	{
+		BeginFixedTimestep(Spline->FixedFrameRate);
+		UE_LOG(LogTemp, Log, TEXT("%s: fixed timestep %.1f FPS, %d frames expected"), *Spline->GetName(), Spline->FixedFrameRate,
+			FMath::CeilToInt(PerformanceSampler[TestID]->ExpectedDuration * Spline->FixedFrameRate));
+	}
+
+	WarmupFramesRemaining = FMath::Max(Spline->WarmupFrames, 0);
+	if (WarmupFramesRemaining == 0)
+	{
+		StartNodeSampling();
+	}
+}
+
+void APTGameMode::StartNodeSampling()
+{
+	const APTSplinePathActor* Spline = SplineActors.IsValidIndex(TestID) ? SplineActors[TestID] : nullptr;
+	FString NodeName = Spline ? Spline->GetName() : FString(TEXT("UnknownSpline"));
+	if (NumRepetitions > 1)
+	{
+		NodeName += FString::Printf(TEXT("_Pass%d"), RepetitionIndex + 1);
+	}
+	ProfilerCapture.BeginNode(NodeName, FPTBatchRunner::IsEnabled() ? FPTBatchRunner::GetOutputDirectory() : FString());
 	PerformanceSampler[TestID]->OnStartSampling();
 }
 
+void APTGameMode::BeginFixedTimestep(float FrameRate)
+{
+	if (!bFixedTimestepActive)
+	{
+		bPrevUseFixedTimeStep = FApp::UseFixedTimeStep();
+		bPrevBenchmarking = FApp::IsBenchmarking();
+		PrevFixedDeltaTime = FApp::GetFixedDeltaTime();
+		bFixedTimestepActive = true;
+	}
+	// Benchmarking: no frame rate smoothing or max tick rate wait, frames run as fast as they render
+	FApp::SetBenchmarking(true);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FMath::Max(FrameRate, 1.f));
+}
+
+void APTGameMode::EndFixedTimestep()
+{
+	if (bFixedTimestepActive)
+	{
+		FApp::SetBenchmarking(bPrevBenchmarking);
+		FApp::SetUseFixedTimeStep(bPrevUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PrevFixedDeltaTime);
+		bFixedTimestepActive = false;
+	}
+}
+
+void APTGameMode::WaitForFinalizeTasks()
+{
+	UE::Tasks::Wait(NodeFinalizeTasks);
+	NodeFinalizeTasks.Reset();
+}
+
 void APTGameMode::OnCompleteTest()
 {
-	TArray<FSampledGraphData> SampledGraphData;
-	SampledGraphData.Reserve(PerformanceSampler.Num());
+	// The report needs every node finalized; only the tasks still running are waited on
+	WaitForFinalizeTasks();
 
+	TArray<const UPTPerformanceSampler*> Samplers;
+	TArray<FString> SplineNames;
 	for (int32 i = 0; i < PerformanceSampler.Num(); ++i)
 	{
-		UPTPerformanceSampler* Sampler = PerformanceSampler[i];
+		const UPTPerformanceSampler* Sampler = PerformanceSampler[i];
 		if (!IsValid(Sampler))
 		{
 			continue;
 		}
 
-		APTSplinePathActor* Spline = nullptr;
-		if (SplineActors.IsValidIndex(i))
-		{
-			Spline = SplineActors[i];
-		}
+		const APTSplinePathActor* Spline = SplineActors.IsValidIndex(i) ? SplineActors[i] : nullptr;
+		Samplers.Add(Sampler);
+		SplineNames.Add(Spline ? Spline->GetName() : FString(TEXT("UnknownSpline")));
+	}
+
+	// Column copies of every node, one node per worker
+	TArray<FSampledGraphData> SampledGraphData;
+	SampledGraphData.SetNum(Samplers.Num());
+	ParallelFor(Samplers.Num(), [&Samplers, &SplineNames, &SampledGraphData](int32 Index)
+	{
+		SampledGraphData[Index] = Samplers[Index]->BuildGraphData(SplineNames[Index]);
+	});
 
-		FSampledGraphData GraphData;
 
-		if (Spline)
+	// Whole run in one capture file, reopened later through a memory map instead of being re-parsed.
+	// Repeated runs write one capture per pass.
+	const bool bBatch = FPTBatchRunner::IsEnabled();
+	FString CaptureName = FString::Printf(TEXT("PTCapture_%s"), *GetWorld()->GetMapName());
+	if (NumRepetitions > 1)
+	{
+		CaptureName += FString::Printf(TEXT("_Pass%d"), RepetitionIndex + 1);
+	}
+	const FString CaptureFile = FPTCaptureFile::MakeCaptureFilename(CaptureName, bBatch ? FPTBatchRunner::GetOutputDirectory() : FString());
+
+	// The file write overlaps the next pass or the analyzer; batch runs wait for it, the exit code depends on it.
+	// The run is moved into one shared array read by the writer, the repetitions, the batch summary and the analyzer.
+	CaptureWriteTask.Wait();
+	const TSharedRef<const TArray<FSampledGraphData>> CaptureNodes = MakeShared<const TArray<FSampledGraphData>>(MoveTemp(SampledGraphData));
+	const TSharedRef<std::atomic<bool>> bCaptureWritten = MakeShared<std::atomic<bool>>(false);
+	CaptureWriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [CaptureFile, CaptureNodes, bCaptureWritten]()
+	{
+		bCaptureWritten->store(FPTCaptureFile::Write(CaptureFile, *CaptureNodes));
+	});
+
+	TArray<FPTRepeatedNodeStats> Repetitions;
+	if (NumRepetitions > 1)
+	{
+		CompletedPasses.Add(CaptureNodes);
+		if (++RepetitionIndex < NumRepetitions)
 		{
-			GraphData.SplineName = Spline->GetName();
+			UE_LOG(LogTemp, Display, TEXT("PTTool: pass %d of %d done"), RepetitionIndex, NumRepetitions);
+			StartNextRepetition();
+			return;
 		}
-		else
+
+		Repetitions = FPTRepetitionStats::Aggregate(CompletedPasses);
+		for (const FPTRepeatedNodeStats& Stats : Repetitions)
 		{
-			GraphData.SplineName = TEXT("UnknownSpline");
+			UE_LOG(LogTemp, Log, TEXT("PTRepeat: %s"), *FPTRepetitionStats::FormatNode(Stats));
+			if (Stats.bUnstable)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("PTRepeat: %s is unstable across passes, single-run differences are noise"), *Stats.SplineName);
+			}
 		}
+	}
 
-		// 值拷贝，Stop Playing 后安全
-		GraphData.FrameData = Sampler->FrameData;
-
-		GraphData.StatInfo.AvgFrameData = Sampler->AvgFrameData;
-
-		GraphData.StatInfo.MaxFrameData = Sampler->MaxFrameData;
-
-		GraphData.StatInfo.MinFrameData = Sampler->MinFrameData;
+	// No window in batch runs (-nullrhi has nothing to show it on); the summary and exit code are the result
+	if (bBatch)
+	{
+		CaptureWriteTask.Wait();
+		FPTBatchRunner::RequestExit(FPTBatchRunner::Finish(*CaptureNodes, CaptureFile, bCaptureWritten->load(), GetWorld()->GetMapName(), Repetitions));
+		return;
+	}
 
+	OpenPerformanceAnalyzerWindow(CaptureNodes, TArray<FSampledGraphData>(), MoveTemp(Repetitions));
+}
 
-		GraphData.StatInfo.TestTime = Sampler->TimeDuration;
-		
-		SampledGraphData.Add(MoveTemp(GraphData));
+void APTGameMode::StartNextRepetition()
+{
+	TestID = 0;
+	for (int32 i = 0; i < PerformanceSampler.Num(); ++i)
+	{
+		PerformanceSampler[i] = NewObject<UPTPerformanceSampler>();
+	}
+	for (APTSplinePathActor* Spline : SplineActors)
+	{
+		Spline->ResetPlayback();
 	}
 
-
-	OpenPerformanceAnalyzerWindow(SampledGraphData);
+	FTimerHandle TimerHandle;
+	GetWorld()->GetTimerManager().SetTimer(TimerHandle, this, &APTGameMode::StartTest, 1, false, GetGlobalTestDelay());
 }
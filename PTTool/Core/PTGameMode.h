@@ -7,6 +7,9 @@
 #include "GameFramework/GameModeBase.h"
 #include "TimerManager.h"
 #include "PTSplinePathActor.h"
+#include "PTRepetitionStats.h"
+#include "PTProfilerCapture.h"
+#include "Tasks/Task.h"
 #include "PTGameMode.generated.h"
 
 
@@ -34,6 +37,7 @@ public:
 
 	virtual void Tick(float DeltaTimeSeconds) override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	bool bShouldTick = false;
 	bool bShouldSample = false;
@@ -68,4 +72,37 @@ public:
 	void OnTestNodeStartTest();
 
 	void OnCompleteTest();
+
+	// Repetitions of the whole test plan (-PTToolRepeat) and the finished passes, one capture each
+	int32 NumRepetitions = 1;
+	int32 RepetitionIndex = 0;
+	TArray<TSharedRef<const TArray<FSampledGraphData>>> CompletedPasses;
+
+private:
+	// Fresh samplers and spline state, then the plan runs again from the first node
+	void StartNextRepetition();
+
+	// Deterministic playback of the current node (APTSplinePathActor::bFixedTimestep)
+	void BeginFixedTimestep(float FrameRate);
+	void EndFixedTimestep();
+
+	// Finalization of completed nodes (stats, percentiles, per-node capture file) running on workers while the
+	// next node samples; the report and EndPlay wait on them. Cleared once waited on.
+	TArray<UE::Tasks::FTask> NodeFinalizeTasks;
+	// Write of the last run capture when the analyzer did not need to wait for it
+	UE::Tasks::FTask CaptureWriteTask;
+	void WaitForFinalizeTasks();
+
+	// Profilers of the current node, then sampling; warm-up frames are not profiled
+	void StartNodeSampling();
+	FPTProfilerCapture ProfilerCapture;
+
+	// Warm-up frames left before the current node starts sampling
+	int32 WarmupFramesRemaining = 0;
+
+	// FApp state to restore after a fixed timestep node
+	bool bFixedTimestepActive = false;
+	bool bPrevUseFixedTimeStep = false;
+	bool bPrevBenchmarking = false;
+	double PrevFixedDeltaTime = 0.0;
 };
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTDataType.h"
+#include "PTStatistics.h"
+
+/**
+ * Streaming spike/hitch detection, fed once per frame by the sampler.
+ * Relative thresholds use the running average up to the previous frame, so the node does not need a second
+ * pass over FrameData at completion, and detection works the same in decimated and bucketed sampling modes.
+ */
+class FPTHitchDetector
+{
+public:
+	void Reset(const FPTHitchSettings& InSettings)
+	{
+		Settings = InSettings;
+		Report.Reset();
+		Report.Events.Reserve(FMath::Min(Settings.MaxEvents, 1024));
+		bEpisodeOpen = false;
+	}
+
+	// RunningStats must not include Frame yet
+	void AddFrame(const FSampledFrameData& Frame, const FPTFrameStatAccumulator& RunningStats, int32 SampleIndex, float TimeSeconds, float SplineDistance)
+	{
+		const int32 FrameIndex = (int32)RunningStats.GetCount();
+		const bool bWarm = FrameIndex >= Settings.WarmupFrames;
+		const FSampledFrameData Avg = RunningStats.GetAvg();
+
+		uint32 CurveMask = 0;
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			const FPTHitchThreshold& Threshold = Settings.GetCurve(c);
+			const float ThresholdMs = bWarm ? Threshold.GetThresholdMs(Avg.*PTFrameCurveMembers[c]) : Threshold.AbsoluteMs;
+			const float Value = Frame.*PTFrameCurveMembers[c];
+			if (ThresholdMs > 0.f && Value > ThresholdMs)
+			{
+				CurveMask |= 1u << c;
+				++Report.SpikeCount[c];
+				Report.SpikeTimeMs[c] += Value;
+			}
+		}
+
+		if (CurveMask == 0)
+		{
+			return;
+		}
+		++Report.NumSpikeFrames;
+
+		if (Report.Events.Num() < Settings.MaxEvents)
+		{
+			FPTHitchEvent& Event = Report.Events.AddDefaulted_GetRef();
+			Event.FrameIndex = FrameIndex;
+			Event.SampleIndex = SampleIndex;
+			Event.TimeSeconds = TimeSeconds;
+			Event.SplineDistance = SplineDistance;
+			Event.FrameMS = Frame.FrameMS;
+			Event.CurveMask = CurveMask;
+		}
+		else
+		{
+			++Report.NumDroppedEvents;
+		}
+
+		if (bEpisodeOpen && FrameIndex - Episode.LastFrame <= Settings.EpisodeMergeGapFrames + 1)
+		{
+			Episode.LastFrame = FrameIndex;
+			Episode.LastSample = SampleIndex;
+		}
+		else
+		{
+			CloseEpisode();
+			Episode = FPTHitchEpisode();
+			Episode.FirstFrame = Episode.LastFrame = FrameIndex;
+			Episode.FirstSample = Episode.LastSample = SampleIndex;
+			Episode.StartSeconds = TimeSeconds;
+			Episode.SplineDistance = SplineDistance;
+			bEpisodeOpen = true;
+		}
+		Episode.SpikeTimeMs += Frame.FrameMS;
+		Episode.PeakFrameMS = FMath::Max(Episode.PeakFrameMS, Frame.FrameMS);
+		Episode.CurveMask |= CurveMask;
+		++Episode.NumSpikeFrames;
+	}
+
+	// Closes the last episode and records the per-curve totals and final thresholds
+	void Finish(const FPTFrameStatAccumulator& FinalStats)
+	{
+		CloseEpisode();
+
+		const FSampledFrameData Avg = FinalStats.GetAvg();
+		const FPTStatAccumulator* Curves[] = { &FinalStats.Frame, &FinalStats.Game, &FinalStats.Draw, &FinalStats.RHIT, &FinalStats.GPU };
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			Report.ThresholdMs[c] = Settings.GetCurve(c).GetThresholdMs(Avg.*PTFrameCurveMembers[c]);
+			Report.TotalTimeMs[c] = (float)Curves[c]->GetSum();
+		}
+	}
+
+	const FPTHitchReport& GetReport() const { return Report; }
+
+private:
+	void CloseEpisode()
+	{
+		if (bEpisodeOpen)
+		{
+			Report.Episodes.Add(Episode);
+			bEpisodeOpen = false;
+		}
+	}
+
+	FPTHitchSettings Settings;
+	FPTHitchReport Report;
+	FPTHitchEpisode Episode;
+	bool bEpisodeOpen = false;
+};
@@ -0,0 +1,54 @@
+#include "PTMetricProvider.h"
+
+namespace
+{
+	class FPTLambdaMetricProvider : public IPTMetricProvider
+	{
+	public:
+		FPTLambdaMetricProvider(const FString& InName, const FString& InUnit, TFunction<float()> InGetter)
+			: Desc{ InName, InUnit }
+			, Getter(MoveTemp(InGetter))
+		{
+		}
+
+		virtual void GetMetrics(TArray<FPTMetricDesc>& OutMetrics) const override
+		{
+			OutMetrics.Add(Desc);
+		}
+
+		virtual void SampleMetrics(TArrayView<float> OutValues) override
+		{
+			OutValues[0] = Getter ? Getter() : 0.f;
+		}
+
+	private:
+		FPTMetricDesc Desc;
+		TFunction<float()> Getter;
+	};
+}
+
+FPTMetricRegistry& FPTMetricRegistry::Get()
+{
+	// Defined here so every module registering metrics shares one registry
+	static FPTMetricRegistry Instance;
+	return Instance;
+}
+
+void FPTMetricRegistry::Register(const TSharedRef<IPTMetricProvider>& Provider)
+{
+	check(IsInGameThread());
+	Providers.AddUnique(Provider);
+}
+
+void FPTMetricRegistry::Unregister(const TSharedRef<IPTMetricProvider>& Provider)
+{
+	check(IsInGameThread());
+	Providers.Remove(Provider);
+}
+
+TSharedRef<IPTMetricProvider> FPTMetricRegistry::RegisterMetric(const FString& Name, const FString& Unit, TFunction<float()> Getter)
+{
+	TSharedRef<IPTMetricProvider> Provider = MakeShared<FPTLambdaMetricProvider>(Name, Unit, MoveTemp(Getter));
+	Register(Provider);
+	return Provider;
+}
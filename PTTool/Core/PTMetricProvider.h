@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One named per-frame value of a provider; Unit labels the graph axis ("calls", "agents")
+struct FPTMetricDesc
+{
+	FString Name;
+	FString Unit;
+};
+
+/**
+ * Per-frame metrics from game modules or other plugins, recorded as extra capture columns and listed, plotted
+ * and summarized by the analyzer like the built-in ones:
+ *
+ *   class FCrowdMetrics : public IPTMetricProvider
+ *   {
+ *       virtual void GetMetrics(TArray<FPTMetricDesc>& OutMetrics) const override
+ *       {
+ *           OutMetrics.Add({ TEXT("AI Agents"), TEXT("agents") });
+ *           OutMetrics.Add({ TEXT("Crowd Queries"), TEXT("queries") });
+ *       }
+ *       virtual void SampleMetrics(TArrayView<float> OutValues) override { ... }
+ *   };
+ *   FPTMetricRegistry::Get().Register(MakeShared<FCrowdMetrics>());
+ *
+ * A single value can skip the class: FPTMetricRegistry::Get().RegisterMetric(TEXT("Net Actors"), TEXT("actors"), [] { ... });
+ */
+class IPTMetricProvider
+{
+public:
+	virtual ~IPTMetricProvider() = default;
+
+	// Metrics this provider fills; read once when a node starts sampling, so it must not change mid-node
+	virtual void GetMetrics(TArray<FPTMetricDesc>& OutMetrics) const = 0;
+
+	// Game thread, once per sampled frame: one value per metric of GetMetrics, in the same order
+	virtual void SampleMetrics(TArrayView<float> OutValues) = 0;
+};
+
+/**
+ * Providers polled by the sampler. Game thread only. Each node takes a snapshot of the registered providers
+ * when it starts sampling, so (un)registering mid-node takes effect on the next node.
+ */
+class PTTOOL_API FPTMetricRegistry
+{
+public:
+	static FPTMetricRegistry& Get();
+
+	void Register(const TSharedRef<IPTMetricProvider>& Provider);
+	void Unregister(const TSharedRef<IPTMetricProvider>& Provider);
+
+	// Registers a provider with one metric read through Getter; unregister it with the returned reference
+	TSharedRef<IPTMetricProvider> RegisterMetric(const FString& Name, const FString& Unit, TFunction<float()> Getter);
+
+	const TArray<TSharedRef<IPTMetricProvider>>& GetProviders() const { return Providers; }
+
+private:
+	TArray<TSharedRef<IPTMetricProvider>> Providers;
+};
@@ -2,146 +2,330 @@
 
 
 #include "PTPerformanceSampler.h"
+#include "PTCaptureFile.h"
+#include "PTScopeTimer.h"
 #include "RHI.h"
 #include "Stats/Stats.h"
 #include "GPUProfiler.h"
 #include "HAL/PlatformTime.h"
-#include "ProfilingDebugging/CsvProfiler.h"
 #include "RenderTimer.h"
-void ComputeChunkedAverage(
-	const TArray<FSampledFrameData>& FrameData,
-	TArray<FSampledFrameData>& OutAvg,
-	int32 ChunkSize)
+#include "RenderingThread.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Async/ParallelFor.h"
+
+namespace
 {
-	check(ChunkSize > 0);
+	// stat unit 使用的权重
+	constexpr double EmaAlpha = 0.1;
+
+	// Extra room over ExpectedDuration x ExpectedFPS before the buffers have to add a chunk
+	constexpr float PreallocationHeadroom = 1.25f;
+
+	TAutoConsoleVariable<float> CVarPTToolExpectedFPS(
+		TEXT("pttool.ExpectedFPS"),
+		120.f,
+		TEXT("Frame rate used to preallocate PTTool sample buffers (ExpectedDuration x ExpectedFPS)."));
+
+	TAutoConsoleVariable<float> CVarPTToolSamplerBudgetUs(
+		TEXT("pttool.SamplerBudgetUs"),
+		50.f,
+		TEXT("Per-frame time budget for UPTPerformanceSampler::SampleFrame in microseconds; exceeding it on average is reported as a warning."));
 
-	const int32 NumFrames = FrameData.Num();
-	const int32 NumChunks = (NumFrames + ChunkSize - 1) / ChunkSize;
+	TAutoConsoleVariable<bool> CVarPTToolAlignThreadTimings(
+		TEXT("pttool.AlignThreadTimings"),
+		true,
+		TEXT("Read render/RHI thread times through frame-tagged markers so every sample holds one frame's times on all threads.\n")
+		TEXT("Off: read GRenderThreadTime/GRHIThreadTime on the game thread, which lags when those threads run behind."));
 
-	OutAvg.Reset();
-	OutAvg.Reserve(NumChunks);
+	TAutoConsoleVariable<float> CVarPTToolMemoryReadInterval(
+		TEXT("pttool.MemoryReadInterval"),
+		0.1f,
+		TEXT("Seconds between memory reads while sampling (FPlatformMemory::GetStats is a system call); samples in between repeat the last read. 0 reads every frame."));
 
-	for (int32 ChunkIndex = 0; ChunkIndex < NumFrames; ChunkIndex += ChunkSize)
+	constexpr double BytesToMB = 1.0 / (1024.0 * 1024.0);
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	// LLM tags recorded when LLM is running (-LLM); the ones that usually move with streaming
+	struct FPTLLMColumn
+	{
+		ELLMTag Tag;
+		const TCHAR* Name;
+	};
+	const FPTLLMColumn PTLLMColumns[] = {
+		{ ELLMTag::Textures, TEXT("LLM Textures") },
+		{ ELLMTag::RenderTargets, TEXT("LLM RenderTargets") },
+		{ ELLMTag::StaticMesh, TEXT("LLM StaticMesh") },
+		{ ELLMTag::SkeletalMesh, TEXT("LLM SkeletalMesh") },
+		{ ELLMTag::Shaders, TEXT("LLM Shaders") },
+		{ ELLMTag::Audio, TEXT("LLM Audio") },
+		{ ELLMTag::Animation, TEXT("LLM Animation") },
+		{ ELLMTag::Physics, TEXT("LLM Physics") },
+		{ ELLMTag::UObject, TEXT("LLM UObject") },
+	};
+#endif
+}
+
+void UPTPerformanceSampler::InternMemoryColumns()
+{
+	MemoryColumnNames.Reset();
+	if (bRecordMemory)
+	{
+		MemoryColumnNames.Add(TEXT("Physical"));
+		MemoryColumnNames.Add(TEXT("Virtual"));
+		MemoryColumnNames.Add(TEXT("RHI Textures"));
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+		if (FLowLevelMemTracker::Get().IsEnabled())
+		{
+			for (const FPTLLMColumn& Column : PTLLMColumns)
+			{
+				MemoryColumnNames.Add(Column.Name);
+			}
+		}
+#endif
+	}
+	MemoryValuesMB.Init(0.f, MemoryColumnNames.Num());
+	MemorySampleValuesMB.Init(0.f, MemoryColumnNames.Num());
+	LastMemoryReadSeconds = -DBL_MAX;
+}
+
+void UPTPerformanceSampler::ReadMemory()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastMemoryReadSeconds < CVarPTToolMemoryReadInterval.GetValueOnGameThread())
 	{
-		const int32 Start = ChunkIndex;
-		const int32 End = FMath::Min(Start + ChunkSize, NumFrames);
+		return;
+	}
+	LastMemoryReadSeconds = Now;
 
-		double Frame = 0.0;
-		double Game = 0.0;
-		double Draw = 0.0;
-		double RHIT = 0.0;
-		double GPU = 0.0;
+	// Same order as InternMemoryColumns
+	const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+	MemoryValuesMB[0] = (float)(Stats.UsedPhysical * BytesToMB);
+	MemoryValuesMB[1] = (float)(Stats.UsedVirtual * BytesToMB);
 
-		const int32 Count = End - Start;
+	FTextureMemoryStats TextureStats;
+	RHIGetTextureMemoryStats(TextureStats);
+	MemoryValuesMB[2] = (float)(FMath::Max<int64>(TextureStats.StreamingMemorySize + TextureStats.NonStreamingMemorySize, 0) * BytesToMB);
 
-		for (int32 i = Start; i < End; ++i)
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (MemoryValuesMB.Num() > 3)
+	{
+		FLowLevelMemTracker& LLM = FLowLevelMemTracker::Get();
+		for (int32 i = 0; i < UE_ARRAY_COUNT(PTLLMColumns); ++i)
 		{
-			const FSampledFrameData& S = FrameData[i];
-			Frame += S.FrameMS;
-			Game += S.GameMS;
-			Draw += S.DrawMS;
-			RHIT += S.RHITMS;
-			GPU += S.GPUMS;
+			MemoryValuesMB[3 + i] = (float)(LLM.GetTagAmountForTracker(ELLMTracker::Default, PTLLMColumns[i].Tag) * BytesToMB);
 		}
+	}
+#endif
+}
 
-		OutAvg.Add({
-			(float)(Frame / Count),
-			(float)(Game / Count),
-			(float)(Draw / Count),
-			(float)(RHIT / Count),
-			(float)(GPU / Count)
-		});
+void UPTPerformanceSampler::InternMetricColumns()
+{
+	MetricProviders = FPTMetricRegistry::Get().GetProviders();
+	MetricProviderOffsets.Reset(MetricProviders.Num() + 1);
+	MetricDescs.Reset();
+	for (const TSharedRef<IPTMetricProvider>& Provider : MetricProviders)
+	{
+		MetricProviderOffsets.Add(MetricDescs.Num());
+		Provider->GetMetrics(MetricDescs);
+	}
+	MetricProviderOffsets.Add(MetricDescs.Num());
+	MetricSampleValues.Init(0.f, MetricDescs.Num());
+	PendingMetricSums.Init(0.f, MetricDescs.Num());
+}
+
+void UPTPerformanceSampler::ReadMetrics(TArray<float>& OutValues)
+{
+	OutValues.SetNumUninitialized(MetricDescs.Num());
+	for (int32 i = 0; i < MetricProviders.Num(); ++i)
+	{
+		const int32 Offset = MetricProviderOffsets[i];
+		MetricProviders[i]->SampleMetrics(TArrayView<float>(OutValues.GetData() + Offset, MetricProviderOffsets[i + 1] - Offset));
+	}
+}
+
+void UPTPerformanceSampler::InternThreadIds()
+{
+	GameThreadId = ThreadTimings.InternThread(TEXT("Game Thread"));
+	RenderThreadId = ThreadTimings.InternThread(TEXT("Render Thread"));
+	RHIThreadId = ThreadTimings.InternThread(TEXT("RHI Thread"));
+	GPUThreadId = ThreadTimings.InternThread(TEXT("GPU"));
+}
+
+void UPTPerformanceSampler::PreallocateBuffers()
+{
+	// Samples per second: frame rate, or one per interval
+	const float ExpectedFPS = SamplingMode == EPTSamplingMode::EveryFrame
+		? FMath::Max(CVarPTToolExpectedFPS.GetValueOnGameThread(), 1.f)
+		: 1.f / SamplingInterval;
+	const int32 ExpectedFrames = ExpectedDuration > 0.f
+		? FMath::CeilToInt(ExpectedDuration * ExpectedFPS * PreallocationHeadroom) + 1
+		: TPTChunkedArray<FSampledFrameData>::ChunkSize;
+
+	FrameData.Reset();
+	FrameData.Reserve(ExpectedFrames);
+	SmoothedFrameData.Reset();
+	SmoothedFrameData.Reserve(bRecordFPS ? ExpectedFrames : 0);
+	PoseData.Reset();
+	PoseData.Reserve(ExpectedFrames);
+
+	const int32 ExpectedBuckets = SamplingMode == EPTSamplingMode::Bucketed ? ExpectedFrames : 0;
+	BucketMinData.Reset();
+	BucketMinData.Reserve(ExpectedBuckets);
+	BucketMaxData.Reset();
+	BucketMaxData.Reserve(ExpectedBuckets);
+	BucketFrameCounts.Reset();
+	BucketFrameCounts.Reserve(ExpectedBuckets);
+
+	ThreadColumns.SetNum(ThreadTimings.NumThreads());
+	for (TPTChunkedArray<float>& Column : ThreadColumns)
+	{
+		Column.Reset();
+		Column.Reserve(ExpectedFrames);
+	}
+	MemoryColumns.SetNum(MemoryColumnNames.Num());
+	for (TPTChunkedArray<float>& Column : MemoryColumns)
+	{
+		Column.Reset();
+		Column.Reserve(ExpectedFrames);
+	}
+	MetricColumns.SetNum(MetricDescs.Num());
+	for (TPTChunkedArray<float>& Column : MetricColumns)
+	{
+		Column.Reset();
+		Column.Reserve(ExpectedFrames);
 	}
+
+	UE_LOG(LogTemp, Log, TEXT("PTTool sampler: preallocated %d samples (%.1f s x %.1f/s, %.1f MB)"),
+	       ExpectedFrames, ExpectedDuration, ExpectedFPS,
+	       (FrameData.GetAllocatedSize() + SmoothedFrameData.GetAllocatedSize() + PoseData.GetAllocatedSize()
+	        + BucketMinData.GetAllocatedSize() + BucketMaxData.GetAllocatedSize() + BucketFrameCounts.GetAllocatedSize()
+	        + (ThreadColumns.Num() + MemoryColumns.Num() + MetricColumns.Num()) * (SIZE_T)ExpectedFrames * sizeof(float)) / (1024.0 * 1024.0));
 }
 
 void UPTPerformanceSampler::OnStartSampling()
 {
+	if (SamplingInterval <= 0.f)
+	{
+		SamplingMode = EPTSamplingMode::EveryFrame;
+	}
+	PendingBucket.Reset();
+	PendingIntervalTime = 0.f;
+
+	ThreadTimings.Reset();
+	GameThreadId = RenderThreadId = RHIThreadId = GPUThreadId = INDEX_NONE;
+	if (bRecordThreadTimes)
+	{
+		InternThreadIds();
+	}
+	InternMemoryColumns();
+	InternMetricColumns();
+	PreallocateBuffers();
+	SelectPipeline();
+	FrameStats.Reset();
+	bHasEma = false;
+	ThreadAccumulators.Reset();
+	ThreadAccumulators.SetNum(ThreadTimings.NumThreads());
+	FrameSketch.Reset();
+	HitchDetector.Reset(HitchSettings);
+	SamplerOverhead.Reset();
+	LastWallClockSeconds = FPlatformTime::Seconds();
+
+	// PTTOOL_SCOPE timers run while a node samples; what they collected before belongs to no frame of it
+	ScopeThreadIds.Reset();
+	PendingScopeSums.Reset();
+	FPTScopeRegistry::Get().Discard();
+	FPTScopeRegistry::Get().SetEnabled(bRecordThreadTimes);
+
+	// Markers of the previous node still in flight land in the old queue. Without thread timings there is
+	// nothing to align, the curves keep the game-thread reads.
+	bAlignThreadTimings = bRecordThreadTimes && CVarPTToolAlignThreadTimings.GetValueOnGameThread();
+	ThreadTimingQueue.Reset();
+	PendingHead = 0;
+	NumPendingFrames = 0;
 }
 
-void UPTPerformanceSampler::OnCompleteSampling()
+void UPTPerformanceSampler::InternScopeColumns(int32 NumScopes)
 {
-	AvgFrameData.GameMS = 0.0f;
-	AvgFrameData.DrawMS = 0.0f;
-	AvgFrameData.RHITMS = 0.0f;
-	AvgFrameData.GPUMS = 0.0f;
-	AvgFrameData.FrameMS = 0.0f;
-	const int32 MinStartIndex = FMath::Clamp(FrameData.Num() / 10, 0, FrameData.Num() - 1);
-	MinFrameData = FrameData[MinStartIndex];
-	UE_LOG(LogTemp, Warning, TEXT(""));
-	UE_LOG(LogTemp, Warning, TEXT("   %d "), FrameData.Num());
-	if (FrameData.Num() <36000)
+	const FPTScopeRegistry& Registry = FPTScopeRegistry::Get();
+	while (ScopeThreadIds.Num() < NumScopes)
 	{
-		int slot = 0;
-		for (const FSampledFrameData& Sample : FrameData)
+		const int32 ThreadId = ThreadTimings.InternThread(TEXT("Scope: ") + Registry.GetScopeName(ScopeThreadIds.Num()));
+		ScopeThreadIds.Add(ThreadId);
+
+		// A scope first seen mid-node reads 0 for the samples already stored
+		while (ThreadColumns.Num() <= ThreadId)
 		{
-			
-			AvgFrameData.FrameMS += Sample.FrameMS;
-			AvgFrameData.GameMS += Sample.GameMS;
-			AvgFrameData.DrawMS += Sample.DrawMS;
-			AvgFrameData.RHITMS += Sample.RHITMS;
-			AvgFrameData.GPUMS += Sample.GPUMS;
-
-			// Max
-			MaxFrameData.FrameMS = FMath::Max(MaxFrameData.FrameMS, Sample.FrameMS);
-			MaxFrameData.GameMS  = FMath::Max(MaxFrameData.GameMS,  Sample.GameMS);
-			MaxFrameData.DrawMS  = FMath::Max(MaxFrameData.DrawMS,  Sample.DrawMS);
-			MaxFrameData.RHITMS  = FMath::Max(MaxFrameData.RHITMS,  Sample.RHITMS);
-			MaxFrameData.GPUMS   = FMath::Max(MaxFrameData.GPUMS,   Sample.GPUMS);
-
-			if (slot >= MinStartIndex && Sample.FrameMS > 0.0f)
+			TPTChunkedArray<float>& Column = ThreadColumns.AddDefaulted_GetRef();
+			Column.Reserve(FrameData.Capacity());
+			for (int32 i = 0; i < FrameData.Num(); ++i)
 			{
-				MinFrameData.FrameMS = FMath::Min(MinFrameData.FrameMS, Sample.FrameMS);
-				MinFrameData.GameMS  = FMath::Min(MinFrameData.GameMS,  Sample.GameMS);
-				MinFrameData.DrawMS  = FMath::Min(MinFrameData.DrawMS,  Sample.DrawMS);
-				MinFrameData.RHITMS  = FMath::Min(MinFrameData.RHITMS,  Sample.RHITMS);
-				MinFrameData.GPUMS   = FMath::Min(MinFrameData.GPUMS,   Sample.GPUMS);
+				Column.Add(0.f);
 			}
-			slot++;
-			
 		}
-		AvgFrameData.FrameMS = AvgFrameData.FrameMS / FrameData.Num();
-		AvgFrameData.GameMS = AvgFrameData.GameMS / FrameData.Num();
-		AvgFrameData.DrawMS = AvgFrameData.DrawMS / FrameData.Num();
-		AvgFrameData.RHITMS = AvgFrameData.RHITMS / FrameData.Num();
-		AvgFrameData.GPUMS = AvgFrameData.GPUMS / FrameData.Num();
 	}
-	else
+	ThreadAccumulators.SetNum(ThreadTimings.NumThreads());
+	PendingScopeSums.SetNumZeroed(NumScopes);
+	ScopeSampleMs.SetNumZeroed(NumScopes);
+}
+
+void UPTPerformanceSampler::OnCompleteSampling()
+{
+	StopSampling();
+	FinalizeSampling();
+}
+
+void UPTPerformanceSampler::StopSampling()
+{
+	FPTScopeRegistry::Get().SetEnabled(false);
+
+	// Frames still waiting for their render/RHI records
+	if (bAlignThreadTimings && NumPendingFrames > 0)
 	{
-		int32 ChunkSize = 0;
-		TArray<FSampledFrameData> FrameAvg;
-		if (FrameData.Num() < 3600000)
-		{
-			ChunkSize = 10000;
-		}
-		else if (FrameData.Num() < 360000000)
-		{
-			ChunkSize = 100'000;
-		}
-		ComputeChunkedAverage(FrameData, FrameAvg, ChunkSize);
-		const int32 Count = FrameAvg.Num();
-		double Frame = 0.0;
-		double Game = 0.0;
-		double Draw = 0.0;
-		double RHIT = 0.0;
-		double GPU = 0.0;
-		for (const FSampledFrameData& S : FrameAvg)
-		{
-			Frame += S.FrameMS;
-			Game += S.GameMS;
-			Draw += S.DrawMS;
-			RHIT += S.RHITMS;
-			GPU += S.GPUMS;
-		}
+		FlushRenderingCommands();
+		DrainThreadTimings(true);
+	}
+
+	// Last partial interval
+	FlushBucket();
 
-		if (Count > 0)
+	// The columns are complete; drop the references so a module can unregister and unload its provider
+	MetricProviders.Reset();
+}
+
+void UPTPerformanceSampler::FinalizeSampling()
+{
+	// Avg/Min/Max/StdDev are accumulated in SampleFrame, completing a node does not walk FrameData for them
+	AvgFrameData = FrameStats.GetAvg();
+	MaxFrameData = FrameStats.GetMax();
+	StdDevFrameData = FrameStats.GetStdDev();
+	MinFrameData = FrameStats.GetMin();
+	// FrameData only holds every frame in EveryFrame mode, otherwise the per-frame sketch is the source
+	if (SamplingMode == EPTSamplingMode::EveryFrame && FrameData.Num() <= FPTPercentileEngine::ExactSampleLimit)
+	{
+		// One selection per curve, each on its own worker over its own column copy
+		FPTPercentileResult PerCurve[PTFrameCurveNum];
+		ParallelFor(PTFrameCurveNum, [this, &PerCurve](int32 Curve)
 		{
-			AvgFrameData.FrameMS = (float)(Frame / Count);
-			AvgFrameData.GameMS = (float)(Game / Count);
-			AvgFrameData.DrawMS = (float)(Draw / Count);
-			AvgFrameData.RHITMS = (float)(RHIT / Count);
-			AvgFrameData.GPUMS = (float)(GPU / Count);
-		}
+			TArray<float> Column;
+			Column.Reserve(FrameData.Num());
+			FrameData.ForEachChunk([&Column, Curve](TConstArrayView<FSampledFrameData> Chunk)
+			{
+				for (const FSampledFrameData& Frame : Chunk)
+				{
+					Column.Add(Frame.*PTFrameCurveMembers[Curve]);
+				}
+			});
+			PerCurve[Curve] = FPTPercentileEngine::ComputeExact(Column);
+		});
+		Percentiles = FPTPercentileEngine::ToFramePercentiles(PerCurve, true);
+	}
+	else
+	{
+		Percentiles = FPTPercentileEngine::ComputeFromSketch(FrameSketch);
 	}
+	UE_LOG(LogTemp, Warning, TEXT(""));
+	UE_LOG(LogTemp, Warning, TEXT("   %d "), (int32)FrameStats.GetCount());
 	UE_LOG(LogTemp, Log,
 	       TEXT(" Frame %.2f | Game %.2f | Draw %.2f | RHI %.2f | GPU %.2f"),
 	       AvgFrameData.FrameMS,
@@ -166,124 +350,115 @@ void UPTPerformanceSampler::OnCompleteSampling()
 	   MinFrameData.DrawMS,
 	   MinFrameData.RHITMS,
 	   MinFrameData.GPUMS)
-	
-	// ----- 新增：遍历 FrameData，统计各线程远高于平均值的事件次数和占比 -----
+
+	UE_LOG(LogTemp, Log,
+	   TEXT(" STDDEV Frame %.2f | Game %.2f | Draw %.2f | RHI %.2f | GPU %.2f"),
+	   StdDevFrameData.FrameMS,
+	   StdDevFrameData.GameMS,
+	   StdDevFrameData.DrawMS,
+	   StdDevFrameData.RHITMS,
+	   StdDevFrameData.GPUMS)
+
+	const TPair<const TCHAR*, const FSampledFrameData*> PercentileRows[] =
+	{
+		{ TEXT("P50"), &Percentiles.P50 },
+		{ TEXT("P90"), &Percentiles.P90 },
+		{ TEXT("P95"), &Percentiles.P95 },
+		{ TEXT("P99"), &Percentiles.P99 },
+		{ TEXT("P99.9"), &Percentiles.P999 }
+	};
+	for (const TPair<const TCHAR*, const FSampledFrameData*>& Row : PercentileRows)
 	{
-		// Assumptions: "远高于平均值" defined as > ThresholdMultiplier * Average.
-		// If average is nearly zero, we treat values > AbsoluteThresholdMs as an event.
-		const double ThresholdMultiplier = 1.5; // 1.5x average
-		const double AbsoluteThresholdMs = 1.0; // when average ~ 0, treat >1ms as high
+		UE_LOG(LogTemp, Log,
+		   TEXT(" %s Frame %.2f | Game %.2f | Draw %.2f | RHI %.2f | GPU %.2f"),
+		   Row.Key,
+		   Row.Value->FrameMS,
+		   Row.Value->GameMS,
+		   Row.Value->DrawMS,
+		   Row.Value->RHITMS,
+		   Row.Value->GPUMS)
+	}
+	UE_LOG(LogTemp, Log, TEXT(" 1%% Low FPS %.1f (%s)"), Percentiles.OnePercentLowFPS, Percentiles.bExact ? TEXT("exact") : TEXT("histogram estimate"));
 
-		int32 TotalFrames = FrameData.Num();
-		double TotalTimeMs = 0.0;
-		for (const FSampledFrameData& S : FrameData)
+	// Range of every memory and metric column, one column per worker
+	if (FrameData.Num() > 0)
+	{
+		TArray<FVector2f> Ranges;
+		Ranges.SetNumUninitialized(MemoryColumns.Num() + MetricColumns.Num());
+		ParallelFor(Ranges.Num(), [this, &Ranges](int32 Index)
+		{
+			const TPTChunkedArray<float>& Column = Index < MemoryColumns.Num() ? MemoryColumns[Index] : MetricColumns[Index - MemoryColumns.Num()];
+			FPTColumnRange Range;
+			Column.ForEachChunk([&Range](TConstArrayView<float> Chunk)
+			{
+				const FPTColumnRange ChunkRange = FPTColumnKernels::MinMax(Chunk);
+				Range.Min = FMath::Min(Range.Min, ChunkRange.Min);
+				Range.Max = FMath::Max(Range.Max, ChunkRange.Max);
+			});
+			Ranges[Index] = FVector2f(Range.Min, Range.Max);
+		});
+		for (int32 i = 0; i < MemoryColumns.Num(); ++i)
 		{
-			TotalTimeMs += S.FrameMS;
+			UE_LOG(LogTemp, Log, TEXT(" Memory %s %.1f-%.1f MB (%+.1f)"), *MemoryColumnNames[i], Ranges[i].X, Ranges[i].Y, MemoryColumns[i][MemoryColumns[i].Num() - 1] - MemoryColumns[i][0]);
 		}
-		if (TotalFrames > 0 && TotalTimeMs > 0.0)
+		for (int32 i = 0; i < MetricColumns.Num(); ++i)
 		{
-			int32 CountGame = 0;
-			int32 CountDraw = 0;
-			int32 CountRHI = 0;
-			int32 CountGPU = 0;
-
-			double TimeGameMs = 0.0;
-			double TimeDrawMs = 0.0;
-			double TimeRHIMs = 0.0;
-			double TimeGPUMs = 0.0;
-
-			const double AvgGame = FMath::Max<double>(AvgFrameData.GameMS, 0.0);
-			const double AvgDraw = FMath::Max<double>(AvgFrameData.DrawMS, 0.0);
-			const double AvgRHI = FMath::Max<double>(AvgFrameData.RHITMS, 0.0);
-			const double AvgGPU = FMath::Max<double>(AvgFrameData.GPUMS, 0.0);
-
-			for (const FSampledFrameData& S : FrameData)
-			{
-				bool bGameHigh = false;
-				bool bDrawHigh = false;
-				bool bRHIHigh = false;
-				bool bGPUHigh = false;
-
-				// Game thread
-				if (AvgGame > KINDA_SMALL_NUMBER)
-				{
-					if (S.GameMS > AvgGame * ThresholdMultiplier)
-						bGameHigh = true;
-				}
-				else
-				{
-					if (S.GameMS > AbsoluteThresholdMs)
-						bGameHigh = true;
-				}
-
-				// Draw thread
-				if (AvgDraw > KINDA_SMALL_NUMBER)
-				{
-					if (S.DrawMS > AvgDraw * ThresholdMultiplier)
-						bDrawHigh = true;
-				}
-				else
-				{
-					if (S.DrawMS > AbsoluteThresholdMs)
-						bDrawHigh = true;
-				}
-
-				// RHI thread
-				if (AvgRHI > KINDA_SMALL_NUMBER)
-				{
-					if (S.RHITMS > AvgRHI * ThresholdMultiplier)
-						bRHIHigh = true;
-				}
-				else
-				{
-					if (S.RHITMS > AbsoluteThresholdMs)
-						bRHIHigh = true;
-				}
-
-				// GPU
-				if (AvgGPU > KINDA_SMALL_NUMBER)
-				{
-					if (S.GPUMS > AvgGPU * ThresholdMultiplier)
-						bGPUHigh = true;
-				}
-				else
-				{
-					if (S.GPUMS > AbsoluteThresholdMs)
-						bGPUHigh = true;
-				}
-
-				if (bGameHigh)
-				{
-					CountGame++;
-					TimeGameMs += S.FrameMS;
-				}
-				if (bDrawHigh)
-				{
-					CountDraw++;
-					TimeDrawMs += S.FrameMS;
-				}
-				if (bRHIHigh)
-				{
-					CountRHI++;
-					TimeRHIMs += S.FrameMS;
-				}
-				if (bGPUHigh)
-				{
-					CountGPU++;
-					TimeGPUMs += S.FrameMS;
-				}
-			}
+			const FVector2f& Range = Ranges[MemoryColumns.Num() + i];
+			UE_LOG(LogTemp, Log, TEXT(" Metric %s %.0f-%.0f %s"), *MetricDescs[i].Name, Range.X, Range.Y, *MetricDescs[i].Unit);
+		}
+	}
 
-			// Log summary: counts, percent of frames, percent of total time
-			UE_LOG(LogTemp, Log, TEXT("--- High-value event summary (threshold %.2fx avg or > %.2f ms if avg~0) ---"), ThresholdMultiplier, AbsoluteThresholdMs);
-			UE_LOG(LogTemp, Log, TEXT("Game: Count=%d | Frames%%=%.2f%% | Time%%=%.2f%%"), CountGame, (double)CountGame * 100.0 / (double)TotalFrames, TimeGameMs * 100.0 / TotalTimeMs);
-			UE_LOG(LogTemp, Log, TEXT("Draw: Count=%d | Frames%%=%.2f%% | Time%%=%.2f%%"), CountDraw, (double)CountDraw * 100.0 / (double)TotalFrames, TimeDrawMs * 100.0 / TotalTimeMs);
-			UE_LOG(LogTemp, Log, TEXT("RHI:  Count=%d | Frames%%=%.2f%% | Time%%=%.2f%%"), CountRHI, (double)CountRHI * 100.0 / (double)TotalFrames, TimeRHIMs * 100.0 / TotalTimeMs);
-			UE_LOG(LogTemp, Log, TEXT("GPU:  Count=%d | Frames%%=%.2f%% | Time%%=%.2f%%"), CountGPU, (double)CountGPU * 100.0 / (double)TotalFrames, TimeGPUMs * 100.0 / TotalTimeMs);
+	// Sampler self-cost, so captures can show the measurement did not disturb what it measured
+	{
+		const float BudgetUs = CVarPTToolSamplerBudgetUs.GetValueOnAnyThread();
+		const double AvgUs = SamplerOverhead.Mean;
+		const double FrameShare = AvgFrameData.FrameMS > KINDA_SMALL_NUMBER ? AvgUs / (AvgFrameData.FrameMS * 1000.0) * 100.0 : 0.0;
+		const int32 OverflowChunks = FrameData.NumOverflowChunks();
+		if (AvgUs > BudgetUs || OverflowChunks > 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT(" Sampler overhead avg %.1f us | max %.1f us | %.3f%% of frame | budget %.0f us | overflow chunks %d"),
+			       AvgUs, SamplerOverhead.GetMax(), FrameShare, BudgetUs, OverflowChunks);
 		}
 		else
 		{
-			UE_LOG(LogTemp, Warning, TEXT("FrameData empty or zero total time; skipping high-value event analysis"));
+			UE_LOG(LogTemp, Log, TEXT(" Sampler overhead avg %.1f us | max %.1f us | %.3f%% of frame | budget %.0f us"),
+			       AvgUs, SamplerOverhead.GetMax(), FrameShare, BudgetUs);
+		}
+	}
+	
+	// Hitches: spike frames were detected per frame in SampleFrame, close the last episode and add totals
+	{
+		HitchDetector.Finish(FrameStats);
+		const FPTHitchReport& Hitches = HitchDetector.GetReport();
+		const TCHAR* CurveNames[] = { TEXT("Frame"), TEXT("Game"), TEXT("Draw"), TEXT("RHI"), TEXT("GPU") };
+
+		UE_LOG(LogTemp, Log, TEXT("--- Hitches: %d spike frames (%.2f%%) in %d episodes%s ---"),
+		       Hitches.NumSpikeFrames,
+		       FrameStats.GetCount() > 0 ? Hitches.NumSpikeFrames * 100.0 / FrameStats.GetCount() : 0.0,
+		       Hitches.Episodes.Num(),
+		       Hitches.NumDroppedEvents > 0 ? *FString::Printf(TEXT(", %d events over MaxEvents not listed"), Hitches.NumDroppedEvents) : TEXT(""));
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			UE_LOG(LogTemp, Log, TEXT(" %-5s > %.2f ms: Count=%d | Frames%%=%.2f%% | Time%%=%.2f%%"),
+			       CurveNames[c], Hitches.ThresholdMs[c], Hitches.SpikeCount[c],
+			       FrameStats.GetCount() > 0 ? Hitches.SpikeCount[c] * 100.0 / FrameStats.GetCount() : 0.0,
+			       Hitches.GetTimeSharePercent(c));
+		}
+
+		// Worst episodes first, only a few so the node log stays short
+		TArray<const FPTHitchEpisode*> Worst;
+		Worst.Reserve(Hitches.Episodes.Num());
+		for (const FPTHitchEpisode& Episode : Hitches.Episodes)
+		{
+			Worst.Add(&Episode);
+		}
+		Worst.Sort([](const FPTHitchEpisode& A, const FPTHitchEpisode& B) { return A.PeakFrameMS > B.PeakFrameMS; });
+		for (int32 i = 0; i < FMath::Min(Worst.Num(), 5); ++i)
+		{
+			const FPTHitchEpisode& Episode = *Worst[i];
+			UE_LOG(LogTemp, Log, TEXT(" Episode frames %d-%d at %.2f s, distance %.0f: peak %.2f ms, %d spike frames, %.2f ms"),
+			       Episode.FirstFrame, Episode.LastFrame, Episode.StartSeconds, Episode.SplineDistance,
+			       Episode.PeakFrameMS, Episode.NumSpikeFrames, Episode.SpikeTimeMs);
 		}
 	}
 
@@ -292,50 +467,20 @@ void UPTPerformanceSampler::OnCompleteSampling()
 	{
 		CaptureThreadStats.Threads.Reset();
 
-		// name -> index in CaptureThreadStats.Threads
-		TMap<FString, int32> NameToIndex;
-		TMap<FString, double> SumByName;
-		TMap<FString, int32> CountByName;
-		TMap<FString, float> MinByName;
-		TMap<FString, float> MaxByName;
-
-		for (const FSampledFrameData& S : FrameData)
+		CaptureThreadStats.Threads.Reserve(ThreadAccumulators.Num());
+		for (int32 ThreadId = 0; ThreadId < ThreadAccumulators.Num(); ++ThreadId)
 		{
-			for (const FThreadSample& T : S.ThreadData)
+			const FPTStatAccumulator& Acc = ThreadAccumulators[ThreadId];
+			if (Acc.IsEmpty())
 			{
-				// accumulate sum/count
-				SumByName.FindOrAdd(T.ThreadName) += (double)T.TimeMs;
-				CountByName.FindOrAdd(T.ThreadName) += 1;
-
-				// min/max
-				float& CurMin = MinByName.FindOrAdd(T.ThreadName);
-				float& CurMax = MaxByName.FindOrAdd(T.ThreadName);
-				if (CountByName[T.ThreadName] == 1)
-				{
-					CurMin = T.TimeMs;
-					CurMax = T.TimeMs;
-				}
-				else
-				{
-					CurMin = FMath::Min(CurMin, T.TimeMs);
-					CurMax = FMath::Max(CurMax, T.TimeMs);
-				}
+				continue;
 			}
-		}
-
-		// Build summaries
-		CaptureThreadStats.Threads.Reserve(CountByName.Num());
-		for (const TPair<FString, int32>& Pair : CountByName)
-		{
-			const FString& Name = Pair.Key;
-			const int32 Count = Pair.Value;
-			const double Sum = SumByName.FindRef(Name);
 
 			FThreadStatSummary Summary;
-			Summary.ThreadName = Name;
-			Summary.AvgMs = Count > 0 ? (float)(Sum / (double)Count) : 0.f;
-			Summary.MinMs = MinByName.FindRef(Name);
-			Summary.MaxMs = MaxByName.FindRef(Name);
+			Summary.ThreadName = ThreadTimings.ThreadNames[ThreadId];
+			Summary.AvgMs = (float)Acc.Mean;
+			Summary.MinMs = Acc.GetMin();
+			Summary.MaxMs = Acc.GetMax();
 			CaptureThreadStats.Threads.Add(Summary);
 		}
 
@@ -348,83 +493,429 @@ void UPTPerformanceSampler::OnCompleteSampling()
 
 }
 
-void UPTPerformanceSampler::SampleFrame(float DeltaTime)
+FSampledGraphData UPTPerformanceSampler::BuildGraphData(const FString& SplineName) const
 {
-	// 累计时间
-	TimeDuration += DeltaTime;
-	
-	double RawGameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
-	double RawRenderThreadMs = FPlatformTime::ToMilliseconds(GRenderThreadTime);
-	double RawRHIMs = FPlatformTime::ToMilliseconds(GRHIThreadTime);
-	double RawGPUMs = FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles(0)); // GPU 0
-	double RawFrameMs = (FApp::GetCurrentTime() - FApp::GetLastTime()) * 1000.0;
+	FSampledGraphData GraphData;
+	GraphData.SplineName = SplineName;
 
-	// =======================
-	// 平滑值（stat unit 同款 EMA）
-	// =======================
+	// 值拷贝，Stop Playing 后安全
+	GraphData.FrameData.Reserve(FrameData.Num());
+	FrameData.ForEachChunk([&GraphData](TConstArrayView<FSampledFrameData> Chunk)
+	{
+		GraphData.FrameData.AppendFrames(Chunk);
+	});
+	GraphData.SmoothedFrameData.Reserve(SmoothedFrameData.Num());
+	SmoothedFrameData.ForEachChunk([&GraphData](TConstArrayView<FSampledFrameData> Chunk)
+	{
+		GraphData.SmoothedFrameData.AppendFrames(Chunk);
+	});
 
-	// 静态保存上一次的平滑结果（等价于 FStatUnitData 成员）
-	static double GameThreadMs = 0.0;
-	static double RenderThreadMs = 0.0; // Draw
-	static double RHIMs = 0.0;
-	static double GPUMs = 0.0;
-	static double FrameMs = 0.0;
-	// stat unit 使用的权重
-	constexpr double Alpha = 0.1;
-	constexpr double OneMinusAlpha = 0.9;
+	GraphData.PathData.Reserve(PoseData.Num());
+	PoseData.ForEachChunk([&GraphData](TConstArrayView<FPTSamplePose> Chunk)
+	{
+		GraphData.PathData.AppendPoses(Chunk);
+	});
+	GraphData.PathData.BuildDistanceIndex();
+
+	GraphData.SamplingMode = SamplingMode;
+	GraphData.SamplingInterval = SamplingMode == EPTSamplingMode::EveryFrame ? 0.f : SamplingInterval;
+	if (SamplingMode == EPTSamplingMode::Bucketed)
+	{
+		GraphData.BucketMin.Reserve(BucketMinData.Num());
+		BucketMinData.ForEachChunk([&GraphData](TConstArrayView<FSampledFrameData> Chunk)
+		{
+			GraphData.BucketMin.AppendFrames(Chunk);
+		});
+		GraphData.BucketMax.Reserve(BucketMaxData.Num());
+		BucketMaxData.ForEachChunk([&GraphData](TConstArrayView<FSampledFrameData> Chunk)
+		{
+			GraphData.BucketMax.AppendFrames(Chunk);
+		});
+		GraphData.BucketFrameCounts.SetNumUninitialized(BucketFrameCounts.Num());
+		BucketFrameCounts.CopyTo(GraphData.BucketFrameCounts);
+	}
+
+	GraphData.ThreadTimings = ThreadTimings;
+	GraphData.ThreadTimings.SetNumFrames(FrameData.Num());
+	for (int32 ThreadId = 0; ThreadId < ThreadColumns.Num(); ++ThreadId)
+	{
+		ThreadColumns[ThreadId].CopyTo(GraphData.ThreadTimings.GetMutableColumn(ThreadId));
+	}
+
+	GraphData.StatInfo.AvgFrameData = AvgFrameData;
+	GraphData.StatInfo.MaxFrameData = MaxFrameData;
+	GraphData.StatInfo.MinFrameData = MinFrameData;
+	GraphData.StatInfo.StdDevFrameData = StdDevFrameData;
+	GraphData.StatInfo.Percentiles = Percentiles;
+	GraphData.StatInfo.TestTime = TimeDuration;
+	GraphData.StatInfo.SamplerOverheadAvgUs = (float)SamplerOverhead.Mean;
+	GraphData.StatInfo.SamplerOverheadMaxUs = SamplerOverhead.GetMax();
+	GraphData.Hitches = HitchDetector.GetReport();
+	for (const FString& Name : MemoryColumnNames)
+	{
+		GraphData.MemoryColumns.InternThread(Name);
+	}
+	GraphData.MemoryColumns.SetNumFrames(MemoryColumns.Num() > 0 ? FrameData.Num() : 0);
+	for (int32 i = 0; i < MemoryColumns.Num(); ++i)
+	{
+		MemoryColumns[i].CopyTo(GraphData.MemoryColumns.GetMutableColumn(i));
+	}
+
+	for (const FPTMetricDesc& Desc : MetricDescs)
+	{
+		// Two providers may use the same name; keep both columns apart
+		FString Name = Desc.Name;
+		for (int32 Suffix = 2; GraphData.MetricColumns.FindThread(Name) != INDEX_NONE; ++Suffix)
+		{
+			Name = FString::Printf(TEXT("%s (%d)"), *Desc.Name, Suffix);
+		}
+		GraphData.MetricColumns.InternThread(Name);
+		GraphData.MetricUnits.Add(Desc.Unit);
+	}
+	GraphData.MetricColumns.SetNumFrames(MetricColumns.Num() > 0 ? FrameData.Num() : 0);
+	for (int32 i = 0; i < MetricColumns.Num(); ++i)
+	{
+		MetricColumns[i].CopyTo(GraphData.MetricColumns.GetMutableColumn(i));
+	}
+
+	GraphData.CsvProfilePath = CsvProfilePath;
+	GraphData.TracePath = TracePath;
+	return GraphData;
+}
+
+bool UPTPerformanceSampler::SaveCapture(const FString& Filename, const FString& SplineName) const
+{
+	const FSampledGraphData GraphData = BuildGraphData(SplineName);
+	return FPTCaptureFile::Write(Filename, MakeArrayView(&GraphData, 1));
+}
+
+void UPTPerformanceSampler::StoreSample(const FSampledFrameData& Sample, const FPTSamplePose& Pose)
+{
+	(this->*Pipeline.StoreSample)(Sample, Pose);
+}
+
+template <bool bFPS, bool bThreads, bool bMemory>
+void UPTPerformanceSampler::StoreSampleStages(const FSampledFrameData& Sample, const FPTSamplePose& Pose)
+{
+	FrameData.Add(Sample);
+	PoseData.Add(Pose);
+
+	if constexpr (bFPS)
+	{
+		SmoothedFrameData.Add(EmaFrameData);
+	}
+
+	if constexpr (bThreads)
+	{
+		// Thread columns follow the stored samples (per-thread stats are accumulated per frame in SampleFrame)
+		const float ThreadMs[] = { Sample.GameMS, Sample.DrawMS, Sample.RHITMS, Sample.GPUMS };
+		const int32 ThreadIds[] = { GameThreadId, RenderThreadId, RHIThreadId, GPUThreadId };
+		for (int32 i = 0; i < UE_ARRAY_COUNT(ThreadIds); ++i)
+		{
+			ThreadColumns[ThreadIds[i]].Add(ThreadMs[i]);
+		}
+		for (int32 ScopeId = 0; ScopeId < ScopeThreadIds.Num(); ++ScopeId)
+		{
+			ThreadColumns[ScopeThreadIds[ScopeId]].Add(ScopeSampleMs[ScopeId]);
+		}
+	}
+
+	for (int32 i = 0; i < MetricColumns.Num(); ++i)
+	{
+		MetricColumns[i].Add(MetricSampleValues[i]);
+	}
+
+	if constexpr (bMemory)
+	{
+		// Memory read in SampleFrame of the stored frame (Bucketed: of the last frame of the bucket)
+		for (int32 i = 0; i < MemoryColumns.Num(); ++i)
+		{
+			MemoryColumns[i].Add(MemorySampleValuesMB[i]);
+		}
+	}
+}
+
+void UPTPerformanceSampler::FlushBucket()
+{
+	if (PendingBucket.GetCount() == 0)
+	{
+		return;
+	}
+	const float InvCount = 1.f / (float)PendingBucket.GetCount();
+	for (int32 ScopeId = 0; ScopeId < PendingScopeSums.Num(); ++ScopeId)
+	{
+		ScopeSampleMs[ScopeId] = PendingScopeSums[ScopeId] * InvCount;
+		PendingScopeSums[ScopeId] = 0.f;
+	}
+	for (int32 i = 0; i < PendingMetricSums.Num(); ++i)
+	{
+		MetricSampleValues[i] = PendingMetricSums[i] * InvCount;
+		PendingMetricSums[i] = 0.f;
+	}
+	StoreSample(PendingBucket.GetAvg(), PendingBucketPose);
+	BucketMinData.Add(PendingBucket.GetMin());
+	BucketMaxData.Add(PendingBucket.GetMax());
+	BucketFrameCounts.Add((int32)PendingBucket.GetCount());
+	PendingBucket.Reset();
+}
 
-	FrameMs =
-		OneMinusAlpha * FrameMs +
-		Alpha * RawFrameMs;
-	// Game
-	GameThreadMs = OneMinusAlpha * GameThreadMs + Alpha * RawGameThreadMs;
+void UPTPerformanceSampler::SampleFrame(float DeltaTime, const FPTSamplePose& Pose)
+{
+	const uint64 SampleStartCycles = FPlatformTime::Cycles64();
 
-	// Draw (Render Thread)
-	RenderThreadMs = OneMinusAlpha * RenderThreadMs + Alpha * RawRenderThreadMs;
+	if (!Pipeline.ProcessFrame)
+	{
+		// SampleFrame without OnStartSampling
+		if (bRecordThreadTimes)
+		{
+			InternThreadIds();
+		}
+		InternMemoryColumns();
+		InternMetricColumns();
+		PreallocateBuffers();
+		ThreadAccumulators.SetNum(ThreadTimings.NumThreads());
+		SelectPipeline();
+	}
 
-	// RHI
-	RHIMs = OneMinusAlpha * RHIMs + Alpha * RawRHIMs;
+	if (bAlignThreadTimings && NumPendingFrames == MaxPendingFrames)
+	{
+		// Render/RHI threads are further behind than the queue allows, the oldest frame keeps its game-thread reads
+		ProcessOldestPendingFrame();
+	}
+	FPTPendingFrame& Frame = bAlignThreadTimings ? PendingFrames[(PendingHead + NumPendingFrames++) % MaxPendingFrames] : ImmediateFrame;
+	Frame.DeltaTime = DeltaTime;
+	Frame.Pose = Pose;
+	Frame.ReceivedMask = 0;
+
+	FSampledFrameData& RawFrame = Frame.Frame;
+	RawFrame.GameMS = (float)FPlatformTime::ToMilliseconds(GGameThreadTime);
+	RawFrame.DrawMS = (float)FPlatformTime::ToMilliseconds(GRenderThreadTime);
+	RawFrame.RHITMS = (float)FPlatformTime::ToMilliseconds(GRHIThreadTime);
+	RawFrame.GPUMS = (float)FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles(0)); // GPU 0
+	// Fixed timestep advances FApp time by the simulated delta, so the real frame time comes from the wall clock
+	const double WallClockSeconds = FPlatformTime::Seconds();
+	RawFrame.FrameMS = FApp::UseFixedTimeStep()
+		? (float)((WallClockSeconds - LastWallClockSeconds) * 1000.0)
+		: (float)((FApp::GetCurrentTime() - FApp::GetLastTime()) * 1000.0);
+	LastWallClockSeconds = WallClockSeconds;
+
+	// PTTOOL_SCOPE time of this frame, from every thread's buffer
+	if (bRecordThreadTimes)
+	{
+		FPTScopeRegistry::Get().Drain(Frame.ScopeMs);
+	}
+	// Provider metrics describe the game state of this frame, so they are read now, not when the frame is processed
+	ReadMetrics(Frame.MetricValues);
+	// Memory too, so a spike is stored against the pose where it happened
+	if (bRecordMemory && MemoryValuesMB.Num() > 0)
+	{
+		ReadMemory();
+		Frame.MemoryValuesMB = MemoryValuesMB;
+	}
+
+	if (bAlignThreadTimings)
+	{
+		// The reads above describe the frame that just ended; its marker brings back the render/RHI times of
+		// that same frame once those threads are done with it
+		Frame.FrameNumber = GFrameCounter;
+		ThreadTimingQueue.RequestFrame(Frame.FrameNumber);
+		DrainThreadTimings(false);
+	}
+	else
+	{
+		ProcessFrame(Frame);
+	}
 
-	// GPU
-	GPUMs = OneMinusAlpha * GPUMs + Alpha * RawGPUMs;
+	// Per-frame logging used to cost more than the sampling itself; the node summary is logged in OnCompleteSampling
+	SamplerOverhead.Add((float)(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SampleStartCycles) * 1000.0));
+}
 
-	FSampledFrameData SampledFrameData;
-	SampledFrameData.GameMS = GameThreadMs;
-	SampledFrameData.DrawMS = RenderThreadMs;
-	SampledFrameData.RHITMS = RHIMs;
-	SampledFrameData.GPUMS = GPUMs;
-	SampledFrameData.FrameMS = FrameMs;
+void UPTPerformanceSampler::DrainThreadTimings(bool bFlush)
+{
+	FPTThreadFrameRecord Record;
+	while (ThreadTimingQueue.Dequeue(Record))
+	{
+		// Records of a frame that was already forced out find nothing and are dropped
+		for (int32 i = 0; i < NumPendingFrames; ++i)
+		{
+			FPTPendingFrame& Frame = PendingFrames[(PendingHead + i) % MaxPendingFrames];
+			if (Frame.FrameNumber == Record.FrameNumber)
+			{
+				(Record.Source == FPTThreadFrameRecord::RenderThread ? Frame.Frame.DrawMS : Frame.Frame.RHITMS) = Record.TimeMs;
+				Frame.ReceivedMask |= Record.Source;
+				break;
+			}
+		}
+	}
 
-	// Fill per-thread breakdown (fallback using available metrics)
+	// Oldest first, so samples stay in frame order even if a later frame completed first
+	while (NumPendingFrames > 0 && (bFlush || PendingFrames[PendingHead].ReceivedMask == FPTThreadFrameRecord::All))
 	{
-		FThreadSample T;
-		T.ThreadName = TEXT("Game Thread");
-		T.TimeMs = (float)GameThreadMs;
-		SampledFrameData.ThreadData.Add(T);
+		ProcessOldestPendingFrame();
+	}
+}
+
+void UPTPerformanceSampler::ProcessOldestPendingFrame()
+{
+	ProcessFrame(PendingFrames[PendingHead]);
+	PendingHead = (PendingHead + 1) % MaxPendingFrames;
+	--NumPendingFrames;
+}
+
+void UPTPerformanceSampler::ProcessFrame(const FPTPendingFrame& Frame)
+{
+	(this->*Pipeline.ProcessFrame)(Frame);
+}
+
+template <bool bFPS, bool bThreads, bool bMemory>
+void UPTPerformanceSampler::ProcessFrameStages(const FPTPendingFrame& Frame)
+{
+	const FSampledFrameData& RawFrame = Frame.Frame;
+	const FPTSamplePose& Pose = Frame.Pose;
+	const float DeltaTime = Frame.DeltaTime;
 
-		T.ThreadName = TEXT("Render Thread");
-		T.TimeMs = (float)RenderThreadMs;
-		SampledFrameData.ThreadData.Add(T);
+	// 累计时间
+	TimeDuration += DeltaTime;
 
-		T.ThreadName = TEXT("RHI Thread");
-		T.TimeMs = (float)RHIMs;
-		SampledFrameData.ThreadData.Add(T);
+	// Running average before this frame, so a hitch does not raise its own threshold
+	FPTFrameStatAccumulator StatsBeforeFrame;
 
-		T.ThreadName = TEXT("GPU");
-		T.TimeMs = (float)GPUMs;
-		SampledFrameData.ThreadData.Add(T);
+	// =======================
+	// FPS: 平滑值（stat unit 同款 EMA）、hitch 检测
+	// =======================
+	if constexpr (bFPS)
+	{
+		// 平滑状态属于当前 Sampler（等价于 FStatUnitData 成员），不会从上一个节点带过来。
+		// 第一帧直接取原始值，避免从 0 开始爬升的预热段。
+		if (!bHasEma)
+		{
+			EmaFrameData = RawFrame;
+			bHasEma = true;
+		}
+		else
+		{
+			for (float FSampledFrameData::* Curve : PTFrameCurveMembers)
+			{
+				EmaFrameData.*Curve = (float)((1.0 - EmaAlpha) * EmaFrameData.*Curve + EmaAlpha * RawFrame.*Curve);
+			}
+		}
+		StatsBeforeFrame = FrameStats;
 	}
-	FrameData.Add(SampledFrameData);
+
+	// Streaming stats see every frame whatever the sampling mode, so OnCompleteSampling doesn't need to
+	// re-walk FrameData. They use the raw values so single-frame hitches are not averaged away.
+	// The sketch records with every flag combination: Decimated/Bucketed percentiles and the batch P99 /
+	// 1% low thresholds come from it.
+	FrameStats.Add(RawFrame);
+	FrameSketch.Add(RawFrame);
+
 	// =======================
-	// 现在这些值就是 stat unit 等价结果
+	// Thread timings: per-thread accumulators, PTTOOL_SCOPE columns
 	// =======================
+	if constexpr (bThreads)
+	{
+		ThreadAccumulators[GameThreadId].Add(RawFrame.GameMS);
+		ThreadAccumulators[RenderThreadId].Add(RawFrame.DrawMS);
+		ThreadAccumulators[RHIThreadId].Add(RawFrame.RHITMS);
+		ThreadAccumulators[GPUThreadId].Add(RawFrame.GPUMS);
 
-	// -------- 使用 --------
-	UE_LOG(LogTemp, Log,
-	       TEXT("Unit | Frame %.2f | Game %.2f | Draw %.2f | RHI %.2f | GPU %.2f"),
-	       FrameMs,
-	       GameThreadMs,
-	       RenderThreadMs,
-	       RHIMs,
-	       GPUMs)
+		if (Frame.ScopeMs.Num() > ScopeThreadIds.Num())
+		{
+			InternScopeColumns(Frame.ScopeMs.Num());
+		}
+		for (int32 ScopeId = 0; ScopeId < Frame.ScopeMs.Num(); ++ScopeId)
+		{
+			ThreadAccumulators[ScopeThreadIds[ScopeId]].Add(Frame.ScopeMs[ScopeId]);
+			if (SamplingMode == EPTSamplingMode::Bucketed)
+			{
+				PendingScopeSums[ScopeId] += Frame.ScopeMs[ScopeId];
+			}
+			else
+			{
+				ScopeSampleMs[ScopeId] = Frame.ScopeMs[ScopeId];
+			}
+		}
+	}
+
+	// Provider metrics: every provider registered at OnStartSampling, whatever the bRecord* flags
+	for (int32 i = 0; i < Frame.MetricValues.Num(); ++i)
+	{
+		if (SamplingMode == EPTSamplingMode::Bucketed)
+		{
+			PendingMetricSums[i] += Frame.MetricValues[i];
+		}
+		else
+		{
+			MetricSampleValues[i] = Frame.MetricValues[i];
+		}
+	}
+
+	if constexpr (bMemory)
+	{
+		MemorySampleValuesMB = Frame.MemoryValuesMB;
+	}
+
+	switch (SamplingMode)
+	{
+	case EPTSamplingMode::EveryFrame:
+		StoreSampleStages<bFPS, bThreads, bMemory>(RawFrame, Pose);
+		break;
+
+	case EPTSamplingMode::Decimated:
+		// First frame, then the frame that completes each interval
+		PendingIntervalTime += DeltaTime;
+		if (FrameData.Num() == 0 || PendingIntervalTime >= SamplingInterval)
+		{
+			StoreSampleStages<bFPS, bThreads, bMemory>(RawFrame, Pose);
+			PendingIntervalTime = FMath::Max(PendingIntervalTime - SamplingInterval, 0.f);
+		}
+		break;
+
+	case EPTSamplingMode::Bucketed:
+		if (PendingBucket.GetCount() == 0)
+		{
+			PendingBucketPose = Pose;
+		}
+		PendingBucket.Add(RawFrame);
+		PendingIntervalTime += DeltaTime;
+		if (PendingIntervalTime >= SamplingInterval)
+		{
+			FlushBucket();
+			// Keep the fixed rate, but a single hitch longer than an interval doesn't leave empty buckets behind
+			PendingIntervalTime = FMath::Min(PendingIntervalTime - SamplingInterval, SamplingInterval);
+		}
+		break;
+	}
+
+	if constexpr (bFPS)
+	{
+		// FrameData index this frame ends up in: the open bucket, or the last stored sample
+		const int32 SampleIndex = SamplingMode == EPTSamplingMode::Bucketed && PendingBucket.GetCount() > 0 ? FrameData.Num() : FrameData.Num() - 1;
+		HitchDetector.AddFrame(RawFrame, StatsBeforeFrame, SampleIndex, TimeDuration, Pose.Distance);
+	}
+}
+
+template <bool bFPS, bool bThreads, bool bMemory>
+UPTPerformanceSampler::FPTSamplerPipeline UPTPerformanceSampler::MakePipeline()
+{
+	return { &UPTPerformanceSampler::ProcessFrameStages<bFPS, bThreads, bMemory>, &UPTPerformanceSampler::StoreSampleStages<bFPS, bThreads, bMemory> };
+}
+
+void UPTPerformanceSampler::SelectPipeline()
+{
+	// Indexed by bRecordFPS << 2 | bRecordThreadTimes << 1 | bRecordMemory
+	static const FPTSamplerPipeline Pipelines[] =
+	{
+		MakePipeline<false, false, false>(),
+		MakePipeline<false, false, true>(),
+		MakePipeline<false, true, false>(),
+		MakePipeline<false, true, true>(),
+		MakePipeline<true, false, false>(),
+		MakePipeline<true, false, true>(),
+		MakePipeline<true, true, false>(),
+		MakePipeline<true, true, true>(),
+	};
+	// Memory columns only exist when bRecordMemory was set as they were interned
+	const bool bMemory = bRecordMemory && MemoryValuesMB.Num() > 0;
+	Pipeline = Pipelines[(bRecordFPS ? 4 : 0) | (bRecordThreadTimes && GameThreadId != INDEX_NONE ? 2 : 0) | (bMemory ? 1 : 0)];
 }
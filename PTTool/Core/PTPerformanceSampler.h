@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
 #include "PTDataType.h"
+#include "PTStatistics.h"
+#include "PTChunkedArray.h"
+#include "PTHitchDetector.h"
+#include "PTThreadTimingQueue.h"
+#include "PTMetricProvider.h"
 #include "PTPerformanceSampler.generated.h"
 
 
@@ -18,27 +23,210 @@ public:
 	UPTPerformanceSampler() = default;
 	bool bIsSampling = false;
 
+	// Metrics recorded by the node, read in OnStartSampling. A metric that is off costs no work and no storage
+	// per frame: the per-frame pipeline is specialized for the combination (see SelectPipeline).
+	// FPS: smoothed series and hitch report. Frame curves, their Avg/Min/Max and percentiles always record.
 	bool bRecordFPS = true;
+	// Per-thread columns/stats, PTTOOL_SCOPE columns and render/RHI frame alignment
 	bool bRecordThreadTimes = true;
+	// Memory columns
 	bool bRecordMemory = true;
 
 	virtual void OnStartSampling();
+	// StopSampling then FinalizeSampling, both on the calling thread
 	virtual void OnCompleteSampling();
-	virtual void SampleFrame(float DeltaTime);
+	// Game thread: ends the node (frames waiting for render/RHI times, last bucket, scope timers, providers)
+	void StopSampling();
+	// Stats, percentiles, hitch report and node log of a stopped node. Reads and writes this sampler only, so it
+	// can run on a worker while the game thread starts the next node; large captures split over ParallelFor.
+	void FinalizeSampling();
+	// Pose is where the camera is on the node's spline this frame, stored per sample and with detected hitches
+	virtual void SampleFrame(float DeltaTime, const FPTSamplePose& Pose = FPTSamplePose());
+
+	// Snapshot of the finished node (columns + stats), as handed to the analyzer and capture files
+	FSampledGraphData BuildGraphData(const FString& SplineName) const;
+
+	// Writes this node alone to a .ptcap capture file
+	bool SaveCapture(const FString& Filename, const FString& SplineName) const;
 
 	float GameThreadTimeMs = 0.0f;
 	float DrawThreadTimeMs = 0.0f;
 	float GPUTimeMs = 0.0f;
 
 	float TimeDuration = 0.00f;
-	UPROPERTY(EditAnywhere)
-	TArray<FSampledFrameData> FrameData;
+
+	// Expected node length in seconds, set before OnStartSampling; buffers are preallocated for
+	// ExpectedDuration x pttool.ExpectedFPS frames so SampleFrame never reallocates in a normal run
+	float ExpectedDuration = 0.f;
+
+	// Set before OnStartSampling from the spline's Sampling Parameter. Node stats always see every frame,
+	// the mode only decides what is stored per sample.
+	EPTSamplingMode SamplingMode = EPTSamplingMode::EveryFrame;
+	float SamplingInterval = 0.1f;
+
+	// Raw values in preallocated chunks; growing past the reservation adds a chunk without copying.
+	// One entry per frame, per kept frame (Decimated) or per bucket mean (Bucketed).
+	TPTChunkedArray<FSampledFrameData> FrameData;
+	// Same samples smoothed like stat unit (EMA, alpha 0.1), parallel to FrameData
+	TPTChunkedArray<FSampledFrameData> SmoothedFrameData;
+
+	// Camera pose per stored sample, parallel to FrameData
+	TPTChunkedArray<FPTSamplePose> PoseData;
+
+	// Bucketed only, parallel to FrameData
+	TPTChunkedArray<FSampledFrameData> BucketMinData;
+	TPTChunkedArray<FSampledFrameData> BucketMaxData;
+	TPTChunkedArray<int32> BucketFrameCounts;
+
+	// Thread names (ids) of the capture; its columns are only filled in BuildGraphData
+	FPTThreadTimingStore ThreadTimings;
+	// Per-thread samples, indexed by ThreadTimings thread id (parallel to FrameData)
+	TArray<TPTChunkedArray<float>> ThreadColumns;
+
+	// Wall time spent inside SampleFrame, in microseconds
+	FPTStatAccumulator SamplerOverhead;
+
+	// Set before OnStartSampling from the spline's hitch thresholds
+	FPTHitchSettings HitchSettings;
+	// Spike frames/episodes of the node, detected per frame in SampleFrame
+	FPTHitchDetector HitchDetector;
 
 	FSampledFrameData AvgFrameData = {};
 	FSampledFrameData MaxFrameData = {};
 	FSampledFrameData MinFrameData = {};
+	FSampledFrameData StdDevFrameData = {};
+
+	// Running stats over the raw frames, updated every SampleFrame (Welford), read in O(1) at completion
+	FPTFrameStatAccumulator FrameStats;
+	// Indexed by ThreadTimings thread id
+	TArray<FPTStatAccumulator> ThreadAccumulators;
+
+	// Histogram sketch per curve, used for percentiles when the capture is too long for exact selection
+	FPTFramePercentileSketch FrameSketch;
+	FPTFramePercentiles Percentiles;
+
+	// Profiler files of the node (FPTProfilerCapture), set by the game mode before the capture is built
+	FString CsvProfilePath;
+	FString TracePath;
 
 	// Whole-capture per-thread Avg/Min/Max computed from FrameData.
 	UPROPERTY(VisibleAnywhere)
 	FFrameThreadStats CaptureThreadStats;
+
+private:
+	// EMA state of this sampler only, seeded with the first raw frame of the node
+	FSampledFrameData EmaFrameData = {};
+	bool bHasEma = false;
+
+	// Thread ids in ThreadTimings, interned once in OnStartSampling
+	int32 GameThreadId = INDEX_NONE;
+	int32 RenderThreadId = INDEX_NONE;
+	int32 RHIThreadId = INDEX_NONE;
+	int32 GPUThreadId = INDEX_NONE;
+
+	void InternThreadIds();
+
+	// Sizes FrameData/ThreadColumns from ExpectedDuration
+	void PreallocateBuffers();
+
+	// Appends one stored sample to FrameData/SmoothedFrameData and the thread columns
+	void StoreSample(const FSampledFrameData& Sample, const FPTSamplePose& Pose);
+
+	// Closes the current bucket (Bucketed) into one sample; no-op when it is empty
+	void FlushBucket();
+
+	// Frames of the interval being aggregated, and the time they cover
+	FPTFrameStatAccumulator PendingBucket;
+	float PendingIntervalTime = 0.f;
+	// Pose at the first frame of PendingBucket
+	FPTSamplePose PendingBucketPose;
+
+	// Wall clock at the previous SampleFrame; FApp time is simulated under a fixed timestep
+	double LastWallClockSeconds = 0.0;
+
+	// PTTOOL_SCOPE columns: thread id per scope id, the values of the next stored sample and (Bucketed) the
+	// sums over the open bucket
+	TArray<int32> ScopeThreadIds;
+	TArray<float> ScopeSampleMs;
+	TArray<float> PendingScopeSums;
+	// Registers thread columns for scope ids up to NumScopes
+	void InternScopeColumns(int32 NumScopes);
+
+	// Memory columns (MB, bRecordMemory): names, one value per stored sample, the latest read and the values of
+	// the next stored sample
+	TArray<FString> MemoryColumnNames;
+	TArray<TPTChunkedArray<float>> MemoryColumns;
+	TArray<float> MemoryValuesMB;
+	TArray<float> MemorySampleValuesMB;
+	double LastMemoryReadSeconds = 0.0;
+	// Names for bRecordMemory (process, RHI textures, LLM tags when LLM runs); none when it is off
+	void InternMemoryColumns();
+	// Refreshes MemoryValuesMB, at most once per pttool.MemoryReadInterval
+	void ReadMemory();
+
+	// IPTMetricProvider columns: providers and metrics snapshotted in OnStartSampling, offset of each provider's
+	// first value, the values of the next stored sample and (Bucketed) the sums over the open bucket
+	TArray<TSharedRef<IPTMetricProvider>> MetricProviders;
+	TArray<int32> MetricProviderOffsets;
+	TArray<FPTMetricDesc> MetricDescs;
+	TArray<TPTChunkedArray<float>> MetricColumns;
+	TArray<float> MetricSampleValues;
+	TArray<float> PendingMetricSums;
+	void InternMetricColumns();
+	// Polls every provider into OutValues (one entry per MetricDescs)
+	void ReadMetrics(TArray<float>& OutValues);
+
+	// One game frame read in SampleFrame, waiting for the render/RHI times of the same frame
+	struct FPTPendingFrame
+	{
+		uint64 FrameNumber = 0;
+		FSampledFrameData Frame;
+		FPTSamplePose Pose;
+		float DeltaTime = 0.f;
+		// FPTThreadFrameRecord::ESource bits received so far
+		uint8 ReceivedMask = 0;
+		// Drained PTTOOL_SCOPE times of the frame; the array is reused, so its allocation is kept
+		TArray<float> ScopeMs;
+		// Provider metrics of the frame, reused like ScopeMs
+		TArray<float> MetricValues;
+		// Memory read (throttled) in the frame's SampleFrame, reused like ScopeMs
+		TArray<float> MemoryValuesMB;
+	};
+
+	// pttool.AlignThreadTimings at OnStartSampling
+	bool bAlignThreadTimings = false;
+	FPTThreadTimingQueue ThreadTimingQueue;
+	// Ring of frames in flight. More than MaxPendingFrames and the oldest is processed with its game-thread reads.
+	static constexpr int32 MaxPendingFrames = 8;
+	FPTPendingFrame PendingFrames[MaxPendingFrames];
+	int32 PendingHead = 0;
+	int32 NumPendingFrames = 0;
+	// Used when not aligning: read and processed in the same SampleFrame
+	FPTPendingFrame ImmediateFrame;
+
+	// Moves the queued render/RHI records into their pending frames and processes the complete ones in order;
+	// bFlush processes all of them
+	void DrainThreadTimings(bool bFlush);
+	void ProcessOldestPendingFrame();
+	// Stats, stored samples and hitch detection for one frame, through the selected pipeline
+	void ProcessFrame(const FPTPendingFrame& Frame);
+
+	// ProcessFrame/StoreSample compiled for one combination of the bRecord* flags; disabled stages are
+	// removed by if constexpr, so the per-frame cost is only what is recorded
+	template <bool bFPS, bool bThreads, bool bMemory>
+	void ProcessFrameStages(const FPTPendingFrame& Frame);
+	template <bool bFPS, bool bThreads, bool bMemory>
+	void StoreSampleStages(const FSampledFrameData& Sample, const FPTSamplePose& Pose);
+
+	struct FPTSamplerPipeline
+	{
+		void (UPTPerformanceSampler::*ProcessFrame)(const FPTPendingFrame&) = nullptr;
+		void (UPTPerformanceSampler::*StoreSample)(const FSampledFrameData&, const FPTSamplePose&) = nullptr;
+	};
+	template <bool bFPS, bool bThreads, bool bMemory>
+	static FPTSamplerPipeline MakePipeline();
+
+	// Specialization picked once per node from the bRecord* flags; unset until the first OnStartSampling
+	FPTSamplerPipeline Pipeline;
+	void SelectPipeline();
 };
@@ -0,0 +1,180 @@
+#include "PTProfilerCapture.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "ProfilingDebugging/TraceAuxiliary.h"
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarPTToolCsvCapture(
+		TEXT("pttool.CsvCapture"),
+		false,
+		TEXT("Record a CSV profiler capture per spline node (PTTool/Profiles/<Node>_<timestamp>.csv)."));
+
+	TAutoConsoleVariable<bool> CVarPTToolTraceCapture(
+		TEXT("pttool.TraceCapture"),
+		false,
+		TEXT("Record an Unreal Insights trace (cpu, gpu, frame, bookmark channels) per spline node (PTTool/Profiles/<Node>_<timestamp>.utrace)."));
+
+	const TCHAR* PTToolTraceChannels = TEXT("cpu,gpu,frame,bookmark");
+
+	FString MakeProfileFilename(const FString& Directory, const FString& NodeName, const TCHAR* Extension)
+	{
+		FString Dir = Directory;
+		if (Dir.IsEmpty())
+		{
+			Dir = FPaths::Combine(FPaths::ProjectSavedDir(), PTTOOL_PROFILE_SAVE_SUBDIR);
+		}
+		else if (FPaths::IsRelative(Dir))
+		{
+			Dir = FPaths::Combine(FPaths::ProjectSavedDir(), Dir);
+		}
+		IFileManager::Get().MakeDirectory(*Dir, true);
+
+		const FString Timestamp = FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S"));
+		return FPaths::ConvertRelativePathToFull(FPaths::Combine(Dir, FString::Printf(TEXT("%s_%s%s"), *FPaths::MakeValidFileName(NodeName, TEXT('_')), *Timestamp, Extension)));
+	}
+}
+
+void FPTProfilerCapture::BeginNode(const FString& NodeName, const FString& Directory)
+{
+	if (IsActive())
+	{
+		FString Unused;
+		EndNode(Unused, Unused);
+	}
+	ActiveNode = NodeName;
+	CsvPath.Reset();
+	TracePath.Reset();
+	bOwnsCsv = false;
+	bOwnsTrace = false;
+
+#if CSV_PROFILER
+	if (FCsvProfiler* Csv = FCsvProfiler::Get())
+	{
+		// A capture still running because the previous node's stop is pending is ours, not the session's
+		const bool bOwnCaptureStopping = CsvStopFuture.IsValid() && !CsvStopFuture.IsReady();
+		if (bOwnCaptureStopping || !Csv->IsCapturing())
+		{
+			if (CVarPTToolCsvCapture.GetValueOnGameThread())
+			{
+				CsvPath = MakeProfileFilename(Directory, NodeName, TEXT(".csv"));
+				bOwnsCsv = true;
+				if (bOwnCaptureStopping)
+				{
+					// Misses the node's first frame or two, instead of the whole node
+					bCsvStartPending = true;
+				}
+				else
+				{
+					StartCsvCapture();
+				}
+			}
+		}
+		else
+		{
+			CSV_METADATA(TEXT("PTToolNode"), *NodeName);
+			CSV_EVENT_GLOBAL(TEXT("PTTool Begin %s"), *NodeName);
+		}
+	}
+#endif
+
+#if UE_TRACE_ENABLED
+	if (FTraceAuxiliary::IsConnected())
+	{
+		TracePath = FTraceAuxiliary::GetTraceDestinationString();
+	}
+	else if (CVarPTToolTraceCapture.GetValueOnGameThread())
+	{
+		const FString Filename = MakeProfileFilename(Directory, NodeName, TEXT(".utrace"));
+		if (FTraceAuxiliary::Start(FTraceAuxiliary::EConnectionType::File, *Filename, PTToolTraceChannels))
+		{
+			TracePath = Filename;
+			bOwnsTrace = true;
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("PTTool: could not start trace %s"), *Filename);
+		}
+	}
+	TRACE_BOOKMARK(TEXT("PTTool Begin %s"), *NodeName);
+#endif
+
+	if (bOwnsCsv || bOwnsTrace)
+	{
+		UE_LOG(LogTemp, Log, TEXT("PTTool: %s profiling%s%s"), *NodeName,
+			bOwnsCsv ? *(TEXT(" csv=") + CsvPath) : TEXT(""), bOwnsTrace ? *(TEXT(" trace=") + TracePath) : TEXT(""));
+	}
+}
+
+void FPTProfilerCapture::EndNode(FString& OutCsvPath, FString& OutTracePath)
+{
+	if (!IsActive())
+	{
+		OutCsvPath.Reset();
+		OutTracePath.Reset();
+		return;
+	}
+
+#if UE_TRACE_ENABLED
+	TRACE_BOOKMARK(TEXT("PTTool End %s"), *ActiveNode);
+	if (bOwnsTrace)
+	{
+		FTraceAuxiliary::Stop();
+	}
+#endif
+
+#if CSV_PROFILER
+	if (bCsvStartPending)
+	{
+		// Ended before the previous capture was written: nothing was recorded for this node
+		bCsvStartPending = false;
+		CsvPath.Reset();
+	}
+	else
+	{
+		CSV_EVENT_GLOBAL(TEXT("PTTool End %s"), *ActiveNode);
+		if (bOwnsCsv)
+		{
+			if (FCsvProfiler* Csv = FCsvProfiler::Get())
+			{
+				CsvStopFuture = Csv->EndCapture();
+			}
+		}
+	}
+#endif
+
+	OutCsvPath = CsvPath;
+	OutTracePath = TracePath;
+	ActiveNode.Reset();
+	bOwnsCsv = false;
+	bOwnsTrace = false;
+}
+
+void FPTProfilerCapture::Tick()
+{
+#if CSV_PROFILER
+	if (bCsvStartPending && (!CsvStopFuture.IsValid() || CsvStopFuture.IsReady()))
+	{
+		bCsvStartPending = false;
+		StartCsvCapture();
+	}
+#endif
+}
+
+void FPTProfilerCapture::StartCsvCapture()
+{
+#if CSV_PROFILER
+	if (FCsvProfiler* Csv = FCsvProfiler::Get())
+	{
+		// The capture starts with the next frame and is written out asynchronously after EndCapture
+		CsvStopFuture = TSharedFuture<FString>();
+		Csv->BeginCapture(-1, FPaths::GetPath(CsvPath) + TEXT("/"), FPaths::GetCleanFilename(CsvPath));
+		CSV_METADATA(TEXT("PTToolNode"), *ActiveNode);
+		CSV_EVENT_GLOBAL(TEXT("PTTool Begin %s"), *ActiveNode);
+	}
+#endif
+}
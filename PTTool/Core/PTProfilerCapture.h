@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+// CSV/trace files are written under ProjectSavedDir unless a directory is given (batch runs use -PTToolOutput)
+#ifndef PTTOOL_PROFILE_SAVE_SUBDIR
+#define PTTOOL_PROFILE_SAVE_SUBDIR TEXT("PTTool/Profiles")
+#endif
+
+/**
+ * Engine profilers around one spline node, so a bad region can be opened in CSVToSVG / Unreal Insights without
+ * any manual setup. pttool.CsvCapture starts a CSV profiler capture per node, pttool.TraceCapture a trace file
+ * with the cpu, gpu, frame and bookmark channels. Both only run while the node samples.
+ *
+ * A CSV capture or trace the session already had running (-csvCaptureFrames, -trace) is left alone: the node
+ * boundaries are marked in it with CSV events and trace bookmarks, and for the trace its destination is recorded.
+ *
+ * The CSV profiler stops a capture on the frame after EndCapture and writes it out asynchronously, so back to back
+ * nodes start their capture from Tick once the previous node's one is written.
+ */
+class FPTProfilerCapture
+{
+public:
+	void BeginNode(const FString& NodeName, const FString& Directory = FString());
+
+	// Stops what BeginNode started; the paths are empty for a profiler that was not recorded
+	void EndNode(FString& OutCsvPath, FString& OutTracePath);
+
+	bool IsActive() const { return !ActiveNode.IsEmpty(); }
+
+	// Game thread, every frame: starts a CSV capture BeginNode had to defer
+	void Tick();
+
+private:
+	void StartCsvCapture();
+
+	FString ActiveNode;
+	FString CsvPath;
+	FString TracePath;
+	// Started by BeginNode, so EndNode stops them
+	bool bOwnsCsv = false;
+	bool bOwnsTrace = false;
+	// Our previous capture, stopping: the profiler still reports it as capturing until the future is set
+	TSharedFuture<FString> CsvStopFuture;
+	// BeginNode came while CsvStopFuture was pending; the capture of CsvPath starts in Tick
+	bool bCsvStartPending = false;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTDataType.h"
+#include "PTStatistics.h"
+
+// Spread of one per-pass value (a node's average, or its P99) over the repetitions of a run
+struct FPTRepeatedValueStats
+{
+	float MeanOfMeans = 0.f;
+	float StdDev = 0.f;        // between passes (N-1)
+	float CVPercent = 0.f;     // StdDev / MeanOfMeans
+	float CILow = 0.f;         // 95% confidence interval of the mean (Student t)
+	float CIHigh = 0.f;
+	float MinPass = 0.f;
+	float MaxPass = 0.f;
+
+	float GetCIHalfWidth() const { return 0.5f * (CIHigh - CILow); }
+};
+
+struct FPTRepeatedNodeStats
+{
+	FString SplineName;
+	int32 NumPasses = 0;
+	// Per-pass averages of each curve (EPerfCurve order)
+	FPTRepeatedValueStats Curves[5];
+	// Per-pass frame P99, tail stability is usually worse than the average's
+	FPTRepeatedValueStats FrameP99;
+	// Frame average of each pass, in pass order
+	TArray<float> PassFrameAvg;
+	bool bUnstable = false;
+};
+
+struct FPTRepetitionSettings
+{
+	// Above this between-pass CV of the frame average a node is unstable
+	float MaxCVPercent = 3.f;
+	float MaxP99CVPercent = 10.f;
+};
+
+/**
+ * Aggregates N full repetitions of a test plan per node (matched by spline name). Each pass contributes one
+ * value per node, so the interval is about the run-to-run mean and is not fooled by frame autocorrelation.
+ */
+class FPTRepetitionStats
+{
+public:
+	// Passes are shared with the capture writer of each pass, not copied
+	static TArray<FPTRepeatedNodeStats> Aggregate(TConstArrayView<TSharedRef<const TArray<FSampledGraphData>>> Passes, const FPTRepetitionSettings& Settings = FPTRepetitionSettings())
+	{
+		TArray<FPTRepeatedNodeStats> Out;
+		if (Passes.Num() == 0)
+		{
+			return Out;
+		}
+
+		for (const FSampledGraphData& Node : *Passes.Last())
+		{
+			FPTRepeatedNodeStats& Stats = Out.AddDefaulted_GetRef();
+			Stats.SplineName = Node.SplineName;
+
+			FPTStatAccumulator CurveAcc[PTFrameCurveNum];
+			FPTStatAccumulator P99Acc;
+			for (const TSharedRef<const TArray<FSampledGraphData>>& Pass : Passes)
+			{
+				const FSampledGraphData* PassNode = Pass->FindByPredicate([&Node](const FSampledGraphData& N) { return N.SplineName == Node.SplineName; });
+				if (!PassNode || PassNode->StatInfo.TestTime <= 0.f)
+				{
+					continue;
+				}
+				for (int32 c = 0; c < PTFrameCurveNum; ++c)
+				{
+					CurveAcc[c].Add(PassNode->StatInfo.AvgFrameData.*PTFrameCurveMembers[c]);
+				}
+				P99Acc.Add(PassNode->StatInfo.Percentiles.P99.FrameMS);
+				Stats.PassFrameAvg.Add(PassNode->StatInfo.AvgFrameData.FrameMS);
+			}
+
+			Stats.NumPasses = (int32)P99Acc.Count;
+			for (int32 c = 0; c < PTFrameCurveNum; ++c)
+			{
+				Stats.Curves[c] = MakeValueStats(CurveAcc[c]);
+			}
+			Stats.FrameP99 = MakeValueStats(P99Acc);
+			Stats.bUnstable = Stats.NumPasses >= 2
+				&& (Stats.Curves[0].CVPercent > Settings.MaxCVPercent || Stats.FrameP99.CVPercent > Settings.MaxP99CVPercent);
+		}
+		return Out;
+	}
+
+	// Two-sided 95% Student t critical value
+	static float GetStudentT95(int64 DegreesOfFreedom)
+	{
+		static const float Table[] = {
+			12.706f, 4.303f, 3.182f, 2.776f, 2.571f, 2.447f, 2.365f, 2.306f, 2.262f, 2.228f,
+			2.201f, 2.179f, 2.160f, 2.145f, 2.131f, 2.120f, 2.110f, 2.101f, 2.093f, 2.086f,
+			2.080f, 2.074f, 2.069f, 2.064f, 2.060f, 2.056f, 2.052f, 2.048f, 2.045f, 2.042f };
+		if (DegreesOfFreedom <= 0)
+		{
+			return 0.f;
+		}
+		return DegreesOfFreedom <= UE_ARRAY_COUNT(Table) ? Table[DegreesOfFreedom - 1] : 1.96f;
+	}
+
+	// "Name: 5 passes, Frame 16.20 ms ±0.31 (CV 1.5%) | P99 22.10 ±1.20 (CV 4.4%) UNSTABLE"
+	static FString FormatNode(const FPTRepeatedNodeStats& Stats)
+	{
+		const FPTRepeatedValueStats& Frame = Stats.Curves[0];
+		return FString::Printf(TEXT("%s: %d passes, Frame %.2f ms ±%.2f (CV %.1f%%, %.2f-%.2f) | Game %.2f ±%.2f | GPU %.2f ±%.2f | P99 %.2f ±%.2f (CV %.1f%%)%s"),
+			*Stats.SplineName, Stats.NumPasses, Frame.MeanOfMeans, Frame.GetCIHalfWidth(), Frame.CVPercent, Frame.MinPass, Frame.MaxPass,
+			Stats.Curves[1].MeanOfMeans, Stats.Curves[1].GetCIHalfWidth(), Stats.Curves[4].MeanOfMeans, Stats.Curves[4].GetCIHalfWidth(),
+			Stats.FrameP99.MeanOfMeans, Stats.FrameP99.GetCIHalfWidth(), Stats.FrameP99.CVPercent,
+			Stats.bUnstable ? TEXT(" UNSTABLE") : TEXT(""));
+	}
+
+private:
+	static FPTRepeatedValueStats MakeValueStats(const FPTStatAccumulator& Acc)
+	{
+		FPTRepeatedValueStats Out;
+		if (Acc.IsEmpty())
+		{
+			return Out;
+		}
+		Out.MeanOfMeans = (float)Acc.Mean;
+		Out.StdDev = (float)Acc.GetStdDev();
+		Out.CVPercent = Acc.Mean > KINDA_SMALL_NUMBER ? (float)(Acc.GetStdDev() * 100.0 / Acc.Mean) : 0.f;
+		const float HalfWidth = GetStudentT95(Acc.Count - 1) * Out.StdDev / FMath::Sqrt((float)Acc.Count);
+		Out.CILow = Out.MeanOfMeans - HalfWidth;
+		Out.CIHigh = Out.MeanOfMeans + HalfWidth;
+		Out.MinPass = Acc.GetMin();
+		Out.MaxPass = Acc.GetMax();
+		return Out;
+	}
+};
@@ -0,0 +1,76 @@
+#include "PTScopeTimer.h"
+#include "Misc/ScopeLock.h"
+
+FPTScopeRegistry& FPTScopeRegistry::Get()
+{
+	// Defined here so every module using PTTOOL_SCOPE shares one registry
+	static FPTScopeRegistry Instance;
+	return Instance;
+}
+
+int32 FPTScopeRegistry::RegisterScope(const TCHAR* Name)
+{
+	FScopeLock Lock(&Mutex);
+	const int32 Existing = Names.IndexOfByKey(Name);
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+	if (Names.Num() >= MaxScopes)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("PTTOOL_SCOPE: more than %d scope names, '%s' is not recorded"), MaxScopes, Name);
+		return INDEX_NONE;
+	}
+	return Names.Add(Name);
+}
+
+int32 FPTScopeRegistry::NumScopes() const
+{
+	FScopeLock Lock(&Mutex);
+	return Names.Num();
+}
+
+FString FPTScopeRegistry::GetScopeName(int32 ScopeId) const
+{
+	FScopeLock Lock(&Mutex);
+	return Names.IsValidIndex(ScopeId) ? Names[ScopeId] : FString();
+}
+
+FPTScopeRegistry::FThreadBuffer& FPTScopeRegistry::GetThreadBuffer()
+{
+	thread_local FThreadBuffer* Buffer = nullptr;
+	if (!Buffer)
+	{
+		FScopeLock Lock(&Mutex);
+		Buffer = Buffers.Add_GetRef(MakeUnique<FThreadBuffer>()).Get();
+	}
+	return *Buffer;
+}
+
+void FPTScopeRegistry::AddCycles(int32 ScopeId, uint64 Cycles)
+{
+	GetThreadBuffer().Cycles[ScopeId].fetch_add(Cycles, std::memory_order_relaxed);
+}
+
+void FPTScopeRegistry::Drain(TArray<float>& OutMs)
+{
+	FScopeLock Lock(&Mutex);
+	OutMs.SetNumZeroed(Names.Num());
+	for (const TUniquePtr<FThreadBuffer>& Buffer : Buffers)
+	{
+		for (int32 ScopeId = 0; ScopeId < Names.Num(); ++ScopeId)
+		{
+			const uint64 Cycles = Buffer->Cycles[ScopeId].exchange(0, std::memory_order_relaxed);
+			if (Cycles != 0)
+			{
+				OutMs[ScopeId] += (float)FPlatformTime::ToMilliseconds64(Cycles);
+			}
+		}
+	}
+}
+
+void FPTScopeRegistry::Discard()
+{
+	TArray<float> Dropped;
+	Drain(Dropped);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Named CPU scopes recorded next to the thread timings of a capture:
+ *
+ *   void AMyActor::UpdateCrowd()
+ *   {
+ *       PTTOOL_SCOPE("Crowd Update");
+ *       ...
+ *   }
+ *
+ * Each scope gets its own column ("Scope: Crowd Update") holding the inclusive time spent in it per frame, summed
+ * over every thread that ran it. Timers only run while a node is sampling.
+ *
+ * Hot path: the owning thread adds the elapsed cycles into its own thread-local slots (relaxed atomic add, no
+ * locks); the sampler drains all threads once per frame by exchanging the slots with zero. The registry lock is
+ * only taken when a scope name is first seen and when a thread times its first scope.
+ */
+class PTTOOL_API FPTScopeRegistry
+{
+public:
+	static constexpr int32 MaxScopes = 256;
+
+	static FPTScopeRegistry& Get();
+
+	// Id for Name, shared by every call site with the same name; INDEX_NONE once MaxScopes names exist
+	int32 RegisterScope(const TCHAR* Name);
+
+	int32 NumScopes() const;
+	FString GetScopeName(int32 ScopeId) const;
+
+	void SetEnabled(bool bInEnabled) { bEnabled.store(bInEnabled, std::memory_order_relaxed); }
+	bool IsEnabled() const { return bEnabled.load(std::memory_order_relaxed); }
+
+	// Called by FPTScopeTimer on the timed thread
+	void AddCycles(int32 ScopeId, uint64 Cycles);
+
+	// Time per scope id (ms) accumulated on all threads since the previous drain; OutMs gets NumScopes() entries
+	void Drain(TArray<float>& OutMs);
+
+	// Drops whatever was accumulated, e.g. before a node starts sampling
+	void Discard();
+
+private:
+	struct FThreadBuffer
+	{
+		std::atomic<uint64> Cycles[MaxScopes];
+
+		FThreadBuffer()
+		{
+			for (std::atomic<uint64>& Slot : Cycles)
+			{
+				Slot.store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	FThreadBuffer& GetThreadBuffer();
+
+	mutable FCriticalSection Mutex;
+	TArray<FString> Names;
+	// One per thread that ever timed a scope; never freed, a thread-local pointer may still refer to it
+	TArray<TUniquePtr<FThreadBuffer>> Buffers;
+	std::atomic<bool> bEnabled{ false };
+};
+
+class FPTScopeTimer
+{
+public:
+	explicit FPTScopeTimer(int32 InScopeId)
+		: ScopeId(InScopeId != INDEX_NONE && FPTScopeRegistry::Get().IsEnabled() ? InScopeId : INDEX_NONE)
+		, StartCycles(ScopeId != INDEX_NONE ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FPTScopeTimer()
+	{
+		if (ScopeId != INDEX_NONE)
+		{
+			FPTScopeRegistry::Get().AddCycles(ScopeId, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+	FPTScopeTimer(const FPTScopeTimer&) = delete;
+	FPTScopeTimer& operator=(const FPTScopeTimer&) = delete;
+
+private:
+	const int32 ScopeId;
+	const uint64 StartCycles;
+};
+
+// Name must be a string literal
+#define PTTOOL_SCOPE(Name) \
+	static const int32 PREPROCESSOR_JOIN(PTToolScopeId_, __LINE__) = FPTScopeRegistry::Get().RegisterScope(TEXT(Name)); \
+	const FPTScopeTimer PREPROCESSOR_JOIN(PTToolScopeTimer_, __LINE__)(PREPROCESSOR_JOIN(PTToolScopeId_, __LINE__))
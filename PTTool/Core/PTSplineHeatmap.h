@@ -0,0 +1,124 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTDataType.h"
+
+enum class EPTHeatmapStat : uint8
+{
+	Average,
+	P95
+};
+
+/**
+ * Cost of one curve per slice of a spline, built from the recorded path columns of a capture node.
+ * Every loop of the node lands in the same bins, so a bin is "this place in the level", not "this moment".
+ */
+struct FPTSplineHeatmap
+{
+	// Per bin value in ms, 0 for bins without samples
+	TArray<float> BinValues;
+	TArray<int32> BinCounts;
+	float BinLength = 0.f;
+	// Range over the bins that have samples, used for the color scale
+	float MinValue = 0.f;
+	float MaxValue = 0.f;
+
+	int32 Num() const { return BinValues.Num(); }
+
+	// False when the node has no path columns or the spline has no length
+	bool Build(const FSampledGraphData& Node, int32 Curve, EPTHeatmapStat Stat, float SplineLength, int32 NumBins)
+	{
+		BinValues.Reset();
+		BinCounts.Reset();
+		MinValue = MaxValue = 0.f;
+		if (!Node.HasPathData() || SplineLength <= KINDA_SMALL_NUMBER || NumBins <= 0)
+		{
+			return false;
+		}
+
+		BinLength = SplineLength / NumBins;
+		BinValues.Init(0.f, NumBins);
+		BinCounts.Init(0, NumBins);
+
+		const TConstArrayView<float> Distance = Node.PathData.GetColumn(FPTPathColumns::Distance);
+		const TConstArrayView<float> Values = Node.FrameData.GetCurve(Curve);
+		const bool bBucketed = Node.IsBucketed();
+		auto GetBin = [this, NumBins](float D) { return FMath::Clamp(FMath::FloorToInt(D / BinLength), 0, NumBins - 1); };
+
+		if (Stat == EPTHeatmapStat::Average)
+		{
+			// Bucket means weighted by their frame count, so the bin average stays per frame
+			TArray<double> Sums;
+			Sums.Init(0.0, NumBins);
+			for (int32 i = 0; i < Values.Num(); ++i)
+			{
+				const int32 Bin = GetBin(Distance[i]);
+				const int32 Weight = bBucketed ? FMath::Max(Node.BucketFrameCounts[i], 1) : 1;
+				Sums[Bin] += (double)Values[i] * Weight;
+				BinCounts[Bin] += Weight;
+			}
+			for (int32 b = 0; b < NumBins; ++b)
+			{
+				BinValues[b] = BinCounts[b] > 0 ? (float)(Sums[b] / BinCounts[b]) : 0.f;
+			}
+		}
+		else
+		{
+			// Counting sort of the sample indices by bin, then an exact P95 per bin
+			for (int32 i = 0; i < Values.Num(); ++i)
+			{
+				++BinCounts[GetBin(Distance[i])];
+			}
+			TArray<int32> BinStart;
+			BinStart.SetNumUninitialized(NumBins + 1);
+			BinStart[0] = 0;
+			for (int32 b = 0; b < NumBins; ++b)
+			{
+				BinStart[b + 1] = BinStart[b] + BinCounts[b];
+			}
+			TArray<float> Sorted;
+			Sorted.SetNumUninitialized(Values.Num());
+			TArray<int32> Cursor(BinStart.GetData(), NumBins);
+			for (int32 i = 0; i < Values.Num(); ++i)
+			{
+				Sorted[Cursor[GetBin(Distance[i])]++] = Values[i];
+			}
+			for (int32 b = 0; b < NumBins; ++b)
+			{
+				if (BinCounts[b] > 0)
+				{
+					TArrayView<float> BinSamples(Sorted.GetData() + BinStart[b], BinCounts[b]);
+					BinSamples.Sort();
+					BinValues[b] = BinSamples[FMath::Clamp(FMath::CeilToInt(0.95f * BinCounts[b]) - 1, 0, BinCounts[b] - 1)];
+				}
+			}
+		}
+
+		bool bAny = false;
+		for (int32 b = 0; b < NumBins; ++b)
+		{
+			if (BinCounts[b] == 0)
+			{
+				continue;
+			}
+			MinValue = bAny ? FMath::Min(MinValue, BinValues[b]) : BinValues[b];
+			MaxValue = bAny ? FMath::Max(MaxValue, BinValues[b]) : BinValues[b];
+			bAny = true;
+		}
+		return bAny;
+	}
+
+	// Green (cheapest bin) -> yellow -> red (most expensive bin); grey where nothing was sampled
+	FLinearColor GetBinColor(int32 Bin) const
+	{
+		if (!BinCounts.IsValidIndex(Bin) || BinCounts[Bin] == 0)
+		{
+			return FLinearColor(0.3f, 0.3f, 0.3f);
+		}
+		const float Range = MaxValue - MinValue;
+		const float Alpha = Range > KINDA_SMALL_NUMBER ? (BinValues[Bin] - MinValue) / Range : 0.f;
+		return Alpha < 0.5f
+			? FMath::Lerp(FLinearColor::Green, FLinearColor::Yellow, Alpha * 2.f)
+			: FMath::Lerp(FLinearColor::Yellow, FLinearColor::Red, Alpha * 2.f - 1.f);
+	}
+};
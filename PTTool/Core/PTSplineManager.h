@@ -42,12 +42,36 @@ struct FSplineData
 	UPROPERTY(EditAnywhere, Category = "Interesting Feature")
 	float TimeScaling = 1.f;
 
+	UPROPERTY(EditAnywhere, Category = "Deterministic Playback")
+	bool bFixedTimestep = false;
+
+	UPROPERTY(EditAnywhere, Category = "Deterministic Playback")
+	float FixedFrameRate = 60.f;
+
+	UPROPERTY(EditAnywhere, Category = "Deterministic Playback")
+	int32 WarmupFrames = 0;
+
 	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
 	bool bRecordPerformance = true;
 
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	bool bRecordFPS = true;
+
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	bool bRecordThreadTimes = true;
+
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	bool bRecordMemory = true;
+
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	EPTSamplingMode SamplingMode = EPTSamplingMode::EveryFrame;
+
 	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
 	float SamplingInterval = 0.1f;
 
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	FPTHitchSettings HitchSettings;
+
 	UPROPERTY(EditAnywhere, Category = "Saving Parameter")
 	bool bUseIndividualFile = false;
 
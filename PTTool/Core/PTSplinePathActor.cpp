@@ -35,6 +35,14 @@ void APTSplinePathActor::BeginPlay()
 {
 	Super::BeginPlay();
 	SetActorTickEnabled(false);         
+	InitialLoopCount = LoopCount;
+
+	// 预先按距离采样整条 spline，测试时相机求值不再搜索重参数化表
+	if (SplineComponent)
+	{
+		ArcLengthTable.Build(*SplineComponent);
+		UE_LOG(LogTemp, Verbose, TEXT("%s: arc-length table %d entries over %.0f cm"), *GetName(), ArcLengthTable.Entries.Num(), ArcLengthTable.Length);
+	}
 }
 
 void APTSplinePathActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
@@ -55,12 +63,31 @@ void APTSplinePathActor::Tick(float DeltaTime)
 	
 }
 
+float APTSplinePathActor::GetExpectedTestDuration() const
+{
+	if (TestDuration > 0.f)
+	{
+		return TestDuration;
+	}
+	if (!SplineComponent || SplineVelocity <= KINDA_SMALL_NUMBER)
+	{
+		return 0.f;
+	}
+	return GetSplineLength() * FMath::Max(LoopCount, 1) / SplineVelocity;
+}
+
+void APTSplinePathActor::ResetPlayback()
+{
+	DistanceAlongSpline = 0.f;
+	LoopCount = InitialLoopCount;
+}
+
 void APTSplinePathActor::TickSpline(float DeltaTime)
 {
 	DistanceAlongSpline = DistanceAlongSpline + SplineVelocity * DeltaTime;
 	UpdateCameraAlongSpline(DistanceAlongSpline);
 
-	if (DistanceAlongSpline > SplineComponent->GetSplineLength())
+	if (DistanceAlongSpline > GetSplineLength())
 	{
 		UE_LOG(LogTemp, Display, TEXT("Spline 走完了"));
 		LoopCount--;
@@ -85,6 +112,15 @@ void APTSplinePathActor::UpdateCameraAlongSpline(float InDistanceAlongSpline)
 	if (!SplineComponent || !PreviewCamera)
 		return;
 
+	if (ArcLengthTable.IsValid())
+	{
+		FVector NewLocation;
+		FQuat NewRotation;
+		ArcLengthTable.Evaluate(InDistanceAlongSpline, NewLocation, NewRotation);
+		PreviewCamera->SetWorldLocationAndRotation(NewLocation, NewRotation);
+		return;
+	}
+
 	// 保证距离在有效范围内
 	const float MaxDistance = SplineComponent->GetSplineLength();
 	InDistanceAlongSpline = FMath::Clamp(InDistanceAlongSpline, 0.f, MaxDistance);
@@ -93,8 +129,7 @@ void APTSplinePathActor::UpdateCameraAlongSpline(float InDistanceAlongSpline)
 	const FVector NewLocation = SplineComponent->GetLocationAtDistanceAlongSpline(InDistanceAlongSpline, ESplineCoordinateSpace::World);
 	const FRotator NewRotation = SplineComponent->GetRotationAtDistanceAlongSpline(InDistanceAlongSpline, ESplineCoordinateSpace::World);
 
-	PreviewCamera->SetWorldLocation(NewLocation);
-	PreviewCamera->SetWorldRotation(NewRotation);
+	PreviewCamera->SetWorldLocationAndRotation(NewLocation, NewRotation);
 }
 
 void APTSplinePathActor::AddSplinePoint(const FVector& WorldLocation)
@@ -4,10 +4,60 @@
 
 #include "CoreMinimal.h"
 #include "PTToolSplineComponent.h"
+#include "PTDataType.h"
 #include "GameFramework/Actor.h"
 #include "Camera/CameraComponent.h"
 #include "PTSplinePathActor.generated.h"
 
+// Spline sampled at equal distance steps in world space, so evaluating the camera during a test is an index
+// computation and one lerp instead of a reparameterization table search
+struct FPTSplineArcLengthTable
+{
+	struct FEntry
+	{
+		FVector Location;
+		FQuat Rotation;
+	};
+
+	TArray<FEntry> Entries;
+	float Length = 0.f;
+	float InvStep = 0.f;
+
+	bool IsValid() const { return Entries.Num() >= 2; }
+
+	void Build(const USplineComponent& Spline, float StepCm = 10.f, int32 MaxEntries = 16384)
+	{
+		Length = Spline.GetSplineLength();
+		const int32 NumSteps = FMath::Clamp(FMath::CeilToInt(Length / FMath::Max(StepCm, 1.f)), 1, MaxEntries - 1);
+		InvStep = Length > 0.f ? NumSteps / Length : 0.f;
+
+		Entries.SetNumUninitialized(NumSteps + 1);
+		for (int32 i = 0; i <= NumSteps; ++i)
+		{
+			const float Distance = Length * i / NumSteps;
+			FEntry& Entry = Entries[i];
+			Entry.Location = Spline.GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+			Entry.Rotation = Spline.GetQuaternionAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+			// Same hemisphere as the previous entry, so a plain lerp takes the short way
+			if (i > 0 && (Entry.Rotation | Entries[i - 1].Rotation) < 0.f)
+			{
+				Entry.Rotation = -Entry.Rotation;
+			}
+		}
+	}
+
+	void Evaluate(float Distance, FVector& OutLocation, FQuat& OutRotation) const
+	{
+		const float X = FMath::Clamp(Distance, 0.f, Length) * InvStep;
+		const int32 Index = FMath::Min((int32)X, Entries.Num() - 2);
+		const float Alpha = X - Index;
+		const FEntry& A = Entries[Index];
+		const FEntry& B = Entries[Index + 1];
+		OutLocation = FMath::Lerp(A.Location, B.Location, (double)Alpha);
+		OutRotation = FQuat::FastLerp(A.Rotation, B.Rotation, Alpha).GetNormalized();
+	}
+};
+
 UCLASS()
 class PTTOOL_API APTSplinePathActor : public AActor
 {
@@ -28,6 +78,11 @@ public:
 	
 	float DistanceAlongSpline = 0.f;
 
+	// Built at BeginPlay; the spline must not change while testing
+	FPTSplineArcLengthTable ArcLengthTable;
+
+	float GetSplineLength() const { return ArcLengthTable.IsValid() ? ArcLengthTable.Length : SplineComponent->GetSplineLength(); }
+
 	UPROPERTY(EditAnywhere, Category = "Test Parameter")
 	float SplineVelocity = 100.f;
 
@@ -58,15 +113,71 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Interesting Feature")
 	float TimeScaling = 1.f;
 
+	// Deterministic playback: every frame simulates exactly 1 / FixedFrameRate seconds (benchmarking fixed
+	// timestep), so the camera visits the same sequence of transforms whatever the real frame time.
+	// Captures from different builds then line up frame for frame.
+	UPROPERTY(EditAnywhere, Category = "Deterministic Playback")
+	bool bFixedTimestep = false;
+
+	UPROPERTY(EditAnywhere, Category = "Deterministic Playback", meta = (ClampMin = "1", EditCondition = "bFixedTimestep"))
+	float FixedFrameRate = 60.f;
+
+	// Frames rendered at the start of the path before sampling begins; not part of the node's stats
+	UPROPERTY(EditAnywhere, Category = "Deterministic Playback", meta = (ClampMin = "0"))
+	int32 WarmupFrames = 0;
+
 	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
 	bool bRecordPerformance = true;
+
+	// Metrics recorded for this node; what is off adds no per-frame work, for lean runs on min-spec hardware.
+	// FPS: smoothed series and hitch report (frame curves, their averages and percentiles always record).
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	bool bRecordFPS = true;
+
+	// Per-thread columns, PTTOOL_SCOPE timers and render/RHI frame alignment
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	bool bRecordThreadTimes = true;
+
+	// Process, RHI texture and LLM memory per sample
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	bool bRecordMemory = true;
+
+	// EveryFrame stores each frame; Decimated keeps one frame per SamplingInterval; Bucketed keeps min/max/mean/count
+	// of every frame in each interval. Node statistics always include every frame.
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	EPTSamplingMode SamplingMode = EPTSamplingMode::EveryFrame;
+
+	// Seconds per stored sample, used by Decimated and Bucketed
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter", meta = (ClampMin = "0.001", EditCondition = "SamplingMode != EPTSamplingMode::EveryFrame"))
+	float SamplingInterval = 0.1f;
+
+	// Per-curve spike thresholds and episode merging for the hitch report
+	UPROPERTY(EditAnywhere, Category = "Sampling Parameter")
+	FPTHitchSettings HitchSettings;
+
+	// Also write this spline's node to its own .ptcap capture when it completes
+	UPROPERTY(EditAnywhere, Category = "Saving Parameter")
+	bool bUseIndividualFile = false;
+
+	// Capture directory; relative paths are under ProjectSavedDir, empty uses Saved/PTTool/Captures
+	UPROPERTY(EditAnywhere, Category = "Saving Parameter")
+	FString SavePath = "";
 	
 	
+	// TestDuration when set, otherwise the time to travel the spline LoopCount times at SplineVelocity
+	float GetExpectedTestDuration() const;
+
+	// Back to the start of the path with the configured LoopCount, for the next repetition of the test plan
+	void ResetPlayback();
+
 	virtual void TickSpline(float DeltaTime);
 	void UpdateCameraAlongSpline(float InDistanceAlongSpline);
 	
 	void AddSplinePoint(const FVector& WorldLocation);
 protected:
+	// LoopCount at BeginPlay; TickSpline counts LoopCount down
+	int InitialLoopCount = 1;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
@@ -0,0 +1,426 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTDataType.h"
+#include "PTColumnKernels.h"
+#include <algorithm>
+#include <cmath>
+
+// Streaming count/mean/variance/min/max (Welford). O(1) per sample and mergeable,
+// so per-frame updates, per-range summaries and per-chunk partial results all use the same type.
+struct FPTStatAccumulator
+{
+	int64 Count = 0;
+	double Mean = 0.0;
+	double M2 = 0.0;
+	float Min = FLT_MAX;
+	float Max = -FLT_MAX;
+
+	void Add(float Value)
+	{
+		++Count;
+		const double Delta = (double)Value - Mean;
+		Mean += Delta / (double)Count;
+		M2 += Delta * ((double)Value - Mean);
+		Min = FMath::Min(Min, Value);
+		Max = FMath::Max(Max, Value);
+	}
+
+	// Same as Add for every value, for a contiguous column: the column is reduced by FPTColumnKernels (sum, then
+	// squared deviations from its mean) and merged in
+	void AddColumn(TConstArrayView<float> Values)
+	{
+		if (Values.Num() == 0)
+		{
+			return;
+		}
+		FPTStatAccumulator Column;
+		Column.Count = Values.Num();
+		Column.Mean = FPTColumnKernels::Sum(Values) / (double)Column.Count;
+		Column.M2 = FPTColumnKernels::SumSquaredDeviation(Values, Column.Mean);
+		const FPTColumnRange Range = FPTColumnKernels::MinMax(Values);
+		Column.Min = Range.Min;
+		Column.Max = Range.Max;
+		Merge(Column);
+	}
+
+	// Chan et al. parallel combination
+	void Merge(const FPTStatAccumulator& Other)
+	{
+		if (Other.Count == 0)
+		{
+			return;
+		}
+		if (Count == 0)
+		{
+			*this = Other;
+			return;
+		}
+		const int64 Total = Count + Other.Count;
+		const double Delta = Other.Mean - Mean;
+		Mean += Delta * (double)Other.Count / (double)Total;
+		M2 += Other.M2 + Delta * Delta * (double)Count * (double)Other.Count / (double)Total;
+		Count = Total;
+		Min = FMath::Min(Min, Other.Min);
+		Max = FMath::Max(Max, Other.Max);
+	}
+
+	bool IsEmpty() const { return Count == 0; }
+	double GetSum() const { return Mean * (double)Count; }
+	// Sample variance (N-1)
+	double GetVariance() const { return Count > 1 ? M2 / (double)(Count - 1) : 0.0; }
+	double GetStdDev() const { return FMath::Sqrt(GetVariance()); }
+	float GetMin() const { return Count > 0 ? Min : 0.f; }
+	float GetMax() const { return Count > 0 ? Max : 0.f; }
+
+	void Reset() { *this = FPTStatAccumulator(); }
+};
+
+// One accumulator per FSampledFrameData curve, so results read back as FSampledFrameData like the rest of the stats.
+struct FPTFrameStatAccumulator
+{
+	FPTStatAccumulator Frame;
+	FPTStatAccumulator Game;
+	FPTStatAccumulator Draw;
+	FPTStatAccumulator RHIT;
+	FPTStatAccumulator GPU;
+
+	void Add(const FSampledFrameData& S)
+	{
+		Frame.Add(S.FrameMS);
+		Game.Add(S.GameMS);
+		Draw.Add(S.DrawMS);
+		RHIT.Add(S.RHITMS);
+		GPU.Add(S.GPUMS);
+	}
+
+	void Merge(const FPTFrameStatAccumulator& Other)
+	{
+		Frame.Merge(Other.Frame);
+		Game.Merge(Other.Game);
+		Draw.Merge(Other.Draw);
+		RHIT.Merge(Other.RHIT);
+		GPU.Merge(Other.GPU);
+	}
+
+	int64 GetCount() const { return Frame.Count; }
+
+	FSampledFrameData GetAvg() const
+	{
+		return { (float)Frame.Mean, (float)Game.Mean, (float)Draw.Mean, (float)RHIT.Mean, (float)GPU.Mean };
+	}
+
+	FSampledFrameData GetMin() const
+	{
+		return { Frame.GetMin(), Game.GetMin(), Draw.GetMin(), RHIT.GetMin(), GPU.GetMin() };
+	}
+
+	FSampledFrameData GetMax() const
+	{
+		return { Frame.GetMax(), Game.GetMax(), Draw.GetMax(), RHIT.GetMax(), GPU.GetMax() };
+	}
+
+	FSampledFrameData GetStdDev() const
+	{
+		return { (float)Frame.GetStdDev(), (float)Game.GetStdDev(), (float)Draw.GetStdDev(), (float)RHIT.GetStdDev(), (float)GPU.GetStdDev() };
+	}
+
+	void Reset() { *this = FPTFrameStatAccumulator(); }
+};
+
+// FSampledFrameData curves in EPerfCurve order, for code that treats a frame as five columns
+inline float FSampledFrameData::* const PTFrameCurveMembers[] =
+{
+	&FSampledFrameData::FrameMS,
+	&FSampledFrameData::GameMS,
+	&FSampledFrameData::DrawMS,
+	&FSampledFrameData::RHITMS,
+	&FSampledFrameData::GPUMS
+};
+static constexpr int32 PTFrameCurveNum = UE_ARRAY_COUNT(PTFrameCurveMembers);
+
+// Percentiles reported for every curve, in FPTFramePercentiles member order (P50/P90/P95/P99/P99.9)
+static constexpr double PTPercentileRanks[] = { 0.50, 0.90, 0.95, 0.99, 0.999 };
+static constexpr int32 PTPercentileNum = UE_ARRAY_COUNT(PTPercentileRanks);
+static constexpr int32 PTPercentileP99 = 3;
+
+struct FPTPercentileResult
+{
+	float Values[PTPercentileNum] = {};
+	// Mean of the samples at or above P99
+	double WorstOnePercentMean = 0.0;
+};
+
+// Log-linear (HDR style) histogram over milliseconds. Fixed memory, O(1) insert, mergeable,
+// relative error bounded by 1 / SubBuckets. Used as the percentile sketch for long captures.
+struct FPTLogHistogram
+{
+	static constexpr double MinValue = 0.01;   // ms, smaller values land in bucket 0
+	static constexpr int32 NumOctaves = 24;     // covers 0.01 ms .. ~168 s
+	static constexpr int32 SubBuckets = 128;    // < 0.8% relative error
+	static constexpr int32 NumBuckets = NumOctaves * SubBuckets;
+
+	TArray<int64> Counts;
+	int64 TotalCount = 0;
+	float Min = FLT_MAX;
+	float Max = -FLT_MAX;
+
+	static int32 BucketIndex(float Value)
+	{
+		if (!(Value > MinValue))
+		{
+			return 0;
+		}
+		int Exp = 0;
+		const double Mantissa = std::frexp((double)Value / MinValue, &Exp); // [0.5, 1)
+		const int32 Octave = Exp - 1;
+		if (Octave >= NumOctaves)
+		{
+			return NumBuckets - 1;
+		}
+		const int32 Sub = FMath::Min((int32)((Mantissa * 2.0 - 1.0) * SubBuckets), SubBuckets - 1);
+		return Octave * SubBuckets + Sub;
+	}
+
+	static double BucketMid(int32 Index)
+	{
+		const int32 Octave = Index / SubBuckets;
+		const int32 Sub = Index % SubBuckets;
+		const double OctaveBase = MinValue * (double)(1ll << Octave);
+		return OctaveBase * (1.0 + ((double)Sub + 0.5) / SubBuckets);
+	}
+
+	void Add(float Value)
+	{
+		if (Counts.Num() == 0)
+		{
+			Counts.SetNumZeroed(NumBuckets);
+		}
+		++Counts[BucketIndex(Value)];
+		++TotalCount;
+		Min = FMath::Min(Min, Value);
+		Max = FMath::Max(Max, Value);
+	}
+
+	void Merge(const FPTLogHistogram& Other)
+	{
+		if (Other.TotalCount == 0)
+		{
+			return;
+		}
+		if (Counts.Num() == 0)
+		{
+			Counts.SetNumZeroed(NumBuckets);
+		}
+		for (int32 i = 0; i < NumBuckets; ++i)
+		{
+			Counts[i] += Other.Counts[i];
+		}
+		TotalCount += Other.TotalCount;
+		Min = FMath::Min(Min, Other.Min);
+		Max = FMath::Max(Max, Other.Max);
+	}
+
+	FPTPercentileResult ComputePercentiles() const
+	{
+		FPTPercentileResult Result;
+		if (TotalCount == 0)
+		{
+			return Result;
+		}
+
+		int32 Bucket = 0;
+		int64 Cumulative = 0;
+		int64 P99Rank = TotalCount;
+		for (int32 p = 0; p < PTPercentileNum; ++p)
+		{
+			const int64 Rank = FMath::Max<int64>(1, (int64)FMath::CeilToDouble(PTPercentileRanks[p] * (double)TotalCount));
+			while (Bucket < NumBuckets && Cumulative + Counts[Bucket] < Rank)
+			{
+				Cumulative += Counts[Bucket];
+				++Bucket;
+			}
+			// Observed min/max are exact, keep the estimate inside them
+			Result.Values[p] = FMath::Clamp((float)BucketMid(FMath::Min(Bucket, NumBuckets - 1)), Min, Max);
+			if (p == PTPercentileP99)
+			{
+				P99Rank = Rank;
+			}
+		}
+
+		// Walk down from the top until we have the slowest (N - P99Rank + 1) samples
+		const int64 WorstCount = TotalCount - P99Rank + 1;
+		int64 Taken = 0;
+		double Sum = 0.0;
+		for (int32 i = NumBuckets - 1; i >= 0 && Taken < WorstCount; --i)
+		{
+			const int64 Take = FMath::Min(Counts[i], WorstCount - Taken);
+			Sum += FMath::Clamp(BucketMid(i), (double)Min, (double)Max) * (double)Take;
+			Taken += Take;
+		}
+		Result.WorstOnePercentMean = Taken > 0 ? Sum / (double)Taken : 0.0;
+		return Result;
+	}
+
+	void Reset() { *this = FPTLogHistogram(); }
+};
+
+// One histogram per FSampledFrameData curve, fed from SampleFrame
+struct FPTFramePercentileSketch
+{
+	FPTLogHistogram Curves[PTFrameCurveNum];
+
+	void Add(const FSampledFrameData& S)
+	{
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			Curves[c].Add(S.*PTFrameCurveMembers[c]);
+		}
+	}
+
+	void Merge(const FPTFramePercentileSketch& Other)
+	{
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			Curves[c].Merge(Other.Curves[c]);
+		}
+	}
+
+	void Reset()
+	{
+		for (FPTLogHistogram& Curve : Curves)
+		{
+			Curve.Reset();
+		}
+	}
+};
+
+// Percentile engine: exact selection for small inputs, histogram sketch for long ones.
+struct FPTPercentileEngine
+{
+	// Above this many samples percentiles come from the sketch instead of nth_element over a copy
+	static constexpr int32 ExactSampleLimit = 200000;
+
+	// Exact nearest-rank percentiles. Reorders Values in place.
+	static FPTPercentileResult ComputeExact(TArrayView<float> Values)
+	{
+		FPTPercentileResult Result;
+		const int32 Num = Values.Num();
+		if (Num == 0)
+		{
+			return Result;
+		}
+
+		float* Data = Values.GetData();
+		// Ranks are ascending, so each selection only needs to look at the tail left by the previous one
+		int32 PrevIndex = 0;
+		int32 P99Index = Num - 1;
+		for (int32 p = 0; p < PTPercentileNum; ++p)
+		{
+			const int32 Index = FMath::Clamp((int32)FMath::CeilToDouble(PTPercentileRanks[p] * (double)Num) - 1, PrevIndex, Num - 1);
+			std::nth_element(Data + PrevIndex, Data + Index, Data + Num);
+			Result.Values[p] = Data[Index];
+			PrevIndex = Index;
+			if (p == PTPercentileP99)
+			{
+				P99Index = Index;
+			}
+		}
+
+		// After selecting P99 (and P99.9 inside that tail), [P99Index, Num) holds exactly the slowest samples
+		double Sum = 0.0;
+		for (int32 i = P99Index; i < Num; ++i)
+		{
+			Sum += Data[i];
+		}
+		Result.WorstOnePercentMean = Sum / (double)(Num - P99Index);
+		return Result;
+	}
+
+	static FPTFramePercentiles ToFramePercentiles(const FPTPercentileResult (&PerCurve)[PTFrameCurveNum], bool bExact)
+	{
+		FPTFramePercentiles Out;
+		FSampledFrameData* Targets[PTPercentileNum] = { &Out.P50, &Out.P90, &Out.P95, &Out.P99, &Out.P999 };
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			for (int32 p = 0; p < PTPercentileNum; ++p)
+			{
+				Targets[p]->*PTFrameCurveMembers[c] = PerCurve[c].Values[p];
+			}
+		}
+		const double WorstFrameMs = PerCurve[0].WorstOnePercentMean;
+		Out.OnePercentLowFPS = WorstFrameMs > KINDA_SMALL_NUMBER ? (float)(1000.0 / WorstFrameMs) : 0.f;
+		Out.bExact = bExact;
+		return Out;
+	}
+
+	// Percentiles of every curve over Frames. Uses exact selection when small enough, otherwise Sketch
+	// (built on the fly when null).
+	static FPTFramePercentiles ComputeFramePercentiles(TConstArrayView<FSampledFrameData> Frames, const FPTFramePercentileSketch* Sketch = nullptr)
+	{
+		FPTPercentileResult PerCurve[PTFrameCurveNum];
+		if (Frames.Num() <= ExactSampleLimit)
+		{
+			TArray<float> Scratch;
+			Scratch.SetNumUninitialized(Frames.Num());
+			for (int32 c = 0; c < PTFrameCurveNum; ++c)
+			{
+				for (int32 i = 0; i < Frames.Num(); ++i)
+				{
+					Scratch[i] = Frames[i].*PTFrameCurveMembers[c];
+				}
+				PerCurve[c] = ComputeExact(Scratch);
+			}
+			return ToFramePercentiles(PerCurve, true);
+		}
+
+		if (Sketch)
+		{
+			return ComputeFromSketch(*Sketch);
+		}
+		FPTFramePercentileSketch LocalSketch;
+		for (const FSampledFrameData& S : Frames)
+		{
+			LocalSketch.Add(S);
+		}
+		return ComputeFromSketch(LocalSketch);
+	}
+
+	static FPTFramePercentiles ComputeFromSketch(const FPTFramePercentileSketch& Sketch)
+	{
+		FPTPercentileResult PerCurve[PTFrameCurveNum];
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			PerCurve[c] = Sketch.Curves[c].ComputePercentiles();
+		}
+		return ToFramePercentiles(PerCurve, false);
+	}
+
+	// Same over frames [Start, Start + Count) of a columnar capture, which may be memory-mapped and is never modified
+	static FPTFramePercentiles ComputeFramePercentiles(const FPTFrameColumns& Frames, int32 Start, int32 Count)
+	{
+		FPTPercentileResult PerCurve[PTFrameCurveNum];
+		const bool bExact = Count <= ExactSampleLimit;
+		TArray<float> Scratch;
+		for (int32 c = 0; c < PTFrameCurveNum; ++c)
+		{
+			const TConstArrayView<float> Column = Frames.GetCurve(c).Slice(Start, Count);
+			if (bExact)
+			{
+				Scratch.Reset();
+				Scratch.Append(Column.GetData(), Column.Num());
+				PerCurve[c] = ComputeExact(Scratch);
+			}
+			else
+			{
+				FPTLogHistogram Histogram;
+				for (const float V : Column)
+				{
+					Histogram.Add(V);
+				}
+				PerCurve[c] = Histogram.ComputePercentiles();
+			}
+		}
+		return ToFramePercentiles(PerCurve, bExact);
+	}
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/MpscQueue.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+#include "RenderTimer.h"
+
+// One thread's time for one game frame, pushed by the render or RHI thread
+struct FPTThreadFrameRecord
+{
+	enum ESource : uint8
+	{
+		RenderThread = 1 << 0,
+		RHIThread = 1 << 1,
+		All = RenderThread | RHIThread
+	};
+
+	uint64 FrameNumber = 0;
+	float TimeMs = 0.f;
+	ESource Source = RenderThread;
+};
+
+/**
+ * Frame-tagged render/RHI thread timings. GRenderThreadTime and GRHIThreadTime are written by those threads
+ * at the end of their own frame, so reading them on the game thread mixes frames whenever a thread runs behind.
+ * Instead a marker is sent down the pipeline for each game frame: the render command reads GRenderThreadTime
+ * after the previous frame's EndDrawing ran, the RHI lambda it enqueues reads GRHIThreadTime after that frame's
+ * RHI end of frame. Both push a record tagged with the game frame into a lock-free MPSC queue that the game
+ * thread drains, so the producers never take a lock.
+ */
+class FPTThreadTimingQueue
+{
+public:
+	// Game thread: request the render and RHI thread times of FrameNumber (the frame the game thread just ended)
+	void RequestFrame(uint64 FrameNumber)
+	{
+		TSharedRef<TMpscQueue<FPTThreadFrameRecord>> Target = Queue;
+		ENQUEUE_RENDER_COMMAND(PTToolThreadFrameMarker)([Target, FrameNumber](FRHICommandListImmediate& RHICmdList)
+		{
+			Target->Enqueue(FPTThreadFrameRecord{ FrameNumber, (float)FPlatformTime::ToMilliseconds(GRenderThreadTime), FPTThreadFrameRecord::RenderThread });
+			RHICmdList.EnqueueLambda([Target, FrameNumber](FRHICommandListImmediate&)
+			{
+				Target->Enqueue(FPTThreadFrameRecord{ FrameNumber, (float)FPlatformTime::ToMilliseconds(GRHIThreadTime), FPTThreadFrameRecord::RHIThread });
+			});
+		});
+	}
+
+	bool Dequeue(FPTThreadFrameRecord& OutRecord)
+	{
+		return Queue->Dequeue(OutRecord);
+	}
+
+	// A fresh queue; markers still in flight keep the old one alive and land there
+	void Reset()
+	{
+		Queue = MakeShared<TMpscQueue<FPTThreadFrameRecord>>();
+	}
+
+private:
+	TSharedRef<TMpscQueue<FPTThreadFrameRecord>> Queue = MakeShared<TMpscQueue<FPTThreadFrameRecord>>();
+};
@@ -1,8 +1,10 @@
 // PTToolSplineComponent.cpp
 
 #include "PTToolSplineComponent.h"
-#include "Components/StaticMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Engine/StaticMesh.h"
+#include "Components/LineBatchComponent.h"
+#include "PTSplineHeatmap.h"
 #include "Editor.h"
 
 UPTToolSplineComponent::UPTToolSplineComponent()
@@ -11,6 +13,23 @@ UPTToolSplineComponent::UPTToolSplineComponent()
 	PrimaryComponentTick.bCanEverTick = false;
 }
 
+namespace
+{
+	// 相机网格只加载一次，之后所有 spline 共用
+	UStaticMesh* GetEditorCameraMesh()
+	{
+		static TWeakObjectPtr<UStaticMesh> CameraMesh;
+		if (!CameraMesh.IsValid())
+		{
+			CameraMesh = LoadObject<UStaticMesh>(
+				nullptr,
+				TEXT("/Engine/EditorMeshes/MatineeCam_SM.MatineeCam_SM")
+			);
+		}
+		return CameraMesh.Get();
+	}
+}
+
 void UPTToolSplineComponent::UpdateEditorMeshes()
 {
 #if WITH_EDITOR
@@ -18,50 +37,108 @@ void UPTToolSplineComponent::UpdateEditorMeshes()
 	if (!World || World->WorldType != EWorldType::Editor)
 		return;
 
-	// 清除旧组件
-	for (UStaticMeshComponent* Mesh : EditorMeshes)
+	if (!EditorPointMeshes)
 	{
-		if (Mesh)
-		{
-			Mesh->DestroyComponent();
-		}
+		EditorPointMeshes = NewObject<UInstancedStaticMeshComponent>(GetOwner(), NAME_None, RF_Transient);
+		EditorPointMeshes->SetStaticMesh(GetEditorCameraMesh());
+		EditorPointMeshes->SetMobility(EComponentMobility::Movable);
+		EditorPointMeshes->SetHiddenInGame(true); // 仅编辑器可见
+		EditorPointMeshes->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		EditorPointMeshes->SetupAttachment(this);
+		EditorPointMeshes->RegisterComponentWithWorld(World);
 	}
-	EditorMeshes.Empty();
 
-	// 创建新的 mesh 可视化
+	// 增删实例到点数一致，再只更新变了的变换
 	const int32 NumPoints = GetNumberOfSplinePoints();
+	const int32 NumInstances = EditorPointMeshes->GetInstanceCount();
+	for (int32 i = NumInstances - 1; i >= NumPoints; --i)
+	{
+		EditorPointMeshes->RemoveInstance(i);
+	}
+
+	bool bDirty = false;
+	TArray<FTransform> NewInstances;
 	for (int32 i = 0; i < NumPoints; ++i)
 	{
-		UStaticMeshComponent* Mesh = NewObject<UStaticMeshComponent>(GetOwner());
-		Mesh->RegisterComponentWithWorld(World);
-		UStaticMesh* CameraMesh = LoadObject<UStaticMesh>(
-			nullptr,
-			TEXT("/Engine/EditorMeshes/MatineeCam_SM.MatineeCam_SM")
-		);
-		Mesh->SetStaticMesh(CameraMesh);
-		Mesh->SetMobility(EComponentMobility::Movable);
-		Mesh->SetVisibility(true);
-		Mesh->SetHiddenInGame(true); // 仅编辑器可见
-		Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		// 放置位置和旋转
-		const FVector Location = GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World);
-		const FRotator Rotation = GetRotationAtSplinePoint(i, ESplineCoordinateSpace::World);
-		Mesh->SetWorldLocation(Location);
-		Mesh->SetWorldRotation(Rotation);
-
-		// 附加到 spline 的 owner
-		Mesh->AttachToComponent(this, FAttachmentTransformRules::KeepWorldTransform);
-
-		EditorMeshes.Add(Mesh);
+		// 放置位置和旋转（spline 组件空间）
+		const FTransform Transform(
+			GetRotationAtSplinePoint(i, ESplineCoordinateSpace::Local),
+			GetLocationAtSplinePoint(i, ESplineCoordinateSpace::Local));
+		if (i >= NumInstances)
+		{
+			NewInstances.Add(Transform);
+			continue;
+		}
+
+		FTransform Current;
+		EditorPointMeshes->GetInstanceTransform(i, Current, false);
+		if (!Current.Equals(Transform))
+		{
+			EditorPointMeshes->UpdateInstanceTransform(i, Transform, false, false);
+			bDirty = true;
+		}
+	}
+	if (NewInstances.Num() > 0)
+	{
+		EditorPointMeshes->AddInstances(NewInstances, false);
+	}
+	if (bDirty)
+	{
+		EditorPointMeshes->MarkRenderStateDirty();
 	}
 #endif
 }
 
+#if WITH_EDITOR
+void UPTToolSplineComponent::ShowHeatmap(const FPTSplineHeatmap& Heatmap, float Thickness)
+{
+	UWorld* World = GetWorld();
+	if (!World || Heatmap.Num() == 0)
+		return;
+
+	if (!HeatmapLines)
+	{
+		HeatmapLines = NewObject<ULineBatchComponent>(GetOwner(), NAME_None, RF_Transient);
+		HeatmapLines->SetHiddenInGame(true);
+		HeatmapLines->RegisterComponentWithWorld(World);
+	}
+	HeatmapLines->Flush();
+
+	// 每个 bin 细分几段，让线贴合曲线
+	constexpr int32 SegmentsPerBin = 4;
+	const float Step = Heatmap.BinLength / SegmentsPerBin;
+	TArray<FBatchedLine> Lines;
+	Lines.Reserve(Heatmap.Num() * SegmentsPerBin);
+	for (int32 Bin = 0; Bin < Heatmap.Num(); ++Bin)
+	{
+		const FLinearColor Color = Heatmap.GetBinColor(Bin);
+		for (int32 s = 0; s < SegmentsPerBin; ++s)
+		{
+			const float D0 = (Bin * SegmentsPerBin + s) * Step;
+			const FVector Start = GetLocationAtDistanceAlongSpline(D0, ESplineCoordinateSpace::World);
+			const FVector End = GetLocationAtDistanceAlongSpline(D0 + Step, ESplineCoordinateSpace::World);
+			Lines.Emplace(Start, End, Color, 0.f, Thickness, SDPG_World);
+		}
+	}
+	HeatmapLines->DrawLines(Lines);
+}
+
+void UPTToolSplineComponent::ClearHeatmap()
+{
+	if (HeatmapLines)
+	{
+		HeatmapLines->DestroyComponent();
+		HeatmapLines = nullptr;
+	}
+}
+#endif
+
 void UPTToolSplineComponent::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
 	UpdateEditorMeshes();
+	// 路径变了，旧热力图不再对应
+	ClearHeatmap();
 }
 
 
@@ -69,6 +146,28 @@ void UPTToolSplineComponent::OnRegister()
 {
 	Super::OnRegister();
 
+#if WITH_EDITOR
+	// 重新注册（改属性、撤销、移动 actor）时复用已有的实例化组件，实例只做差量更新
+	if (EditorPointMeshes && !IsValid(EditorPointMeshes))
+	{
+		EditorPointMeshes = nullptr;
+	}
+	if (EditorPointMeshes)
+	{
+		if (EditorPointMeshes->GetAttachParent() != this)
+		{
+			EditorPointMeshes->AttachToComponent(this, FAttachmentTransformRules::KeepRelativeTransform);
+		}
+		if (!EditorPointMeshes->IsRegistered())
+		{
+			if (UWorld* World = GetWorld())
+			{
+				EditorPointMeshes->RegisterComponentWithWorld(World);
+			}
+		}
+	}
+#endif
+
 	// 仅编辑器中创建辅助网格体
 	UpdateEditorMeshes();
 }
@@ -76,15 +175,21 @@ void UPTToolSplineComponent::OnRegister()
 void UPTToolSplineComponent::OnUnregister()
 {
 #if WITH_EDITOR
-	for (UStaticMeshComponent* Mesh : EditorMeshes)
+	ClearHeatmap();
+#endif
+
+	Super::OnUnregister();
+}
+
+void UPTToolSplineComponent::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+#if WITH_EDITOR
+	if (EditorPointMeshes)
 	{
-		if (Mesh)
-		{
-			Mesh->DestroyComponent();
-		}
+		EditorPointMeshes->DestroyComponent();
+		EditorPointMeshes = nullptr;
 	}
-	EditorMeshes.Empty();
 #endif
 
-	Super::OnUnregister();
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
 }
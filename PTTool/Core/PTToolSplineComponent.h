@@ -6,6 +6,9 @@
 #include "Components/SplineComponent.h"
 #include "PTToolSplineComponent.generated.h"
 
+class ULineBatchComponent;
+class UInstancedStaticMeshComponent;
+struct FPTSplineHeatmap;
 
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
@@ -18,17 +21,30 @@ public:
 
 	virtual USplineMetadata* GetSplinePointsMetadata() override { return nullptr; } 
 
+	// 辅助网格体跟随 spline 组件的生命周期，而不是每次注册/反注册
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
+
 
 #if WITH_EDITOR
 	virtual void OnRegister() override;
 	virtual void OnUnregister() override;
+	// 每个样条点一个相机网格实例；实例数和变换按差量更新
 	void UpdateEditorMeshes();
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	// 编辑器视口中按热力图颜色重绘 spline（一个 line batch，不按点创建组件）
+	void ShowHeatmap(const FPTSplineHeatmap& Heatmap, float Thickness = 12.f);
+	void ClearHeatmap();
+	bool HasHeatmap() const { return HeatmapLines != nullptr; }
 #endif
 
 private:
-	UPROPERTY()
-	TArray<UStaticMeshComponent*> EditorMeshes;
+	// 所有样条点共用一个实例化组件（组件空间变换，移动 actor 不需要更新）
+	UPROPERTY(Transient)
+	UInstancedStaticMeshComponent* EditorPointMeshes = nullptr;
+
+	UPROPERTY(Transient)
+	ULineBatchComponent* HeatmapLines = nullptr;
 
 	
 };
\ No newline at end of file
@@ -1,27 +1,339 @@
 #include "PerformanceGraph.h"
 #include "Rendering/DrawElements.h"
 #include "PTPerformanceSampler.h"
+#include "Algo/BinarySearch.h"
+#include "PTCaptureComparison.h"
+#include "PTColumnKernels.h"
 
-static float GetCurveValue(const FSampledFrameData& S, EPerfCurve Curve)
+void FPerfCurveLOD::Build(TConstArrayView<float> InSamples, TConstArrayView<float> InMin, TConstArrayView<float> InMax)
 {
-	switch (Curve)
-	{
-	case EPerfCurve::Frame:
-		return S.FrameMS;
-	case EPerfCurve::Game:
-		return S.GameMS;
-	case EPerfCurve::Draw:
-		return S.DrawMS;
-	case EPerfCurve::RHI:
-		return S.RHITMS;
-	case EPerfCurve::GPU:
-		return S.GPUMS;
+	Samples = InSamples;
+	SampleMin = InMin;
+	SampleMax = InMax;
+	Levels.Reset();
+
+	const int32 NumSamples = Samples.Num();
+	if (NumSamples <= BaseBucketSize)
+	{
+		return;
+	}
+
+	// Level 0 reduces raw samples (bucket bounds when present, so bucketed spikes survive too)
+	{
+		FLevel& Level = Levels.AddDefaulted_GetRef();
+		Level.SamplesPerBucket = BaseBucketSize;
+		const int32 NumBuckets = (NumSamples + BaseBucketSize - 1) / BaseBucketSize;
+		Level.Min.SetNumUninitialized(NumBuckets);
+		Level.Max.SetNumUninitialized(NumBuckets);
+		Level.Mean.SetNumUninitialized(NumBuckets);
+
+		for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+		{
+			const int32 Start = Bucket * BaseBucketSize;
+			const int32 End = FMath::Min(Start + BaseBucketSize, NumSamples);
+			float Min = GetSampleMin(Start);
+			float Max = GetSampleMax(Start);
+			double Sum = 0.0;
+			for (int32 i = Start; i < End; ++i)
+			{
+				Min = FMath::Min(Min, GetSampleMin(i));
+				Max = FMath::Max(Max, GetSampleMax(i));
+				Sum += Samples[i];
+			}
+			Level.Min[Bucket] = Min;
+			Level.Max[Bucket] = Max;
+			Level.Mean[Bucket] = (float)(Sum / (End - Start));
+		}
+	}
+
+	// Higher levels merge LevelFactor buckets of the previous level, mean weighted by sample count
+	while (Levels.Last().Min.Num() > 1)
+	{
+		const int32 ChildSize = Levels.Last().SamplesPerBucket;
+		const int32 NumChildren = Levels.Last().Min.Num();
+		const int32 NumBuckets = (NumChildren + LevelFactor - 1) / LevelFactor;
+
+		FLevel Level;
+		Level.SamplesPerBucket = ChildSize * LevelFactor;
+		Level.Min.SetNumUninitialized(NumBuckets);
+		Level.Max.SetNumUninitialized(NumBuckets);
+		Level.Mean.SetNumUninitialized(NumBuckets);
+
+		const FLevel& Child = Levels.Last();
+		for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+		{
+			const int32 Start = Bucket * LevelFactor;
+			const int32 End = FMath::Min(Start + LevelFactor, NumChildren);
+			float Min = Child.Min[Start];
+			float Max = Child.Max[Start];
+			double Sum = 0.0;
+			int32 Count = 0;
+			for (int32 c = Start; c < End; ++c)
+			{
+				const int32 ChildCount = FMath::Min(ChildSize, NumSamples - c * ChildSize);
+				Min = FMath::Min(Min, Child.Min[c]);
+				Max = FMath::Max(Max, Child.Max[c]);
+				Sum += (double)Child.Mean[c] * ChildCount;
+				Count += ChildCount;
+			}
+			Level.Min[Bucket] = Min;
+			Level.Max[Bucket] = Max;
+			Level.Mean[Bucket] = Count > 0 ? (float)(Sum / Count) : 0.f;
+		}
+		Levels.Add(MoveTemp(Level));
+	}
+}
+
+const FPerfCurveLOD::FLevel* FPerfCurveLOD::FindLevel(int32 VisibleSamples, int32 MinBuckets) const
+{
+	const FLevel* Best = nullptr;
+	for (const FLevel& Level : Levels)
+	{
+		if (VisibleSamples / Level.SamplesPerBucket < MinBuckets)
+		{
+			break;
+		}
+		Best = &Level;
+	}
+	return Best;
+}
+
+double SPerformanceGraph::GetSampleDuration(int32 Index) const
+{
+	if (XAxis == EPerfGraphXAxis::Distance && CanShowDistance())
+	{
+		return SampleDistances[Index + 1] - SampleDistances[Index];
+	}
+	switch (SamplingMode)
+	{
+	case EPTSamplingMode::Decimated:
+		return SampleIntervalMs;
+	case EPTSamplingMode::Bucketed:
+		return (double)GetCurveSample(EPerfCurve::Frame, Index) * BucketFrameCounts[Index];
 	default:
-		return 0.f;
+		return GetCurveSample(EPerfCurve::Frame, Index);
+	}
+}
+
+void SPerformanceGraph::SetFrameData(const FPTFrameColumns& InData, const FSampledGraphData* InSource)
+{
+	SampledFrameData = InData;   // 拷贝列数据；映射文件只拷贝视图
+
+	SamplingMode = EPTSamplingMode::EveryFrame;
+	SampleIntervalMs = 0.f;
+	BucketMin.Reset();
+	BucketMax.Reset();
+	BucketFrameCounts.Reset();
+	HitchEvents.Reset();
+	HitchEpisodes.Reset();
+	SampleDistances.Reset();
+	const FString SecondarySeriesName = GetSecondarySeriesName(SecondarySeries);
+	MemoryColumns.Reset();
+	MetricColumns.Reset();
+	MetricUnits.Reset();
+	if (InSource && InSource->FrameData.Num() == InData.Num() && InSource->HasMemoryData())
+	{
+		MemoryColumns = InSource->MemoryColumns;
+	}
+	if (InSource && InSource->FrameData.Num() == InData.Num() && InSource->HasMetricData())
+	{
+		MetricColumns = InSource->MetricColumns;
+		MetricUnits = InSource->MetricUnits;
+	}
+	if (InSource && InSource->FrameData.Num() == InData.Num())
+	{
+		HitchEvents = InSource->Hitches.Events;
+		HitchEpisodes = InSource->Hitches.Episodes;
+		if (InSource->HasPathData())
+		{
+			InSource->PathData.ComputeTravelledDistance(SampleDistances);
+		}
+	}
+	if (InSource && InSource->FrameData.Num() == InData.Num() && InSource->SamplingInterval > 0.f)
+	{
+		if (InSource->IsBucketed())
+		{
+			SamplingMode = EPTSamplingMode::Bucketed;
+			BucketMin = InSource->BucketMin;
+			BucketMax = InSource->BucketMax;
+			BucketFrameCounts = InSource->BucketFrameCounts;
+		}
+		else if (InSource->SamplingMode != EPTSamplingMode::EveryFrame)
+		{
+			SamplingMode = EPTSamplingMode::Decimated;
+		}
+		SampleIntervalMs = InSource->SamplingInterval * 1000.f;
+	}
+	ViewStart = 0;
+	// Default to a reasonable initial window so panning works immediately.
+	// If there are few samples, show all; otherwise show the most recent 200 samples.
+	const int32 Num = SampledFrameData.Num();
+	ViewCount = FMath::Min(Num, 1000000000);
+
+	// Build the decimation pyramids once over the columns, so paint cost no longer depends on Num
+	const bool bBucketed = SamplingMode == EPTSamplingMode::Bucketed;
+	for (int32 CurveIndex = 0; CurveIndex < PerfCurveCount; ++CurveIndex)
+	{
+		CurveLODs[CurveIndex].Build(SampledFrameData.GetCurve(CurveIndex),
+			bBucketed ? BucketMin.GetCurve(CurveIndex) : TConstArrayView<float>(),
+			bBucketed ? BucketMax.GetCurve(CurveIndex) : TConstArrayView<float>());
+	}
+
+	RebuildSampleTimes();
+	int32 KeptSeries = INDEX_NONE;
+	for (int32 Series = 0; Series < NumSecondarySeries() && !SecondarySeriesName.IsEmpty(); ++Series)
+	{
+		if (GetSecondarySeriesName(Series) == SecondarySeriesName)
+		{
+			KeptSeries = Series;
+			break;
+		}
+	}
+	SetSecondarySeries(KeptSeries);
+
+	// Our time axis changed, so did the path position of every sample
+	if (BaselineFractions.Num() > 0)
+	{
+		RebuildBaselineMap();
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("SampledFrameData: %d samples, %d LOD levels%s%s"), Num, CurveLODs[0].Levels.Num(),
+		SampledFrameData.IsMapped() ? TEXT(" (mapped)") : TEXT(""), bBucketed ? TEXT(" (bucketed)") : TEXT(""));
+	Invalidate(EInvalidateWidget::Paint);
+}
+
+void SPerformanceGraph::RebuildSampleTimes()
+{
+	// Compute cumulative X for each sample. time[0] = 0, time[i] = sum_{j=0..i-1} duration(j)
+	const int32 Num = SampledFrameData.Num();
+	SampleTimes.Reset();
+	SampleTimes.Reserve(Num);
+	double Cum = 0.0;
+	for (int32 i = 0; i < Num; ++i)
+	{
+		SampleTimes.Add(Cum);
+		Cum += GetSampleDuration(i);
+	}
+}
+
+void SPerformanceGraph::SetSecondarySeries(int32 InSeries)
+{
+	SecondarySeries = InSeries >= 0 && InSeries < NumSecondarySeries() ? InSeries : INDEX_NONE;
+	SecondaryLOD.Build(GetSecondaryColumn(SecondarySeries));
+	Invalidate(EInvalidateWidget::Paint);
+}
+
+FString SPerformanceGraph::GetSecondarySeriesName(int32 Series) const
+{
+	if (MemoryColumns.ThreadNames.IsValidIndex(Series))
+	{
+		return MemoryColumns.ThreadNames[Series];
+	}
+	const int32 Metric = Series - MemoryColumns.NumThreads();
+	return Series >= 0 && MetricColumns.ThreadNames.IsValidIndex(Metric) ? MetricColumns.ThreadNames[Metric] : FString();
+}
+
+FString SPerformanceGraph::GetSecondarySeriesUnit(int32 Series) const
+{
+	if (MemoryColumns.ThreadNames.IsValidIndex(Series))
+	{
+		return TEXT("MB");
+	}
+	const int32 Metric = Series - MemoryColumns.NumThreads();
+	return Series >= 0 && MetricUnits.IsValidIndex(Metric) ? MetricUnits[Metric] : FString();
+}
+
+TConstArrayView<float> SPerformanceGraph::GetSecondaryColumn(int32 Series) const
+{
+	if (Series < 0)
+	{
+		return TConstArrayView<float>();
+	}
+	if (Series < MemoryColumns.NumThreads())
+	{
+		return MemoryColumns.GetColumn(Series);
+	}
+	const int32 Metric = Series - MemoryColumns.NumThreads();
+	return Metric < MetricColumns.NumThreads() ? MetricColumns.GetColumn(Metric) : TConstArrayView<float>();
+}
+
+void SPerformanceGraph::SetXAxis(EPerfGraphXAxis InAxis)
+{
+	if (XAxis == InAxis)
+	{
+		return;
+	}
+	XAxis = InAxis;
+	RebuildSampleTimes();
+	Invalidate(EInvalidateWidget::Paint);
+}
+
+void SPerformanceGraph::SetBaseline(const FSampledGraphData* InBaseline)
+{
+	BaselineFractions.Reset();
+	BaselineIndexMap.Reset();
+	for (TArray<double>& Prefix : BaselinePrefix)
+	{
+		Prefix.Reset();
+	}
+
+	if (InBaseline && InBaseline->FrameData.Num() > 0)
+	{
+		FPTCaptureComparison::ComputePathFractions(*InBaseline, BaselineFractions);
+		for (int32 CurveIndex = 0; CurveIndex < PerfCurveCount; ++CurveIndex)
+		{
+			const TConstArrayView<float> Column = InBaseline->FrameData.GetCurve(CurveIndex);
+			TArray<double>& Prefix = BaselinePrefix[CurveIndex];
+			Prefix.SetNumUninitialized(Column.Num() + 1);
+			Prefix[0] = 0.0;
+			for (int32 i = 0; i < Column.Num(); ++i)
+			{
+				Prefix[i + 1] = Prefix[i] + Column[i];
+			}
+		}
+		RebuildBaselineMap();
 	}
+	Invalidate(EInvalidateWidget::Paint);
 }
 
+void SPerformanceGraph::RebuildBaselineMap()
+{
+	const int32 Num = SampledFrameData.Num();
+	const int32 NumBaseline = BaselineFractions.Num() - 1;
+	BaselineIndexMap.Reset();
+	if (Num == 0 || NumBaseline <= 0 || SampleTimes.Num() != Num)
+	{
+		return;
+	}
 
+	// Path position by travelled distance when recorded (same as ComputePathFractions), else by time
+	const bool bByDistance = CanShowDistance();
+	const double Total = bByDistance ? SampleDistances[Num] : SampleTimes.Last() + GetSampleDuration(Num - 1);
+	const double InvTotal = Total > 0.0 ? 1.0 / Total : 0.0;
+	BaselineIndexMap.SetNumUninitialized(Num + 1);
+
+	// Both sides are monotonic in path position, so one merge walk
+	int32 j = 0;
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const float Fraction = (float)((bByDistance ? SampleDistances[i] : SampleTimes[i]) * InvTotal);
+		while (j + 1 < NumBaseline && BaselineFractions[j + 1] <= Fraction)
+		{
+			++j;
+		}
+		BaselineIndexMap[i] = j;
+	}
+	BaselineIndexMap[Num] = NumBaseline;
+}
+
+float SPerformanceGraph::GetBaselineMean(EPerfCurve Curve, int32 First, int32 Last) const
+{
+	const TArray<double>& Prefix = BaselinePrefix[(uint8)Curve];
+	const int32 NumBaseline = Prefix.Num() - 1;
+	const int32 B0 = FMath::Clamp(BaselineIndexMap[First], 0, NumBaseline - 1);
+	const int32 B1 = FMath::Clamp(BaselineIndexMap[Last + 1] - 1, B0, NumBaseline - 1);
+	return (float)((Prefix[B1 + 1] - Prefix[B0]) / (B1 - B0 + 1));
+}
 
 int32 SPerformanceGraph::OnPaint(const FPaintArgs& Args,const FGeometry& Geo,const FSlateRect&,FSlateWindowElementList& Out,int32 Layer,const FWidgetStyle&,bool) const
 {
@@ -77,7 +389,7 @@ int32 SPerformanceGraph::OnPaint(const FPaintArgs& Args,const FGeometry& Geo,con
 	{
 		TimeStart = SampleTimes[StartIndex];
 		// End is start time of last visible sample plus its frame duration
-		TimeEnd = SampleTimes[EndIndex] + SampledFrameData[EndIndex].FrameMS;
+		TimeEnd = SampleTimes[EndIndex] + GetSampleDuration(EndIndex);
 	}
 	else
 	{
@@ -88,17 +400,34 @@ int32 SPerformanceGraph::OnPaint(const FPaintArgs& Args,const FGeometry& Geo,con
 	const double TimeRange = FMath::Max(1e-6, TimeEnd - TimeStart);
 
 	// ================== 计算 Y 轴最小/最大值（仅在可见区间内） ==================
+	// Sample count above which curves are drawn as a per-pixel min/max envelope instead of raw points
+	const int32 PlotColumns = FMath::Max(1, FMath::FloorToInt(PlotR - PlotL));
+	const bool bUseEnvelope = VisibleCount > PlotColumns * 2;
+
 	float MaxMs = -FLT_MAX;
 	float MinMs = FLT_MAX;
 
-	for (int32 i = StartIndex; i <= EndIndex; ++i)
+	for (EPerfCurve C : VisibleCurves)
 	{
-		const auto& S = SampledFrameData[i];
-		for (EPerfCurve C : VisibleCurves)
+		const FPerfCurveLOD& LOD = CurveLODs[(uint8)C];
+		if (LOD.Samples.Num() != NumSamples)
+		{
+			continue;
+		}
+		const FPerfCurveLOD::FLevel* Level = bUseEnvelope ? LOD.FindLevel(VisibleCount, PlotColumns) : nullptr;
+		if (Level)
+		{
+			// Bucket min/max bound the raw values, so the range still includes every spike
+			const int32 FirstBucket = StartIndex / Level->SamplesPerBucket;
+			const int32 NumBuckets = EndIndex / Level->SamplesPerBucket - FirstBucket + 1;
+			MaxMs = FMath::Max(MaxMs, FPTColumnKernels::MinMax(TConstArrayView<float>(Level->Max).Slice(FirstBucket, NumBuckets)).Max);
+			MinMs = FMath::Min(MinMs, FPTColumnKernels::MinMax(TConstArrayView<float>(Level->Min).Slice(FirstBucket, NumBuckets)).Min);
+		}
+		else
 		{
-			float V = GetCurveValue(S, C);
-			MaxMs = FMath::Max(MaxMs, V);
-			MinMs = FMath::Min(MinMs, V);
+			const int32 Count = EndIndex - StartIndex + 1;
+			MaxMs = FMath::Max(MaxMs, FPTColumnKernels::MinMax((LOD.HasSampleBounds() ? LOD.SampleMax : LOD.Samples).Slice(StartIndex, Count)).Max);
+			MinMs = FMath::Min(MinMs, FPTColumnKernels::MinMax((LOD.HasSampleBounds() ? LOD.SampleMin : LOD.Samples).Slice(StartIndex, Count)).Min);
 		}
 	}
 
@@ -231,10 +560,14 @@ int32 SPerformanceGraph::OnPaint(const FPaintArgs& Args,const FGeometry& Geo,con
 				1.0f
 			);
 
-			// 时间标签：TimeStart + Alpha * TimeRange
+			// 时间标签：TimeStart + Alpha * TimeRange（距离轴时为 cm）
 			const double TimeMs = TimeStart + Alpha * TimeRange;
 			FString TimeLabel;
-			if (TimeMs >= 1000.0)
+			if (XAxis == EPerfGraphXAxis::Distance && CanShowDistance())
+			{
+				TimeLabel = FString::Printf(TEXT("%.1fm"), TimeMs / 100.0);
+			}
+			else if (TimeMs >= 1000.0)
 			{
 				TimeLabel = FString::Printf(TEXT("%.2fs"), TimeMs / 1000.0);
 			}
@@ -262,60 +595,290 @@ int32 SPerformanceGraph::OnPaint(const FPaintArgs& Args,const FGeometry& Geo,con
 	// ====================================================
 	// 4️⃣ 曲线绘制（严格限制在 Plot 区域），使用 MinMs..MaxMs 映射 Y
 	// ====================================================
-	for (EPerfCurve Curve : VisibleCurves)
+	const float PlotH = PlotB - PlotT;
+	const float ValueRange = FMath::Max(1e-6f, MaxMs - MinMs);
+	auto ValueToY = [&](float V) -> float
 	{
-		TArray<FVector2D> Points;
-		Points.Reserve(VisibleCount);
-
-		float SmoothRadiusSamples = TargetSmoothPx	 / FMath::Max(1.0f, (float)VisibleCount / (PlotR - PlotL));
-		int32 SmoothRadius = FMath::Max(0, FMath::RoundToInt(SmoothRadiusSamples));
+		return PlotB - ((V - MinMs) / ValueRange) * PlotH;
+	};
+	auto IndexToPlotX = [&](int32 Idx) -> float
+	{
+		const double SampleTime = SampleTimes.IsValidIndex(Idx) ? SampleTimes[Idx] : TimeStart;
+		return PlotL + (float)((SampleTime - TimeStart) / TimeRange) * (PlotR - PlotL);
+	};
 
-		for (int32 i = 0; i < VisibleCount; ++i)
+	for (EPerfCurve Curve : VisibleCurves)
+	{
+		const FPerfCurveLOD& LOD = CurveLODs[(uint8)Curve];
+		if (LOD.Samples.Num() != NumSamples)
 		{
-			int32 GlobalIndex = StartIndex + i;
-			float Acc = 0.0f;
-			int32 Count = 0;
+			continue;
+		}
+		const FLinearColor Color = GetCurveColor(Curve);
 
-			for (int32 k = -SmoothRadius; k <= SmoothRadius; ++k)
+		// Baseline first so our curve stays on top: one point per sample, or per pixel column when zoomed out
+		if (HasBaseline())
+		{
+			BaselineScratch.Reset();
+			auto AddBaselinePoint = [&](float X, int32 First, int32 Last)
+			{
+				const float Y = FMath::Clamp(ValueToY(GetBaselineMean(Curve, First, Last)), PlotT, PlotB);
+				BaselineScratch.Add(FVector2D(X, Y));
+			};
+			if (!bUseEnvelope || SampleTimes.Num() != NumSamples)
+			{
+				for (int32 i = StartIndex; i <= EndIndex; ++i)
+				{
+					AddBaselinePoint(IndexToPlotX(i), i, i);
+				}
+			}
+			else
 			{
-				const int32 Index = GlobalIndex + k;
-				if (Index >= StartIndex && Index <= EndIndex)
+				int32 First = StartIndex;
+				for (int32 Col = 0; Col < PlotColumns && First <= EndIndex; ++Col)
 				{
-					Acc += GetCurveValue(SampledFrameData[Index], Curve);
-					++Count;
+					const double ColEndTime = TimeStart + (double)(Col + 1) / PlotColumns * TimeRange;
+					const int32 Last = FMath::Clamp(Algo::LowerBound(SampleTimes, ColEndTime) - 1, First, EndIndex);
+					AddBaselinePoint(PlotL + Col + 0.5f, First, Last);
+					First = Last + 1;
 				}
 			}
+			FSlateDrawElement::MakeLines(Out, Layer, Geo.ToPaintGeometry(), BaselineScratch, ESlateDrawEffect::None, Color.CopyWithNewOpacity(0.45f), true, 1.0f);
+		}
 
-			const float V = (Count > 0) ? (Acc / Count) : 0.0f;
+		PointScratch.Reset();
 
-			// X position based on time
-			double SampleTime = TimeStart;
-			if (SampleTimes.Num() == NumSamples)
+		if (!bUseEnvelope)
+		{
+			// Few enough samples: draw every sample
+			for (int32 i = StartIndex; i <= EndIndex; ++i)
 			{
-				SampleTime = SampleTimes[GlobalIndex];
+				PointScratch.Add(FVector2D(IndexToPlotX(i), ValueToY(LOD.Samples[i])));
 			}
-			const float AlphaX = (float)((SampleTime - TimeStart) / TimeRange);
-			const float X = PlotL + AlphaX * (PlotR - PlotL);
 
-			const float AlphaY = V / MaxMs;
+			// Bucket means hide the frames inside each bucket; draw the min/max band behind them
+			if (LOD.HasSampleBounds())
+			{
+				EnvelopeScratch.Reset();
+				bool bMinFirst = true;
+				for (int32 i = StartIndex; i <= EndIndex; ++i)
+				{
+					const float X = IndexToPlotX(i);
+					const float YMin = ValueToY(LOD.SampleMin[i]);
+					const float YMax = ValueToY(LOD.SampleMax[i]);
+					EnvelopeScratch.Add(FVector2D(X, bMinFirst ? YMin : YMax));
+					EnvelopeScratch.Add(FVector2D(X, bMinFirst ? YMax : YMin));
+					bMinFirst = !bMinFirst;
+				}
+				FSlateDrawElement::MakeLines(Out, Layer, Geo.ToPaintGeometry(), EnvelopeScratch, ESlateDrawEffect::None, Color.CopyWithNewOpacity(0.35f), true, 1.0f);
+			}
+		}
+		else
+		{
+			// Reduce to one min/max/mean column per horizontal pixel, from the coarsest pyramid level
+			// that still has at least one bucket per pixel. Cost is O(PlotColumns) regardless of capture length.
+			ColumnMin.Init(FLT_MAX, PlotColumns);
+			ColumnMax.Init(-FLT_MAX, PlotColumns);
+			ColumnSum.Init(0.0, PlotColumns);
+			ColumnCount.Init(0, PlotColumns);
+
+			auto AddToColumn = [&](int32 SampleIndex, float Min, float Max, float Mean, int32 Count)
+			{
+				const int32 Col = FMath::Clamp(FMath::FloorToInt(IndexToPlotX(SampleIndex) - PlotL), 0, PlotColumns - 1);
+				ColumnMin[Col] = FMath::Min(ColumnMin[Col], Min);
+				ColumnMax[Col] = FMath::Max(ColumnMax[Col], Max);
+				ColumnSum[Col] += (double)Mean * Count;
+				ColumnCount[Col] += Count;
+			};
+
+			if (const FPerfCurveLOD::FLevel* Level = LOD.FindLevel(VisibleCount, PlotColumns))
+			{
+				const int32 BucketSize = Level->SamplesPerBucket;
+				const int32 FirstBucket = StartIndex / BucketSize;
+				const int32 LastBucket = EndIndex / BucketSize;
+				for (int32 b = FirstBucket; b <= LastBucket; ++b)
+				{
+					const int32 BucketStart = FMath::Max(b * BucketSize, StartIndex);
+					const int32 BucketCount = FMath::Min((b + 1) * BucketSize - 1, EndIndex) - BucketStart + 1;
+					AddToColumn(BucketStart, Level->Min[b], Level->Max[b], Level->Mean[b], BucketCount);
+				}
+			}
+			else
+			{
+				for (int32 i = StartIndex; i <= EndIndex; ++i)
+				{
+					AddToColumn(i, LOD.GetSampleMin(i), LOD.GetSampleMax(i), LOD.Samples[i], 1);
+				}
+			}
 
-			const float Y = PlotB - AlphaY * (PlotB - PlotT);
+			// Envelope as a zig-zag polyline (2 points per column) so spikes stay visible, plus the mean line on top
+			EnvelopeScratch.Reset();
+			bool bMinFirst = true;
+			for (int32 Col = 0; Col < PlotColumns; ++Col)
+			{
+				if (ColumnCount[Col] == 0)
+				{
+					continue;
+				}
+				const float X = PlotL + Col + 0.5f;
+				const float YMin = ValueToY(ColumnMin[Col]);
+				const float YMax = ValueToY(ColumnMax[Col]);
+				EnvelopeScratch.Add(FVector2D(X, bMinFirst ? YMin : YMax));
+				EnvelopeScratch.Add(FVector2D(X, bMinFirst ? YMax : YMin));
+				bMinFirst = !bMinFirst;
+
+				PointScratch.Add(FVector2D(X, ValueToY((float)(ColumnSum[Col] / ColumnCount[Col]))));
+			}
 
-			Points.Add(FVector2D(X, Y));
+			FSlateDrawElement::MakeLines(
+				Out,
+				Layer,
+				Geo.ToPaintGeometry(),
+				EnvelopeScratch,
+				ESlateDrawEffect::None,
+				Color.CopyWithNewOpacity(0.35f),
+				true,
+				1.0f
+			);
 		}
 
 		FSlateDrawElement::MakeLines(
 			Out,
 			Layer,
 			Geo.ToPaintGeometry(),
-			Points,
+			PointScratch,
 			ESlateDrawEffect::None,
-			GetCurveColor(Curve),
+			Color,
 			true,
 			1.5f
 		);
 	}
 
+	// ====================================================
+	// 4.3 Secondary series (memory MB or a provider metric) on its own axis at the right edge
+	// ====================================================
+	if (HasSecondarySeries())
+	{
+		const bool bMemorySeries = SecondarySeries < MemoryColumns.NumThreads();
+		const FLinearColor SeriesColor = bMemorySeries ? FLinearColor(0.75f, 0.45f, 1.0f) : FLinearColor(0.3f, 0.85f, 0.85f);
+		const FString Unit = GetSecondarySeriesUnit(SecondarySeries);
+		const FPerfCurveLOD::FLevel* Level = bUseEnvelope ? SecondaryLOD.FindLevel(VisibleCount, PlotColumns) : nullptr;
+
+		float MinValue = FLT_MAX;
+		float MaxValue = -FLT_MAX;
+		if (Level)
+		{
+			for (int32 b = StartIndex / Level->SamplesPerBucket; b <= EndIndex / Level->SamplesPerBucket; ++b)
+			{
+				MinValue = FMath::Min(MinValue, Level->Min[b]);
+				MaxValue = FMath::Max(MaxValue, Level->Max[b]);
+			}
+		}
+		else
+		{
+			const FPTColumnRange Range = FPTColumnKernels::MinMax(SecondaryLOD.Samples.Slice(StartIndex, EndIndex - StartIndex + 1));
+			MinValue = Range.Min;
+			MaxValue = Range.Max;
+		}
+		// A flat series still gets a readable band; otherwise 5% padding like the ms axis
+		const float Pad = FMath::Max((MaxValue - MinValue) * 0.05f, 1.0f);
+		MinValue = MinValue >= 0.f ? FMath::Max(0.f, MinValue - Pad) : MinValue - Pad;
+		MaxValue += Pad;
+		auto ValueToY = [&](float V) -> float
+		{
+			return PlotB - ((V - MinValue) / (MaxValue - MinValue)) * PlotH;
+		};
+
+		// Zoomed out: bucket peaks, so a short allocation (or draw call) spike is not averaged away
+		PointScratch.Reset();
+		if (Level)
+		{
+			for (int32 b = StartIndex / Level->SamplesPerBucket; b <= EndIndex / Level->SamplesPerBucket; ++b)
+			{
+				const int32 BucketStart = FMath::Max(b * Level->SamplesPerBucket, StartIndex);
+				PointScratch.Add(FVector2D(IndexToPlotX(BucketStart), ValueToY(Level->Max[b])));
+			}
+		}
+		else
+		{
+			for (int32 i = StartIndex; i <= EndIndex; ++i)
+			{
+				PointScratch.Add(FVector2D(IndexToPlotX(i), ValueToY(SecondaryLOD.Samples[i])));
+			}
+		}
+		FSlateDrawElement::MakeLines(Out, Layer, Geo.ToPaintGeometry(), PointScratch, ESlateDrawEffect::None, SeriesColor, true, 1.5f);
+
+		TArray<FVector2D> Axis;
+		Axis.Add(FVector2D(PlotR, PlotT));
+		Axis.Add(FVector2D(PlotR, PlotB));
+		FSlateDrawElement::MakeLines(Out, Layer, Geo.ToPaintGeometry(), Axis, ESlateDrawEffect::None, SeriesColor.CopyWithNewOpacity(0.6f), true, 1.0f);
+
+		// Small ranges (a handful of agents) need decimals to tell the ticks apart
+		const TCHAR* TickFormat = MaxValue - MinValue < 10.f ? TEXT("%.2f %s") : TEXT("%.0f %s");
+		const int32 NumTicks = 5;
+		for (int32 i = 0; i <= NumTicks; ++i)
+		{
+			const float Alpha = (float)i / NumTicks;
+			const float Y = FMath::Lerp(PlotB, PlotT, Alpha);
+			FSlateDrawElement::MakeText(
+				Out,
+				Layer,
+				Geo.ToPaintGeometry(FVector2D(PlotR + 3.f, Y - 6.f), FVector2D(1.f, 1.f)),
+				FString::Printf(TickFormat, FMath::Lerp(MinValue, MaxValue, Alpha), *Unit),
+				Font,
+				ESlateDrawEffect::None,
+				SeriesColor
+			);
+		}
+		Layer++;
+	}
+
+	// ====================================================
+	// 4.4 Hitch markers: episode bands, one tick per spike frame on top
+	// ====================================================
+	if (HitchEpisodes.Num() > 0 || HitchEvents.Num() > 0)
+	{
+		const FLinearColor HitchColor(1.0f, 0.25f, 0.1f);
+
+		for (const FPTHitchEpisode& Episode : HitchEpisodes)
+		{
+			if (Episode.LastSample < StartIndex || Episode.FirstSample > EndIndex
+				|| !SampledFrameData.IsValidIndex(Episode.FirstSample) || !SampledFrameData.IsValidIndex(Episode.LastSample))
+			{
+				continue;
+			}
+			const float Left = IndexToPlotX(FMath::Max(Episode.FirstSample, StartIndex));
+			const float Right = IndexToPlotX(FMath::Min(Episode.LastSample, EndIndex));
+			FSlateDrawElement::MakeBox(
+				Out,
+				Layer,
+				Geo.ToPaintGeometry(FVector2D(Left - 1.0f, PlotT), FVector2D(FMath::Max(2.0f, Right - Left + 2.0f), PlotB - PlotT)),
+				FCoreStyle::Get().GetBrush("WhiteBrush"),
+				ESlateDrawEffect::None,
+				HitchColor.CopyWithNewOpacity(0.12f)
+			);
+		}
+
+		// Events are in sample order; skip straight to the visible ones
+		const int32 FirstEvent = Algo::LowerBoundBy(HitchEvents, StartIndex, [](const FPTHitchEvent& Event) { return Event.SampleIndex; });
+		TArray<FVector2D> Tick;
+		Tick.SetNum(2);
+		float LastTickX = -FLT_MAX;
+		for (int32 e = FirstEvent; e < HitchEvents.Num() && HitchEvents[e].SampleIndex <= EndIndex; ++e)
+		{
+			const float X = IndexToPlotX(HitchEvents[e].SampleIndex);
+			if (X - LastTickX < 1.0f)
+			{
+				continue; // one tick per pixel is enough
+			}
+			LastTickX = X;
+			Tick[0] = FVector2D(X, PlotT);
+			Tick[1] = FVector2D(X, PlotT + 6.0f);
+			FSlateDrawElement::MakeLines(Out, Layer, Geo.ToPaintGeometry(), Tick, ESlateDrawEffect::None, HitchColor, true, 1.5f);
+		}
+		Layer++;
+	}
+
 	// ====================================================
 	// 4.5️⃣ Selection range overlay
 	// ====================================================
@@ -420,10 +983,9 @@ int32 SPerformanceGraph::OnPaint(const FPaintArgs& Args,const FGeometry& Geo,con
 				// Draw a small marker at the frame value (use Frame curve value if available)
 				if (SampledFrameData.IsValidIndex(HoveredIndex))
 				{
-					float FrameValue = SampledFrameData[HoveredIndex].FrameMS;
+					float FrameValue = GetCurveSample(EPerfCurve::Frame, HoveredIndex);
 					// map to Y
-					const float AlphaYVal = FrameValue / MaxMs;
-					const float YPos = PlotB - AlphaYVal * (PlotB - PlotT);
+					const float YPos = ValueToY(FrameValue);
 					// small cross marker
 					TArray<FVector2D> Cross;
 					Cross.Add(FVector2D(LineX - 4.0f, YPos - 4.0f));
@@ -544,6 +1106,7 @@ FReply SPerformanceGraph::OnMouseMove(const FGeometry& MyGeometry, const FPointe
 	bHasHover = true;
 
 	// Compute hovered index using shared helper
+	const int32 PrevHoveredIndex = HoveredIndex;
 	HoveredIndex = LocalXToSampleIndex(MyGeometry, Local.X);
 
 	// Notify delegate about hover change unless hover is locked (still notify to let UI update locked position on toggle)
@@ -552,8 +1115,11 @@ FReply SPerformanceGraph::OnMouseMove(const FGeometry& MyGeometry, const FPointe
 		OnHoverSampleChanged.Execute(HoveredIndex, HoverLocal);
 	}
 
-	// Ensure we repaint so the vertical line and any hover visuals update immediately
-	Invalidate(EInvalidateWidget::Paint);
+	// The hover line is drawn at the sample position, so only repaint when the hovered sample actually changes
+	if (HoveredIndex != PrevHoveredIndex)
+	{
+		Invalidate(EInvalidateWidget::Paint);
+	}
 
 	// existing pan handling
 	if (!bIsPanning && !bIsSelecting)
@@ -691,7 +1257,7 @@ FReply SPerformanceGraph::OnMouseWheel(const FGeometry& MyGeometry, const FPoint
 
 	// Compute click alpha within current view (prefer time-based so "keep under cursor" feels consistent)
 	double TimeStart = SampleTimes.IsValidIndex(StartIndex) ? SampleTimes[StartIndex] : 0.0;
-	double TimeEnd = SampleTimes.IsValidIndex(EndIndex) ? (SampleTimes[EndIndex] + SampledFrameData[EndIndex].FrameMS) : (double)(EndIndex - StartIndex + 1);
+	double TimeEnd = SampleTimes.IsValidIndex(EndIndex) ? (SampleTimes[EndIndex] + GetSampleDuration(EndIndex)) : (double)(EndIndex - StartIndex + 1);
 	const double TimeRange = FMath::Max(1e-6, TimeEnd - TimeStart);
 	const double ClickTime = SampleTimes.IsValidIndex(ClickIndex) ? SampleTimes[ClickIndex] : (TimeStart + 0.5 * TimeRange);
 	float ClickAlpha = (float)((ClickTime - TimeStart) / TimeRange);
@@ -739,7 +1305,7 @@ double SPerformanceGraph::LocalXToTime(const FGeometry& MyGeometry, float LocalX
 		EndIndex = N - 1;
 	}
 	double TimeStart = SampleTimes.IsValidIndex(StartIndex) ? SampleTimes[StartIndex] : 0.0;
-	double TimeEnd = SampleTimes.IsValidIndex(EndIndex) ? (SampleTimes[EndIndex] + SampledFrameData[EndIndex].FrameMS) : (double)(EndIndex - StartIndex + 1);
+	double TimeEnd = SampleTimes.IsValidIndex(EndIndex) ? (SampleTimes[EndIndex] + GetSampleDuration(EndIndex)) : (double)(EndIndex - StartIndex + 1);
 	const double TimeRange = FMath::Max(1e-6, TimeEnd - TimeStart);
 	return TimeStart + Alpha * TimeRange;
 }
@@ -758,7 +1324,7 @@ int32 SPerformanceGraph::LocalXToSampleIndex(const FGeometry& MyGeometry, float
 	int32 EndIndex = StartIndex + FMath::Max(1, ViewCount) - 1;
 	EndIndex = FMath::Clamp(EndIndex, 0, N - 1);
 	double TimeStart = SampleTimes.IsValidIndex(StartIndex) ? SampleTimes[StartIndex] : 0.0;
-	double TimeEnd = SampleTimes.IsValidIndex(EndIndex) ? (SampleTimes[EndIndex] + SampledFrameData[EndIndex].FrameMS) : (double)(EndIndex - StartIndex + 1);
+	double TimeEnd = SampleTimes.IsValidIndex(EndIndex) ? (SampleTimes[EndIndex] + GetSampleDuration(EndIndex)) : (double)(EndIndex - StartIndex + 1);
 	double ClickTime = TimeStart + Alpha * FMath::Max(1e-6, TimeEnd - TimeStart);
 
 	// binary search for greatest index with time <= ClickTime
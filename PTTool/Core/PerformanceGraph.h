@@ -12,6 +12,11 @@ enum class EPerfCurve : uint8
 	RHI,
 	GPU
 };
+enum class EPerfGraphXAxis : uint8
+{
+	Time,
+	Distance
+};
 static FLinearColor GetCurveColor(EPerfCurve Curve)
 {
 	switch (Curve)
@@ -33,6 +38,43 @@ static FLinearColor GetCurveColor(EPerfCurve Curve)
 // 前向声明，避免 include 依赖爆炸
 struct FSampledFrameData;
 
+static constexpr int32 PerfCurveCount = 5;
+
+/**
+ * Min/max/mean decimation pyramid for a single curve, built once per capture.
+ * Level 0 aggregates BaseBucketSize samples per bucket, each further level merges LevelFactor buckets
+ * of the previous one. Min/Max are kept per bucket so spikes survive any amount of decimation.
+ */
+struct FPerfCurveLOD
+{
+	static constexpr int32 BaseBucketSize = 4;
+	static constexpr int32 LevelFactor = 4;
+
+	struct FLevel
+	{
+		int32 SamplesPerBucket = 1;
+		TArray<float> Min;
+		TArray<float> Max;
+		TArray<float> Mean;
+	};
+
+	// Raw samples of this curve (contiguous column, owned by the graph's FPTFrameColumns or a mapped capture)
+	TConstArrayView<float> Samples;
+	// Per-sample bounds for bucketed captures (each sample is a bucket mean); empty otherwise
+	TConstArrayView<float> SampleMin;
+	TConstArrayView<float> SampleMax;
+	TArray<FLevel> Levels;
+
+	void Build(TConstArrayView<float> InSamples, TConstArrayView<float> InMin = {}, TConstArrayView<float> InMax = {});
+
+	bool HasSampleBounds() const { return SampleMin.Num() == Samples.Num() && SampleMax.Num() == Samples.Num(); }
+	float GetSampleMin(int32 Index) const { return HasSampleBounds() ? SampleMin[Index] : Samples[Index]; }
+	float GetSampleMax(int32 Index) const { return HasSampleBounds() ? SampleMax[Index] : Samples[Index]; }
+
+	// Coarsest level that still has at least MinBuckets buckets for VisibleSamples samples; nullptr means use raw samples.
+	const FLevel* FindLevel(int32 VisibleSamples, int32 MinBuckets) const;
+};
+
 class SPerformanceGraph : public SLeafWidget
 {
 public:
@@ -42,33 +84,34 @@ public:
 	void Construct(const FArguments& InArgs) {}
 	// zoom: 1.0 = show all samples; >1 zooms in (fewer samples visible)
 	float Zoom = 1.0f;
-	const float TargetSmoothPx = 0.1f;
 
 	// View window in sample indices. ViewCount==0 means full range.
 	int32 ViewStart = 0;
 	int32 ViewCount = 0;
 	
-	void SetFrameData(const TArray<FSampledFrameData>& InData)
-	{
-		SampledFrameData = InData;   // Graph 内部 TArray
-		ViewStart = 0;
-		// Default to a reasonable initial window so panning works immediately.
-		// If there are few samples, show all; otherwise show the most recent 200 samples.
-		const int32 Num = SampledFrameData.Num();
-		ViewCount = FMath::Min(Num, 1000000000);
-
-		// Compute cumulative times (ms) for each sample. time[0] = 0, time[i] = sum_{j=0..i-1} FrameMS
-		SampleTimes.Reset();
-		SampleTimes.Reserve(Num);
-		double Cum = 0.0;
-		for (int32 i = 0; i < Num; ++i)
-		{
-			SampleTimes.Add(Cum);
-			Cum += SampledFrameData[i].FrameMS;
-		}
-		UE_LOG(LogTemp, Display, TEXT("SampledFrameData"));
-		Invalidate(EInvalidateWidget::Paint);
-	}
+	// InData is the series to draw (raw or smoothed); InSource, when given, supplies the sampling mode and the
+	// bucket bounds/frame counts so decimated and bucketed captures keep their real time axis.
+	void SetFrameData(const FPTFrameColumns& InData, const FSampledGraphData* InSource = nullptr);
+
+	// Comparison mode: overlay InBaseline (dimmed) under each visible curve, aligned by position along the path.
+	// Call after SetFrameData; nullptr removes the overlay.
+	void SetBaseline(const FSampledGraphData* InBaseline);
+	bool HasBaseline() const { return BaselineIndexMap.Num() == SampledFrameData.Num() + 1 && SampledFrameData.Num() > 0; }
+
+	// X axis in time, or in distance travelled along the spline (needs recorded path columns, see CanShowDistance)
+	void SetXAxis(EPerfGraphXAxis InAxis);
+	EPerfGraphXAxis GetXAxis() const { return XAxis; }
+	bool CanShowDistance() const { return SampleDistances.Num() == SampledFrameData.Num() + 1 && SampledFrameData.Num() > 0; }
+
+	// Column drawn against a second Y axis on the right: the node's memory columns (MB) first, then its provider
+	// metrics (FSampledGraphData::MetricColumns). INDEX_NONE hides it. Kept across SetFrameData while the new node
+	// has a column of the same name.
+	void SetSecondarySeries(int32 InSeries);
+	int32 GetSecondarySeries() const { return SecondarySeries; }
+	bool HasSecondarySeries() const { return SecondarySeries != INDEX_NONE && SecondaryLOD.Samples.Num() == SampledFrameData.Num(); }
+	int32 NumSecondarySeries() const { return MemoryColumns.NumThreads() + MetricColumns.NumThreads(); }
+	FString GetSecondarySeriesName(int32 Series) const;
+	FString GetSecondarySeriesUnit(int32 Series) const;
 
 	void SetVisibleCurves(const TSet<EPerfCurve>& InCurves)
 	{
@@ -127,12 +170,47 @@ protected:
 	virtual void OnMouseLeave(const FPointerEvent& MouseEvent) override;
 
 public:
-	TArray<FSampledFrameData> SampledFrameData;
+	FPTFrameColumns SampledFrameData;
 	TSet<EPerfCurve> VisibleCurves;
 
-	// Cumulative time (ms) at each sample index. SampleTimes[0] == 0.
+	// Sampling of SampledFrameData; see SetFrameData
+	EPTSamplingMode SamplingMode = EPTSamplingMode::EveryFrame;
+	float SampleIntervalMs = 0.f;
+	FPTFrameColumns BucketMin;
+	FPTFrameColumns BucketMax;
+	TArray<int32> BucketFrameCounts;
+
+	// Hitch markers of the shown node (FPTHitchReport), sorted by sample index
+	TArray<FPTHitchEvent> HitchEvents;
+	TArray<FPTHitchEpisode> HitchEpisodes;
+
+	// X extent of one sample. Time axis: ms covered by the frame itself, one interval, or all frames of the bucket.
+	// Distance axis: cm of path travelled until the next sample.
+	double GetSampleDuration(int32 Index) const;
+
+	// Cumulative X (ms, or cm on the distance axis) at each sample index. SampleTimes[0] == 0.
 	TArray<double> SampleTimes;
 
+	// Travelled spline distance (cm) at each sample, plus the end (Num + 1 entries); empty without path columns
+	EPerfGraphXAxis XAxis = EPerfGraphXAxis::Time;
+	TArray<double> SampleDistances;
+
+	// Per-curve decimation pyramid, indexed by EPerfCurve. Rebuilt in SetFrameData only.
+	FPerfCurveLOD CurveLODs[PerfCurveCount];
+
+	// Memory (MB) and metric columns of the shown node, and the pyramid of the selected secondary series
+	FPTThreadTimingStore MemoryColumns;
+	FPTThreadTimingStore MetricColumns;
+	TArray<FString> MetricUnits;
+	int32 SecondarySeries = INDEX_NONE;
+	FPerfCurveLOD SecondaryLOD;
+	TConstArrayView<float> GetSecondaryColumn(int32 Series) const;
+
+	float GetCurveSample(EPerfCurve Curve, int32 Index) const
+	{
+		return CurveLODs[(uint8)Curve].Samples[Index];
+	}
+
     // Hover state: index under cursor, local position and whether to show tooltip
     int32 HoveredIndex = INDEX_NONE;
     FVector2D HoverLocal = FVector2D::ZeroVector;
@@ -153,6 +231,25 @@ private:
 	FVector2D SelectStartLocal = FVector2D::ZeroVector;
 	int32 SelectionStartIndex = INDEX_NONE;
 	int32 SelectionEndIndex = INDEX_NONE;
+
+	// Baseline overlay: path fractions of the baseline samples, per-curve prefix sums (O(1) range means)
+	// and, for each sample of ours (+1 end entry), the baseline sample at the same path position
+	TArray<float> BaselineFractions;
+	TArray<double> BaselinePrefix[PerfCurveCount];
+	TArray<int32> BaselineIndexMap;
+	void RebuildBaselineMap();
+	void RebuildSampleTimes();
+	// Baseline mean of Curve over the path covered by our samples [First, Last]
+	float GetBaselineMean(EPerfCurve Curve, int32 First, int32 Last) const;
+
+	// Paint scratch buffers, reused between paints to avoid per-frame allocations
+	mutable TArray<FVector2D> PointScratch;
+	mutable TArray<FVector2D> EnvelopeScratch;
+	mutable TArray<FVector2D> BaselineScratch;
+	mutable TArray<float> ColumnMin;
+	mutable TArray<float> ColumnMax;
+	mutable TArray<double> ColumnSum;
+	mutable TArray<int32> ColumnCount;
 };
 
 
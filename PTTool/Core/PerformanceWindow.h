@@ -13,6 +13,10 @@
 #include "Widgets/Layout/SBorder.h"
 #include "Widgets/Text/STextBlock.h"
 #include "PTDataType.h"
+#include "PTStatistics.h"
+#include "PTCaptureFile.h"
+#include "PTCaptureComparison.h"
+#include "PTRepetitionStats.h"
 #include "Misc/Paths.h"
 
 #include "IImageWrapperModule.h"
@@ -33,813 +37,164 @@
 #include "Widgets/SOverlay.h"
 #include "Widgets/Input/SButton.h"
 #include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SComboButton.h"
+#include "Framework/MultiBox/MultiBoxBuilder.h"
 #include "Widgets/SBoxPanel.h" // SHorizontalBox/SVerticalBox
 
 #include "SFrameHoverWidget.h"
 
 
-inline TArray<TSharedPtr<FSampledGraphData>> ListItems;
+inline TArray<TSharedPtr<const FSampledGraphData>> ListItems;
 
-inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
+// "Frame P50 | P90 | P95 | P99 | P99.9 | 1% Low" plus P99 of the other curves
+inline FString FormatFramePercentiles(const FPTFramePercentiles& P)
 {
-	TSharedPtr<SListView<TSharedPtr<FSampledGraphData>>> ListView;
-	ListItems.Reset();
-	ListItems.Reserve(Sample.Num());
-
-	for (const FSampledGraphData& Data : Sample)
-	{
-		ListItems.Add(MakeShared<FSampledGraphData>(Data));
-	}
-
-	TSharedRef<SPerformanceGraph> PerformanceGraph =
-		SNew(SPerformanceGraph);
-
-	// Track currently selected item so stats can update.
-	TSharedPtr<TSharedPtr<FSampledGraphData>> SelectedItem = MakeShared<TSharedPtr<FSampledGraphData>>();
-
-	// Track current selection range (inclusive indices, in graph's SampledFrameData index space)
-	TSharedPtr<int32> RangeStartIndex = MakeShared<int32>(INDEX_NONE);
-	TSharedPtr<int32> RangeEndIndex = MakeShared<int32>(INDEX_NONE);
-
-	// Visible thread filter (legend toggles). Empty => show all.
-	TSharedPtr<TSet<FString>> VisibleThreads = MakeShared<TSet<FString>>();
-
-	// Visible curve toggles (for Frame/Game/Draw/RHI/GPU)
-	TSharedPtr<TSet<EPerfCurve>> VisibleCurves = MakeShared<TSet<EPerfCurve>>(
-		TSet<EPerfCurve>({ EPerfCurve::Frame, EPerfCurve::Game, EPerfCurve::Draw, EPerfCurve::GPU })
-	);
-
-
-	//根据宏定义创建窗口
-	TSharedRef<SWindow> Window = SNew(SWindow)
-		.Title(FText::FromString(TEXT("Performance Analyzer")))
-		.ClientSize(FVector2D(PT_PERFORMANCE_GRAPH_WINDOW_SIZE_X, PT_PERFORMANCE_GRAPH_WINDOW_SIZE_Y));
-
-	// Create hover widget
-	TSharedPtr<class SFrameHoverWidget> HoverWidget;
-
-	// Shared hover position in local overlay coordinates (updated by graph delegate)
-	TSharedPtr<FVector2D> HoverPos = MakeShared<FVector2D>(FVector2D::ZeroVector);
-
-	// Shared range stats cache for hover widget
-	TSharedPtr<SFrameHoverWidget::FRangeStats> RangeStatsCache = MakeShared<SFrameHoverWidget::FRangeStats>();
-
-	Window->SetContent(
-		SNew(SVerticalBox)
-
-		+ SVerticalBox::Slot()
-		.FillHeight(1.f)
-		[
-			SNew(SSplitter)
-			.Orientation(Orient_Vertical)
-
-			+ SSplitter::Slot()
-			.Value(0.25f) // 初始占比 25%
-			[
-				SNew(SExpandableArea)
-				.InitiallyCollapsed(false)
-
-				.HeaderContent()
-				[
-					SNew(SBorder)
-					.Padding(6)
-					[
-						SNew(STextBlock)
-						.Text(FText::FromString(TEXT("Performance Test List")))
-					]
-				]
-
-				.BodyContent()
-				[
-					// 把原有 List 放在左侧，并在右侧添加一个按钮列
-					SNew(SHorizontalBox)
-
-					+ SHorizontalBox::Slot()
-					.FillWidth(1.0f)
-					[
-						SAssignNew(ListView, SListView<TSharedPtr<FSampledGraphData>>)
-						.ListItemsSource(&ListItems)
-						.SelectionMode(ESelectionMode::Single)
-						.OnGenerateRow_Lambda(
-							[](TSharedPtr<FSampledGraphData> Item, const TSharedRef<STableViewBase>& Owner)
-							{
-								return SNew(STableRow<TSharedPtr<FSampledGraphData>>, Owner)
-									[
-										SNew(STextBlock).Text(FText::FromString(Item->SplineName))
-									];
-							}
-						)
-						.OnSelectionChanged_Lambda(
-							[PerformanceGraph, SelectedItem, VisibleThreads](TSharedPtr<FSampledGraphData> Item, ESelectInfo::Type SelectType)
-							{
-								if (!Item.IsValid())
-								{
-									return;
-								}
-
-								*SelectedItem = Item;
-								PerformanceGraph->SetFrameData(Item->FrameData);
-
-								// When selecting an item, initialize VisibleThreads with all thread names (so legend works immediately).
-								VisibleThreads->Reset();
-								for (const FSampledFrameData& Frame : Item->FrameData)
-								{
-									for (const FThreadSample& Thread : Frame.ThreadData)
-									{
-										VisibleThreads->Add(Thread.ThreadName);
-									}
-								}
-							}
-						)
-					]
-
-					// 新增：右侧按钮列（包含截图按钮）
-					+ SHorizontalBox::Slot()
-					.AutoWidth()
-					.Padding(6, 0, 0, 0)
-					[
-						SNew(SVerticalBox)
-						+ SVerticalBox::Slot().AutoHeight().Padding(2)
-						[
-							SNew(SButton)
-							.Text(FText::FromString(TEXT("Capture Window")))
-							.ToolTipText(FText::FromString(TEXT("Capture current PTTool window to PNG.\nSaved to: <Project>/Saved/" PTTOOL_CAPTURE_EXPORT_SUBDIR "\nYou can customize the export folder in C++ by defining PTTOOL_CAPTURE_EXPORT_SUBDIR.")))
-							.OnClicked_Lambda([Window]() -> FReply
-							{
-								// Capture the native window contents on Windows using GDI and save as PNG into Saved folder
-#if PLATFORM_WINDOWS
-								void* OSHandle = nullptr;
-								// TSharedRef doesn't have IsValid(); check the native window instead
-								if (Window->GetNativeWindow().IsValid())
-								{
-									OSHandle = Window->GetNativeWindow()->GetOSWindowHandle();
-								}
-								if (!OSHandle)
-								{
-									UE_LOG(LogTemp, Warning, TEXT("CaptureWindow: native OS handle not available"));
-									return FReply::Handled();
-								}
-								HWND Hwnd = (HWND)OSHandle;
-								RECT rc;
-								if (!GetClientRect(Hwnd, &rc))
-								{
-									UE_LOG(LogTemp, Warning, TEXT("CaptureWindow: GetClientRect failed"));
-									return FReply::Handled();
-								}
-								int32 Width = rc.right - rc.left;
-								int32 Height = rc.bottom - rc.top;
-								if (Width <= 0 || Height <= 0)
-								{
-									UE_LOG(LogTemp, Warning, TEXT("CaptureWindow: invalid size %d x %d"), Width, Height);
-									return FReply::Handled();
-								}
-
-								HDC hdcWindow = GetDC(Hwnd);
-								HDC hdcMemDC = CreateCompatibleDC(hdcWindow);
-								HBITMAP hBitmap = CreateCompatibleBitmap(hdcWindow, Width, Height);
-								HGDIOBJ hOld = SelectObject(hdcMemDC, hBitmap);
-								// Include layered windows / transparent areas
-								BitBlt(hdcMemDC, 0, 0, Width, Height, hdcWindow, 0, 0, SRCCOPY | CAPTUREBLT);
-
-								// Prepare BITMAPINFO for 32-bit BGRA
-								BITMAPINFO bmi;
-								FMemory::Memzero(bmi);
-								bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
-								bmi.bmiHeader.biWidth = Width;
-								// negative height to get top-down DIB
-								bmi.bmiHeader.biHeight = -Height;
-								bmi.bmiHeader.biPlanes = 1;
-								bmi.bmiHeader.biBitCount = 32;
-								bmi.bmiHeader.biCompression = BI_RGB;
-
-								TArray<uint8> RawData;
-								RawData.AddUninitialized(Width * Height * 4);
-								if (GetDIBits(hdcWindow, hBitmap, 0, Height, RawData.GetData(), &bmi, DIB_RGB_COLORS) == 0)
-								{
-									UE_LOG(LogTemp, Warning, TEXT("CaptureWindow: GetDIBits failed"));
-								}
-								else
-								{
-									// Convert BGRA -> RGBA for ImageWrapper
-									for (int32 i = 0; i < Width * Height; ++i)
-									{
-										uint8 B = RawData[i * 4 + 0];
-										uint8 G = RawData[i * 4 + 1];
-										uint8 R = RawData[i * 4 + 2];
-										uint8 A = RawData[i * 4 + 3];
-										RawData[i * 4 + 0] = R;
-										RawData[i * 4 + 1] = G;
-										RawData[i * 4 + 2] = B;
-										RawData[i * 4 + 3] = A;
-									}
-
-									IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-									TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
-									if (ImageWrapper.IsValid())
-									{
-										if (ImageWrapper->SetRaw(RawData.GetData(), RawData.Num(), Width, Height, ERGBFormat::RGBA, 8))
-										{
-											auto Compressed = ImageWrapper->GetCompressed(100);
-											FString Filename = FPaths::ProjectSavedDir() / PTTOOL_CAPTURE_EXPORT_SUBDIR;
-
-											IFileManager::Get().MakeDirectory(*Filename, true);
-											FString FilePath = Filename / (FString::Printf(TEXT("PerformanceWindow_%s.png"), *FDateTime::Now().ToString()));
-											// Write compressed bytes using file writer to support different TArray types
-											FArchive* FileWriter = IFileManager::Get().CreateFileWriter(*FilePath);
-											if (FileWriter)
-											{
-												FileWriter->Serialize(Compressed.GetData(), (int64)Compressed.Num());
-												FileWriter->Close();
-												delete FileWriter;
-												UE_LOG(LogTemp, Log, TEXT("Capture saved to %s"), *FilePath);
-											}
-										}
-									}
-								}
-
-								// cleanup
-								SelectObject(hdcMemDC, hOld);
-								DeleteObject(hBitmap);
-								DeleteDC(hdcMemDC);
-								ReleaseDC(Hwnd, hdcWindow);
-#endif
-								return FReply::Handled();
-							})
-						]
-
-						+ SVerticalBox::Slot().AutoHeight().Padding(2)
-						[
-							SNew(SButton)
-							.Text(FText::FromString(TEXT("Button 2")))
-							.OnClicked_Lambda([]() -> FReply { return FReply::Handled(); })
-						]
-
-						+ SVerticalBox::Slot().AutoHeight().Padding(2)
-						[
-							SNew(SButton)
-							.Text(FText::FromString(TEXT("Button 3")))
-							.OnClicked_Lambda([]() -> FReply { return FReply::Handled(); })
-						]
-					]
-				]
-			]
-
-			// ===== 下半：Graph（高度不受折叠影响）=====
-			+ SSplitter::Slot()
-			.Value(0.75f)
-			[
-				SNew(SOverlay)
-				+ SOverlay::Slot()
-				[
-					PerformanceGraph
-				]
-				// place hover widget using dynamic padding so it follows graph-local coords
-				+ SOverlay::Slot()
-				.Padding(TAttribute<FMargin>::CreateLambda([HoverPos]() { return FMargin(HoverPos->X, HoverPos->Y, 0, 0); }))
-				.HAlign(HAlign_Left)
-				.VAlign(VAlign_Top)
-				[
-					SAssignNew(HoverWidget, SFrameHoverWidget)
-				]
-
-
-			]
-		]
-		// ===== 上半：List =====
-
-
-		+ SVerticalBox::Slot()
-		.AutoHeight()     
-		[
-			SNew(SHorizontalBox)
-			+ SHorizontalBox::Slot()
-			.AutoWidth()
-			.Padding(8, 2)
-			[
-				SNew(SHorizontalBox)
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				[
-					SNew(SBorder)
-					.BorderBackgroundColor(GetCurveColor(EPerfCurve::Frame))
-					.Padding(FMargin(6, 6))
-				]
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				.Padding(4, 0)
-				[
-					SNew(STextBlock)
-					.Text(FText::FromString(TEXT("Frame")))
-				]
-			]
-
-			// Game
-			+ SHorizontalBox::Slot()
-			.AutoWidth()
-			.Padding(8, 2)
-			[
-				SNew(SHorizontalBox)
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				[
-					SNew(SBorder)
-					.BorderBackgroundColor(GetCurveColor(EPerfCurve::Game))
-					.Padding(FMargin(6, 6))
-				]
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				.Padding(4, 0)
-				[
-					SNew(STextBlock)
-					.Text(FText::FromString(TEXT("Game")))
-				]
-			]
-
-			// Draw
-			+ SHorizontalBox::Slot()
-			.AutoWidth()
-			.Padding(8, 2)
-			[
-				SNew(SHorizontalBox)
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				[
-					SNew(SBorder)
-					.BorderBackgroundColor(GetCurveColor(EPerfCurve::Draw))
-					.Padding(FMargin(6, 6))
-				]
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				.Padding(4, 0)
-				[
-					SNew(STextBlock)
-					.Text(FText::FromString(TEXT("Draw")))
-				]
-			]
-
-			// RHI
-			+ SHorizontalBox::Slot()
-			.AutoWidth()
-			.Padding(8, 2)
-			[
-				SNew(SHorizontalBox)
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				[
-					SNew(SBorder)
-					.BorderBackgroundColor(GetCurveColor(EPerfCurve::RHI))
-					.Padding(FMargin(6, 6))
-				]
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				.Padding(4, 0)
-				[
-					SNew(STextBlock)
-					.Text(FText::FromString(TEXT("RHI")))
-				]
-			]
-
-			// GPU
-			+ SHorizontalBox::Slot()
-			.AutoWidth()
-			.Padding(8, 2)
-			[
-				SNew(SHorizontalBox)
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				[
-					SNew(SBorder)
-					.BorderBackgroundColor(GetCurveColor(EPerfCurve::GPU))
-					.Padding(FMargin(6, 6))
-				]
-
-				+ SHorizontalBox::Slot()
-				.AutoWidth()
-				.VAlign(VAlign_Center)
-				.Padding(4, 0)
-				[
-					SNew(STextBlock)
-					.Text(FText::FromString(TEXT("GPU")))
-				]
-			]
-		]
-
-
-		// ===== Bottom stats bar =====
-		+ SVerticalBox::Slot()
-		.AutoHeight()
-		.Padding(8, 4)
-		[
-			SNew(SBorder)
-			.Padding(6)
-			.BorderImage(FCoreStyle::Get().GetBrush("ToolPanel.GroupBorder"))
-			[
-				SNew(SVerticalBox)
-
-				+ SVerticalBox::Slot()
-				.AutoHeight()
-				[
-					SNew(STextBlock)
-					.Text(FText::FromString(TEXT("Thread Stats (click legend to show/hide)")))
-					.Font(FCoreStyle::GetDefaultFontStyle("Bold", 10))
-				]
-
-				// Legend row
-				+ SVerticalBox::Slot()
-				.AutoHeight()
-				.Padding(0, 4, 0, 0)
-				[
-					SNew(SHorizontalBox)
-					+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
-					[
-						SNew(STextBlock)
-						.Text(FText::FromString(TEXT("Legend:")))
-						.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
-					]
-					+ SHorizontalBox::Slot().FillWidth(1.0f).Padding(6,0,0,0)
-					[
-						SNew(SHorizontalBox)
-						// Dynamic buttons
-						+ SHorizontalBox::Slot()
-						.FillWidth(1.0f)
-						[
-							SNew(SHorizontalBox)
-							// This inner box will be rebuilt by lambda into text blocks with separators.
-							+ SHorizontalBox::Slot().FillWidth(1.0f)
-							[
-								SNew(STextBlock)
-								.Text_Lambda([SelectedItem]()
-								{
-									TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
-									return Item.IsValid() ? FText::FromString(TEXT("")) : FText::FromString(TEXT("(select a test)"));
-								})
-							]
-						]
-					]
-				]
-
-				// Whole capture
-				+ SVerticalBox::Slot()
-				.AutoHeight()
-				.Padding(0, 4, 0, 0)
-				[
-					SNew(STextBlock)
-					.Text_Lambda([SelectedItem, VisibleThreads]()
-					{
-						TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
-						if (!Item.IsValid())
-						{
-							return FText::FromString(TEXT("Whole Capture: No selection"));
-						}
-						if (Item->FrameData.Num() == 0)
-						{
-							return FText::FromString(TEXT("Whole Capture: No FrameData"));
-						}
-
-						struct FAcc { double Sum = 0.0; int32 Count = 0; float Min = 0.f; float Max = 0.f; bool bInit = false; };
-						TMap<FString, FAcc> Acc;
-						for (const FSampledFrameData& F : Item->FrameData)
-						{
-							for (const FThreadSample& T : F.ThreadData)
-							{
-								if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(T.ThreadName))
-								{
-									continue;
-								}
-								FAcc& A = Acc.FindOrAdd(T.ThreadName);
-								A.Sum += (double)T.TimeMs;
-								A.Count += 1;
-								if (!A.bInit)
-								{
-									A.Min = T.TimeMs;
-									A.Max = T.TimeMs;
-									A.bInit = true;
-								}
-								else
-								{
-									A.Min = FMath::Min(A.Min, T.TimeMs);
-									A.Max = FMath::Max(A.Max, T.TimeMs);
-								}
-							}
-						}
-						if (Acc.Num() == 0)
-						{
-							return FText::FromString(TEXT("Whole Capture: No ThreadData recorded (or filtered out)"));
-						}
-
-						TArray<TPair<FString, FAcc>> Pairs;
-						for (const TPair<FString, FAcc>& KV : Acc)
-						{
-							Pairs.Add(KV);
-						}
-						Pairs.Sort([](const TPair<FString, FAcc>& A, const TPair<FString, FAcc>& B)
-						{
-							const double AvgA = A.Value.Count > 0 ? A.Value.Sum / (double)A.Value.Count : 0.0;
-							const double AvgB = B.Value.Count > 0 ? B.Value.Sum / (double)B.Value.Count : 0.0;
-							return AvgA > AvgB;
-						});
-
-						FString Out(TEXT("Whole Capture: "));
-						for (int32 i = 0; i < Pairs.Num(); ++i)
-						{
-							const FString& Name = Pairs[i].Key;
-							const FAcc& A = Pairs[i].Value;
-							const float Avg = A.Count > 0 ? (float)(A.Sum / (double)A.Count) : 0.f;
-							Out += FString::Printf(TEXT("%s Avg %.2f | Min %.2f | Max %.2f"), *Name, Avg, A.Min, A.Max);
-							if (i != Pairs.Num() - 1)
-							{
-								Out += TEXT("    ||    ");
-							}
-						}
-						return FText::FromString(Out);
-					})
-					.AutoWrapText(true)
-					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
-				]
-
-				// Range stats (filtered)
-				+ SVerticalBox::Slot()
-				.AutoHeight()
-				.Padding(0, 4, 0, 0)
-				[
-					SNew(STextBlock)
-					.Text_Lambda([SelectedItem, RangeStartIndex, RangeEndIndex, VisibleThreads]()
-					{
-						TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
-						if (!Item.IsValid())
-						{
-							return FText::FromString(TEXT("Range: No selection"));
-						}
-						if (Item->FrameData.Num() == 0)
-						{
-							return FText::FromString(TEXT("Range: No FrameData"));
-						}
-
-						int32 SIdx = RangeStartIndex.IsValid() ? *RangeStartIndex : INDEX_NONE;
-						int32 EIdx = RangeEndIndex.IsValid() ? *RangeEndIndex : INDEX_NONE;
-						if (SIdx == INDEX_NONE || EIdx == INDEX_NONE)
-						{
-							return FText::FromString(TEXT("Range: (drag on graph to select)"));
-						}
-						if (SIdx > EIdx)
-						{
-							Swap(SIdx, EIdx);
-						}
-
-						SIdx = FMath::Clamp(SIdx, 0, Item->FrameData.Num() - 1);
-						EIdx = FMath::Clamp(EIdx, 0, Item->FrameData.Num() - 1);
-						if (SIdx > EIdx)
-						{
-							return FText::FromString(TEXT("Range: invalid"));
-						}
-
-						struct FAcc { double Sum = 0.0; int32 Count = 0; float Min = 0.f; float Max = 0.f; bool bInit = false; };
-						TMap<FString, FAcc> Acc;
-						for (int32 i = SIdx; i <= EIdx; ++i)
-						{
-							const FSampledFrameData& F = Item->FrameData[i];
-							for (const FThreadSample& T : F.ThreadData)
-							{
-								if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(T.ThreadName))
-								{
-									continue;
-								}
-								FAcc& A = Acc.FindOrAdd(T.ThreadName);
-								A.Sum += (double)T.TimeMs;
-								A.Count += 1;
-								if (!A.bInit)
-								{
-									A.Min = T.TimeMs;
-									A.Max = T.TimeMs;
-									A.bInit = true;
-								}
-								else
-								{
-									A.Min = FMath::Min(A.Min, T.TimeMs);
-									A.Max = FMath::Max(A.Max, T.TimeMs);
-								}
-							}
-						}
-
-						if (Acc.Num() == 0)
-						{
-							return FText::FromString(FString::Printf(TEXT("Range [%d..%d]: No ThreadData"), SIdx, EIdx));
-						}
+	return FString::Printf(
+		TEXT("Frame P50 %.2f | P90 %.2f | P95 %.2f | P99 %.2f | P99.9 %.2f ms | 1%% Low %.1f FPS    ||    P99 Game %.2f | Draw %.2f | RHI %.2f | GPU %.2f%s"),
+		P.P50.FrameMS, P.P90.FrameMS, P.P95.FrameMS, P.P99.FrameMS, P.P999.FrameMS, P.OnePercentLowFPS,
+		P.P99.GameMS, P.P99.DrawMS, P.P99.RHITMS, P.P99.GPUMS,
+		P.bExact ? TEXT("") : TEXT("  (estimated)"));
+}
 
-						TArray<TPair<FString, FAcc>> Pairs;
-						for (const TPair<FString, FAcc>& KV : Acc)
-						{
-							Pairs.Add(KV);
-						}
-						Pairs.Sort([](const TPair<FString, FAcc>& A, const TPair<FString, FAcc>& B)
-						{
-							const double AvgA = A.Value.Count > 0 ? A.Value.Sum / (double)A.Value.Count : 0.0;
-							const double AvgB = B.Value.Count > 0 ? B.Value.Sum / (double)B.Value.Count : 0.0;
-							return AvgA > AvgB;
-						});
+// "Hitches: N spike frames in M episodes (worst X ms) || time in spikes Frame a% | Game b% | ..."
+inline FString FormatHitchReport(const FPTHitchReport& H)
+{
+	float WorstMs = 0.f;
+	for (const FPTHitchEpisode& Episode : H.Episodes)
+	{
+		WorstMs = FMath::Max(WorstMs, Episode.PeakFrameMS);
+	}
+	return FString::Printf(
+		TEXT("Hitches: %d spike frames in %d episodes (worst %.2f ms)    ||    time in spikes Frame %.1f%% | Game %.1f%% | Draw %.1f%% | RHI %.1f%% | GPU %.1f%%%s"),
+		H.NumSpikeFrames, H.Episodes.Num(), WorstMs,
+		H.GetTimeSharePercent(0), H.GetTimeSharePercent(1), H.GetTimeSharePercent(2), H.GetTimeSharePercent(3), H.GetTimeSharePercent(4),
+		H.NumDroppedEvents > 0 ? *FString::Printf(TEXT("  (%d spikes not listed)"), H.NumDroppedEvents) : TEXT(""));
+}
 
-						FString Out = FString::Printf(TEXT("Range [%d..%d]: "), SIdx, EIdx);
-						for (int32 i = 0; i < Pairs.Num(); ++i)
-						{
-							const FString& Name = Pairs[i].Key;
-							const FAcc& A = Pairs[i].Value;
-							const float Avg = A.Count > 0 ? (float)(A.Sum / (double)A.Count) : 0.f;
-							Out += FString::Printf(TEXT("%s Avg %.2f | Min %.2f | Max %.2f"), *Name, Avg, A.Min, A.Max);
-							if (i != Pairs.Num() - 1)
-							{
-								Out += TEXT("    ||    ");
-							}
-						}
-						return FText::FromString(Out);
-					})
-					.AutoWrapText(true)
-					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
-				]
-			]
-		]
+// Per-thread "Name Avg | Min | Max" over frames [StartIndex, EndIndex], bottleneck first.
+// Threads not in VisibleThreads are skipped (null or empty set shows all). Returns empty when nothing matched.
+inline FString FormatThreadRangeStats(const FPTThreadTimingStore& Store, int32 StartIndex, int32 EndIndex, const TSet<FString>* VisibleThreads)
+{
+	struct FThreadRange { int32 ThreadId = INDEX_NONE; FPTStatAccumulator Acc; };
+	TArray<FThreadRange> Rows;
 
-	);
+	StartIndex = FMath::Max(StartIndex, 0);
+	EndIndex = FMath::Min(EndIndex, Store.NumFrames - 1);
+	if (StartIndex > EndIndex)
+	{
+		return FString();
+	}
 
-	// Bind graph hover delegate to update hover widget
+	for (int32 ThreadId = 0; ThreadId < Store.NumThreads(); ++ThreadId)
 	{
-		TWeakPtr<SFrameHoverWidget> WeakHover = HoverWidget;
-		TWeakPtr<SPerformanceGraph> WeakGraph = PerformanceGraph;
-		TSharedPtr<FVector2D> LocalHoverPos = HoverPos;
-		PerformanceGraph->OnHoverSampleChanged.BindLambda([WeakHover, WeakGraph, LocalHoverPos, VisibleThreads, RangeStatsCache](int32 Index, FVector2D Local)
+		if (VisibleThreads && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(Store.ThreadNames[ThreadId]))
 		{
-			TSharedPtr<SFrameHoverWidget> HW = WeakHover.Pin();
-			TSharedPtr<SPerformanceGraph> PG = WeakGraph.Pin();
-			if (!HW.IsValid() || !PG.IsValid())
-				return;
-
-			// keep hover widget filtered according to legend
-			HW->SetVisibleThreadFilter(VisibleThreads);
+			continue;
+		}
 
-			// keep range stats displayed in hover
-			if (RangeStatsCache.IsValid() && RangeStatsCache->bHasRange)
-			{
-				HW->SetRangeStats(*RangeStatsCache);
-			}
-			else
-			{
-				HW->ClearRangeStats();
-			}
+		const TConstArrayView<float> Column = Store.GetColumn(ThreadId);
+		FThreadRange& Row = Rows.AddDefaulted_GetRef();
+		Row.ThreadId = ThreadId;
+		Row.Acc.AddColumn(Column.Slice(StartIndex, EndIndex - StartIndex + 1));
+	}
 
-			// Always update hover position so tooltip follows cursor
-			LocalHoverPos->X = Local.X + 10.0f;
-			LocalHoverPos->Y = Local.Y + 10.0f;
+	Rows.Sort([](const FThreadRange& A, const FThreadRange& B)
+	{
+		return A.Acc.Mean > B.Acc.Mean;
+	});
 
-			if (Index != INDEX_NONE)
-			{
-				if (PG->SampledFrameData.IsValidIndex(Index))
-				{
-					HW->SetFrameData(&PG->SampledFrameData[Index], Index);
-					HW->SetVisibility(EVisibility::Visible);
-				}
-				else
-				{
-					HW->SetFrameData(nullptr, INDEX_NONE);
-					HW->SetVisibility(EVisibility::Collapsed);
-				}
-			}
-			else
-			{
-				// If hover locked, keep visible; otherwise hide
-				if (!PG->IsHoverLocked())
-				{
-					HW->SetVisibility(EVisibility::Collapsed);
-				}
-			}
-		});
+	FString Out;
+	for (int32 i = 0; i < Rows.Num(); ++i)
+	{
+		const FThreadRange& Row = Rows[i];
+		Out += FString::Printf(TEXT("%s Avg %.2f | Min %.2f | Max %.2f | StdDev %.2f"), *Store.ThreadNames[Row.ThreadId], (float)Row.Acc.Mean, Row.Acc.GetMin(), Row.Acc.GetMax(), (float)Row.Acc.GetStdDev());
+		if (i != Rows.Num() - 1)
+		{
+			Out += TEXT("    ||    ");
+		}
 	}
+	return Out;
+}
 
-	// Bind selection range delegate
-	PerformanceGraph->OnSelectionRangeChanged.BindLambda([RangeStartIndex, RangeEndIndex, Window, SelectedItem, RangeStatsCache, WeakHover = TWeakPtr<SFrameHoverWidget>(HoverWidget), WeakGraph = TWeakPtr<SPerformanceGraph>(PerformanceGraph)](int32 Start, int32 End)
+// Baseline non-empty opens comparison mode: Sample is the candidate, each node is overlaid with and compared
+// against the baseline node of the same spline.
+// Repetitions, after a repeated run, are the per node statistics over all passes; Sample is the last pass.
+// Sample is shared, not copied: the list items point into it and keep it alive.
+inline void OpenPerformanceAnalyzerWindow(const TSharedRef<const TArray<FSampledGraphData>>& Sample, TArray<FSampledGraphData> Baseline = TArray<FSampledGraphData>(),
+	TArray<FPTRepeatedNodeStats> Repetitions = TArray<FPTRepeatedNodeStats>())
+{
+	TSharedPtr<SListView<TSharedPtr<const FSampledGraphData>>> ListView;
+	ListItems.Reset();
+	ListItems.Reserve(Sample->Num());
+
+	// Items alias the nodes of Sample, read-only: the capture writer may still be reading them on a worker
+	for (const FSampledGraphData& Data : *Sample)
 	{
-		// Treat single-point range (X..X) as cancel selection
-		if (Start != INDEX_NONE && End != INDEX_NONE && Start == End)
-		{
-			*RangeStartIndex = INDEX_NONE;
-			*RangeEndIndex = INDEX_NONE;
+		ListItems.Add(TSharedPtr<const FSampledGraphData>(Sample, &Data));
+	}
 
-			if (TSharedPtr<SPerformanceGraph> PG = WeakGraph.Pin())
-			{
-				PG->ClearSelection();
-			}
+	TSharedRef<SPerformanceGraph> PerformanceGraph =
+		SNew(SPerformanceGraph);
 
-			if (RangeStatsCache.IsValid())
-			{
-				*RangeStatsCache = SFrameHoverWidget::FRangeStats{};
-			}
-			if (TSharedPtr<SFrameHoverWidget> HW = WeakHover.Pin())
-			{
-				HW->ClearRangeStats();
-			}
+	// Comparison mode, computed once for all nodes
+	TSharedPtr<TArray<FSampledGraphData>> BaselineNodes = MakeShared<TArray<FSampledGraphData>>(MoveTemp(Baseline));
+	TSharedPtr<TArray<FPTNodeComparison>> Comparisons = MakeShared<TArray<FPTNodeComparison>>(
+		BaselineNodes->Num() > 0 ? FPTCaptureComparison::Compare(*BaselineNodes, *Sample) : TArray<FPTNodeComparison>());
+	auto FindComparison = [Comparisons](const FSampledGraphData& Item) -> const FPTNodeComparison*
+	{
+		return Comparisons->FindByPredicate([&Item](const FPTNodeComparison& C) { return C.SplineName == Item.SplineName; });
+	};
+	TSharedPtr<TArray<FPTRepeatedNodeStats>> RepeatedNodes = MakeShared<TArray<FPTRepeatedNodeStats>>(MoveTemp(Repetitions));
+	auto FindRepetitions = [RepeatedNodes](const FSampledGraphData& Item) -> const FPTRepeatedNodeStats*
+	{
+		return RepeatedNodes->FindByPredicate([&Item](const FPTRepeatedNodeStats& R) { return R.SplineName == Item.SplineName; });
+	};
 
-			Window->Invalidate(EInvalidateWidget::LayoutAndVolatility);
-			return;
-		}
+	// Track currently selected item so stats can update.
+	TSharedPtr<TSharedPtr<const FSampledGraphData>> SelectedItem = MakeShared<TSharedPtr<const FSampledGraphData>>();
 
-		*RangeStartIndex = Start;
-		*RangeEndIndex = End;
+	// Track current selection range (inclusive indices, in graph's SampledFrameData index space)
+	TSharedPtr<int32> RangeStartIndex = MakeShared<int32>(INDEX_NONE);
+	TSharedPtr<int32> RangeEndIndex = MakeShared<int32>(INDEX_NONE);
 
-		// compute and push range stats to hover widget
-		TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
-		TSharedPtr<SFrameHoverWidget> HW = WeakHover.Pin();
+	// Visible thread filter (legend toggles). Empty => show all.
+	TSharedPtr<TSet<FString>> VisibleThreads = MakeShared<TSet<FString>>();
 
-		if (!Item.IsValid() || Item->FrameData.Num() == 0 || Start == INDEX_NONE || End == INDEX_NONE)
-		{
-			if (RangeStatsCache.IsValid())
-			{
-				*RangeStatsCache = SFrameHoverWidget::FRangeStats{};
-			}
-			if (HW.IsValid())
-			{
-				HW->ClearRangeStats();
-			}
-			Window->Invalidate(EInvalidateWidget::LayoutAndVolatility);
-			return;
-		}
+	// Visible curve toggles (for Frame/Game/Draw/RHI/GPU)
+	TSharedPtr<TSet<EPerfCurve>> VisibleCurves = MakeShared<TSet<EPerfCurve>>(
+		TSet<EPerfCurve>({ EPerfCurve::Frame, EPerfCurve::Game, EPerfCurve::Draw, EPerfCurve::GPU })
+	);
 
-		int32 SIdx = Start;
-		int32 EIdx = End;
-		if (SIdx > EIdx)
-		{
-			Swap(SIdx, EIdx);
-		}
-		SIdx = FMath::Clamp(SIdx, 0, Item->FrameData.Num() - 1);
-		EIdx = FMath::Clamp(EIdx, 0, Item->FrameData.Num() - 1);
-		if (SIdx > EIdx)
-		{
-			if (RangeStatsCache.IsValid())
-			{
-				*RangeStatsCache = SFrameHoverWidget::FRangeStats{};
-			}
-			if (HW.IsValid())
-			{
-				HW->ClearRangeStats();
-			}
-			Window->Invalidate(EInvalidateWidget::LayoutAndVolatility);
-			return;
-		}
 
-		float SumMs = 0.f;
-		float MinMs = FLT_MAX;
-		float MaxMs = -FLT_MAX;
-		int32 Count = 0;
-		for (int32 i = SIdx; i <= EIdx; ++i)
-		{
-			const float Ms = Item->FrameData[i].FrameMS;
-			SumMs += Ms;
-			MinMs = FMath::Min(MinMs, Ms);
-			MaxMs = FMath::Max(MaxMs, Ms);
-			++Count;
-		}
+	//根据宏定义创建窗口
+	TSharedRef<SWindow> Window = SNew(SWindow)
+		.Title(FText::FromString(BaselineNodes->Num() > 0 ? TEXT("Performance Analyzer (vs baseline)") : TEXT("Performance Analyzer")))
+		.ClientSize(FVector2D(PT_PERFORMANCE_GRAPH_WINDOW_SIZE_X, PT_PERFORMANCE_GRAPH_WINDOW_SIZE_Y));
 
-		SFrameHoverWidget::FRangeStats Stats;
-		Stats.bHasRange = (Count > 0);
-		Stats.StartIndex = SIdx;
-		Stats.EndIndex = EIdx;
-		Stats.NumFrames = Count;
-		Stats.AvgFrameMs = Count > 0 ? (SumMs / (float)Count) : 0.f;
-		Stats.MinFrameMs = (Count > 0 && MinMs != FLT_MAX) ? MinMs : 0.f;
-		Stats.MaxFrameMs = (Count > 0 && MaxMs != -FLT_MAX) ? MaxMs : 0.f;
-		Stats.AvgFPS = Stats.AvgFrameMs > KINDA_SMALL_NUMBER ? (1000.0f / Stats.AvgFrameMs) : 0.0f;
+	// Create hover widget
+	TSharedPtr<class SFrameHoverWidget> HoverWidget;
 
-		if (RangeStatsCache.IsValid())
-		{
-			*RangeStatsCache = Stats;
-		}
-		if (HW.IsValid())
-		{
-			HW->SetRangeStats(Stats);
-		}
+	// Shared hover position in local overlay coordinates (updated by graph delegate)
+	TSharedPtr<FVector2D> HoverPos = MakeShared<FVector2D>(FVector2D::ZeroVector);
 
-		Window->Invalidate(EInvalidateWidget::LayoutAndVolatility);
-	});
+	// Shared range stats cache for hover widget
+	TSharedPtr<SFrameHoverWidget::FRangeStats> RangeStatsCache = MakeShared<SFrameHoverWidget::FRangeStats>();
 
-	if (ListItems.Num() > 0 && ListView.IsValid())
+	// Raw vs EMA-smoothed series shown in the graph. Stats always come from the raw series.
+	TSharedPtr<bool> bShowSmoothed = MakeShared<bool>(false);
+
+	auto ApplySeries = [PerformanceGraph, SelectedItem, bShowSmoothed, BaselineNodes]()
 	{
-		ListView->SetSelection(ListItems[0]);
-	}
+		TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+		if (!Item.IsValid())
+		{
+			return;
+		}
+		const bool bSmoothed = *bShowSmoothed && Item->SmoothedFrameData.Num() == Item->FrameData.Num();
+		PerformanceGraph->SetFrameData(bSmoothed ? Item->SmoothedFrameData : Item->FrameData, Item.Get());
+		PerformanceGraph->SetBaseline(BaselineNodes->FindByPredicate([&Item](const FSampledGraphData& Node) { return Node.SplineName == Item->SplineName; }));
+	};
+
 	// ===== 多曲线选择 =====
 
 	auto ApplyVisibleCurves = [PerformanceGraph, VisibleCurves]()
@@ -926,6 +281,82 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 			[
 				MakeCurveToggle(EPerfCurve::GPU, TEXT("GPU"))
 			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.Padding(24, 2, 8, 2)
+			[
+				SNew(SCheckBox)
+				.ToolTipText(FText::FromString(TEXT("Show the stat unit style EMA-smoothed series instead of raw per-frame values")))
+				.IsChecked_Lambda([bShowSmoothed]()
+				{
+					return *bShowSmoothed ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+				})
+				.OnCheckStateChanged_Lambda([bShowSmoothed, ApplySeries, PerformanceGraph](ECheckBoxState State)
+				{
+					*bShowSmoothed = State == ECheckBoxState::Checked;
+
+					// Same frames either way, keep the current zoom/pan
+					const int32 PrevViewStart = PerformanceGraph->ViewStart;
+					const int32 PrevViewCount = PerformanceGraph->ViewCount;
+					ApplySeries();
+					PerformanceGraph->ViewStart = PrevViewStart;
+					PerformanceGraph->ViewCount = PrevViewCount;
+				})
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString(TEXT("Smoothed (EMA)")))
+				]
+			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.Padding(8, 2)
+			[
+				SNew(SCheckBox)
+				.ToolTipText(FText::FromString(TEXT("Use distance travelled along the spline as the X axis (captures with recorded camera path)")))
+				.IsEnabled_Lambda([PerformanceGraph]() { return PerformanceGraph->CanShowDistance(); })
+				.IsChecked_Lambda([PerformanceGraph]()
+				{
+					return PerformanceGraph->GetXAxis() == EPerfGraphXAxis::Distance ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+				})
+				.OnCheckStateChanged_Lambda([PerformanceGraph](ECheckBoxState State)
+				{
+					PerformanceGraph->SetXAxis(State == ECheckBoxState::Checked ? EPerfGraphXAxis::Distance : EPerfGraphXAxis::Time);
+				})
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString(TEXT("X: Distance")))
+				]
+			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.Padding(8, 2)
+			[
+				SNew(SComboButton)
+				.ToolTipText(FText::FromString(TEXT("Memory column or provider metric drawn against the right axis (captures recorded with them)")))
+				.IsEnabled_Lambda([PerformanceGraph]() { return PerformanceGraph->NumSecondarySeries() > 0; })
+				.OnGetMenuContent_Lambda([PerformanceGraph]()
+				{
+					FMenuBuilder Menu(true, nullptr);
+					Menu.AddMenuEntry(FText::FromString(TEXT("None")), FText::GetEmpty(), FSlateIcon(),
+						FUIAction(FExecuteAction::CreateLambda([PerformanceGraph]() { PerformanceGraph->SetSecondarySeries(INDEX_NONE); })));
+					for (int32 Series = 0; Series < PerformanceGraph->NumSecondarySeries(); ++Series)
+					{
+						const FString Label = FString::Printf(TEXT("%s (%s)"), *PerformanceGraph->GetSecondarySeriesName(Series), *PerformanceGraph->GetSecondarySeriesUnit(Series));
+						Menu.AddMenuEntry(FText::FromString(Label), FText::GetEmpty(), FSlateIcon(),
+							FUIAction(FExecuteAction::CreateLambda([PerformanceGraph, Series]() { PerformanceGraph->SetSecondarySeries(Series); })));
+					}
+					return Menu.MakeWidget();
+				})
+				.ButtonContent()
+				[
+					SNew(STextBlock)
+					.Text_Lambda([PerformanceGraph]()
+					{
+						return FText::FromString(TEXT("Right axis: ") + (PerformanceGraph->HasSecondarySeries()
+							? PerformanceGraph->GetSecondarySeriesName(PerformanceGraph->GetSecondarySeries()) : FString(TEXT("None"))));
+					})
+				]
+			]
 		]
 
 
@@ -959,20 +390,28 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 					+ SHorizontalBox::Slot()
 					.FillWidth(1.0f)
 					[
-						SAssignNew(ListView, SListView<TSharedPtr<FSampledGraphData>>)
+						SAssignNew(ListView, SListView<TSharedPtr<const FSampledGraphData>>)
 						.ListItemsSource(&ListItems)
 						.SelectionMode(ESelectionMode::Single)
 						.OnGenerateRow_Lambda(
-							[](TSharedPtr<FSampledGraphData> Item, const TSharedRef<STableViewBase>& Owner)
+							[FindComparison, FindRepetitions](TSharedPtr<const FSampledGraphData> Item, const TSharedRef<STableViewBase>& Owner)
 							{
-								return SNew(STableRow<TSharedPtr<FSampledGraphData>>, Owner)
+								const FPTNodeComparison* Comparison = FindComparison(*Item);
+								const FPTRepeatedNodeStats* Repeated = FindRepetitions(*Item);
+								const bool bUnstable = Repeated && Repeated->bUnstable;
+								return SNew(STableRow<TSharedPtr<const FSampledGraphData>>, Owner)
 									[
-										SNew(STextBlock).Text(FText::FromString(Item->SplineName))
+										SNew(STextBlock).Text(FText::FromString((Item->SamplingMode == EPTSamplingMode::EveryFrame ? Item->SplineName
+											: FString::Printf(TEXT("%s (%s %.2fs)"), *Item->SplineName, Item->IsBucketed() ? TEXT("bucketed") : TEXT("decimated"), Item->SamplingInterval))
+											+ (Comparison && Comparison->HasRegression() ? TEXT("  [REGRESSION]") : TEXT(""))
+											+ (bUnstable ? TEXT("  [UNSTABLE]") : TEXT(""))))
+										.ColorAndOpacity(Comparison && Comparison->HasRegression() ? FSlateColor(FLinearColor(1.f, 0.35f, 0.3f))
+											: bUnstable ? FSlateColor(FLinearColor(1.f, 0.8f, 0.2f)) : FSlateColor::UseForeground())
 									];
 							}
 						)
 						.OnSelectionChanged_Lambda(
-							[PerformanceGraph, SelectedItem, VisibleThreads](TSharedPtr<FSampledGraphData> Item, ESelectInfo::Type SelectType)
+							[SelectedItem, VisibleThreads, ApplySeries](TSharedPtr<const FSampledGraphData> Item, ESelectInfo::Type SelectType)
 							{
 								if (!Item.IsValid())
 								{
@@ -980,17 +419,11 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 								}
 
 								*SelectedItem = Item;
-								PerformanceGraph->SetFrameData(Item->FrameData);
+								ApplySeries();
 
 								// When selecting an item, initialize VisibleThreads with all thread names (so legend works immediately).
 								VisibleThreads->Reset();
-								for (const FSampledFrameData& Frame : Item->FrameData)
-								{
-									for (const FThreadSample& Thread : Frame.ThreadData)
-									{
-										VisibleThreads->Add(Thread.ThreadName);
-									}
-								}
+								VisibleThreads->Append(Item->ThreadTimings.ThreadNames);
 							}
 						)
 					]
@@ -1330,7 +763,7 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 								SNew(STextBlock)
 								.Text_Lambda([SelectedItem]()
 								{
-									TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+									TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
 									return Item.IsValid() ? FText::FromString(TEXT("")) : FText::FromString(TEXT("(select a test)"));
 								})
 							]
@@ -1338,85 +771,219 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 					]
 				]
 
-				// Whole capture
+				// Whole capture frame-time percentiles
 				+ SVerticalBox::Slot()
 				.AutoHeight()
 				.Padding(0, 4, 0, 0)
 				[
 					SNew(STextBlock)
-					.Text_Lambda([SelectedItem, VisibleThreads]()
+					.Text_Lambda([SelectedItem]()
+					{
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						if (!Item.IsValid() || Item->FrameData.Num() == 0)
+						{
+							return FText::GetEmpty();
+						}
+						return FText::FromString(TEXT("Whole Capture: ") + FormatFramePercentiles(Item->StatInfo.Percentiles)
+							+ FString::Printf(TEXT("    ||    Sampler %.1f us/frame (max %.1f)"), Item->StatInfo.SamplerOverheadAvgUs, Item->StatInfo.SamplerOverheadMaxUs));
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
+
+				// Baseline comparison of the selected node (comparison mode only)
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Visibility_Lambda([Comparisons]() { return Comparisons->Num() > 0 ? EVisibility::Visible : EVisibility::Collapsed; })
+					.Text_Lambda([SelectedItem, FindComparison]()
 					{
-						TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
 						if (!Item.IsValid())
 						{
-							return FText::FromString(TEXT("Whole Capture: No selection"));
+							return FText::GetEmpty();
 						}
-						if (Item->FrameData.Num() == 0)
+						const FPTNodeComparison* Comparison = FindComparison(*Item);
+						return Comparison ? FText::FromString(TEXT("vs Baseline: ") + FPTCaptureComparison::FormatNodeComparison(*Comparison))
+							: FText::FromString(TEXT("vs Baseline: no node with this name in the baseline"));
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
+
+				// Statistics over all passes of a repeated run
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Visibility_Lambda([RepeatedNodes]() { return RepeatedNodes->Num() > 0 ? EVisibility::Visible : EVisibility::Collapsed; })
+					.Text_Lambda([SelectedItem, FindRepetitions]()
+					{
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						const FPTRepeatedNodeStats* Repeated = Item.IsValid() ? FindRepetitions(*Item) : nullptr;
+						return Repeated ? FText::FromString(TEXT("Repeated (95% CI): ") + FPTRepetitionStats::FormatNode(*Repeated)) : FText::GetEmpty();
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
+
+				// Memory range and growth over the node, per column
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Text_Lambda([SelectedItem, MemoryText = MakeShared<TPair<const FSampledGraphData*, FText>>(nullptr, FText::GetEmpty())]()
+					{
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						if (!Item.IsValid() || !Item->HasMemoryData())
 						{
-							return FText::FromString(TEXT("Whole Capture: No FrameData"));
+							return FText::GetEmpty();
+						}
+						// Walks every column, so only when the selection changes
+						if (MemoryText->Key != Item.Get())
+						{
+							TArray<FString> Parts;
+							for (const FPTMemorySummary& Summary : FPTMemorySummary::Summarize(Item->MemoryColumns))
+							{
+								Parts.Add(Summary.ToString());
+							}
+							*MemoryText = { Item.Get(), FText::FromString(TEXT("Memory: ") + FString::Join(Parts, TEXT(" | "))) };
 						}
+						return MemoryText->Value;
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
 
-						struct FAcc { double Sum = 0.0; int32 Count = 0; float Min = 0.f; float Max = 0.f; bool bInit = false; };
-						TMap<FString, FAcc> Acc;
-						for (const FSampledFrameData& F : Item->FrameData)
+				// Provider metrics (draw calls, agents, ...) over the node
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Text_Lambda([SelectedItem, MetricText = MakeShared<TPair<const FSampledGraphData*, FText>>(nullptr, FText::GetEmpty())]()
+					{
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						if (!Item.IsValid() || !Item->HasMetricData())
+						{
+							return FText::GetEmpty();
+						}
+						if (MetricText->Key != Item.Get())
 						{
-							for (const FThreadSample& T : F.ThreadData)
+							TArray<FString> Parts;
+							for (const FPTMetricSummary& Summary : FPTMetricSummary::Summarize(Item->MetricColumns, Item->MetricUnits, Item->IsBucketed() ? TConstArrayView<int32>(Item->BucketFrameCounts) : TConstArrayView<int32>()))
 							{
-								if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(T.ThreadName))
-								{
-									continue;
-								}
-								FAcc& A = Acc.FindOrAdd(T.ThreadName);
-								A.Sum += (double)T.TimeMs;
-								A.Count += 1;
-								if (!A.bInit)
-								{
-									A.Min = T.TimeMs;
-									A.Max = T.TimeMs;
-									A.bInit = true;
-								}
-								else
-								{
-									A.Min = FMath::Min(A.Min, T.TimeMs);
-									A.Max = FMath::Max(A.Max, T.TimeMs);
-								}
+								Parts.Add(Summary.ToString());
 							}
+							*MetricText = { Item.Get(), FText::FromString(TEXT("Metrics: ") + FString::Join(Parts, TEXT(" | "))) };
+						}
+						return MetricText->Value;
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
+
+				// CSV profile / trace recorded with the node, to open in CSVToSVG or Unreal Insights
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Text_Lambda([SelectedItem]()
+					{
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						if (!Item.IsValid() || (Item->CsvProfilePath.IsEmpty() && Item->TracePath.IsEmpty()))
+						{
+							return FText::GetEmpty();
 						}
-						if (Acc.Num() == 0)
+						FString Profiles = TEXT("Profiles:");
+						if (!Item->CsvProfilePath.IsEmpty())
 						{
-							return FText::FromString(TEXT("Whole Capture: No ThreadData recorded (or filtered out)"));
+							Profiles += TEXT(" CSV ") + Item->CsvProfilePath;
+						}
+						if (!Item->TracePath.IsEmpty())
+						{
+							Profiles += TEXT(" | Trace ") + Item->TracePath;
+						}
+						return FText::FromString(Profiles);
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
+
+				// Whole capture hitch summary (markers are drawn on the graph)
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Text_Lambda([SelectedItem]()
+					{
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						if (!Item.IsValid() || Item->FrameData.Num() == 0)
+						{
+							return FText::GetEmpty();
 						}
+						return FText::FromString(FormatHitchReport(Item->Hitches));
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
 
-						TArray<TPair<FString, FAcc>> Pairs;
-						for (const TPair<FString, FAcc>& KV : Acc)
+				// Whole capture
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Text_Lambda([SelectedItem, VisibleThreads]()
+					{
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						if (!Item.IsValid())
 						{
-							Pairs.Add(KV);
+							return FText::FromString(TEXT("Whole Capture: No selection"));
 						}
-						Pairs.Sort([](const TPair<FString, FAcc>& A, const TPair<FString, FAcc>& B)
+						if (Item->FrameData.Num() == 0)
 						{
-							const double AvgA = A.Value.Count > 0 ? A.Value.Sum / (double)A.Value.Count : 0.0;
-							const double AvgB = B.Value.Count > 0 ? B.Value.Sum / (double)B.Value.Count : 0.0;
-							return AvgA > AvgB;
-						});
+							return FText::FromString(TEXT("Whole Capture: No FrameData"));
+						}
 
-						FString Out(TEXT("Whole Capture: "));
-						for (int32 i = 0; i < Pairs.Num(); ++i)
+						const FString ThreadStats = FormatThreadRangeStats(Item->ThreadTimings, 0, Item->ThreadTimings.NumFrames - 1, VisibleThreads.Get());
+						if (ThreadStats.IsEmpty())
 						{
-							const FString& Name = Pairs[i].Key;
-							const FAcc& A = Pairs[i].Value;
-							const float Avg = A.Count > 0 ? (float)(A.Sum / (double)A.Count) : 0.f;
-							Out += FString::Printf(TEXT("%s Avg %.2f | Min %.2f | Max %.2f"), *Name, Avg, A.Min, A.Max);
-							if (i != Pairs.Num() - 1)
-							{
-								Out += TEXT("    ||    ");
-							}
+							return FText::FromString(TEXT("Whole Capture: No ThreadData recorded (or filtered out)"));
 						}
+
+						const FString Out = FString(TEXT("Whole Capture: ")) + ThreadStats;
 						return FText::FromString(Out);
 					})
 					.AutoWrapText(true)
 					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
 				]
 
+				// Range frame-time percentiles (computed once per selection change)
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0, 4, 0, 0)
+				[
+					SNew(STextBlock)
+					.Text_Lambda([RangeStatsCache]()
+					{
+						if (!RangeStatsCache.IsValid() || !RangeStatsCache->bHasRange)
+						{
+							return FText::GetEmpty();
+						}
+						return FText::FromString(FString::Printf(TEXT("Range [%d..%d]: "), RangeStatsCache->StartIndex, RangeStatsCache->EndIndex)
+							+ FormatFramePercentiles(RangeStatsCache->Percentiles));
+					})
+					.AutoWrapText(true)
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+				]
+
 				// Range stats (filtered)
 				+ SVerticalBox::Slot()
 				.AutoHeight()
@@ -1425,7 +992,7 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 					SNew(STextBlock)
 					.Text_Lambda([SelectedItem, RangeStartIndex, RangeEndIndex, VisibleThreads]()
 					{
-						TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+						TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
 						if (!Item.IsValid())
 						{
 							return FText::FromString(TEXT("Range: No selection"));
@@ -1453,63 +1020,13 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 							return FText::FromString(TEXT("Range: invalid"));
 						}
 
-						struct FAcc { double Sum = 0.0; int32 Count = 0; float Min = 0.f; float Max = 0.f; bool bInit = false; };
-						TMap<FString, FAcc> Acc;
-						for (int32 i = SIdx; i <= EIdx; ++i)
-						{
-							const FSampledFrameData& F = Item->FrameData[i];
-							for (const FThreadSample& T : F.ThreadData)
-							{
-								if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(T.ThreadName))
-								{
-									continue;
-								}
-								FAcc& A = Acc.FindOrAdd(T.ThreadName);
-								A.Sum += (double)T.TimeMs;
-								A.Count += 1;
-								if (!A.bInit)
-								{
-									A.Min = T.TimeMs;
-									A.Max = T.TimeMs;
-									A.bInit = true;
-								}
-								else
-								{
-									A.Min = FMath::Min(A.Min, T.TimeMs);
-									A.Max = FMath::Max(A.Max, T.TimeMs);
-								}
-							}
-						}
-
-						if (Acc.Num() == 0)
+						const FString ThreadStats = FormatThreadRangeStats(Item->ThreadTimings, SIdx, EIdx, VisibleThreads.Get());
+						if (ThreadStats.IsEmpty())
 						{
 							return FText::FromString(FString::Printf(TEXT("Range [%d..%d]: No ThreadData"), SIdx, EIdx));
 						}
 
-						TArray<TPair<FString, FAcc>> Pairs;
-						for (const TPair<FString, FAcc>& KV : Acc)
-						{
-							Pairs.Add(KV);
-						}
-						Pairs.Sort([](const TPair<FString, FAcc>& A, const TPair<FString, FAcc>& B)
-						{
-							const double AvgA = A.Value.Count > 0 ? A.Value.Sum / (double)A.Value.Count : 0.0;
-							const double AvgB = B.Value.Count > 0 ? B.Value.Sum / (double)B.Value.Count : 0.0;
-							return AvgA > AvgB;
-						});
-
-						FString Out = FString::Printf(TEXT("Range [%d..%d]: "), SIdx, EIdx);
-						for (int32 i = 0; i < Pairs.Num(); ++i)
-						{
-							const FString& Name = Pairs[i].Key;
-							const FAcc& A = Pairs[i].Value;
-							const float Avg = A.Count > 0 ? (float)(A.Sum / (double)A.Count) : 0.f;
-							Out += FString::Printf(TEXT("%s Avg %.2f | Min %.2f | Max %.2f"), *Name, Avg, A.Min, A.Max);
-							if (i != Pairs.Num() - 1)
-							{
-								Out += TEXT("    ||    ");
-							}
-						}
+						const FString Out = FString::Printf(TEXT("Range [%d..%d]: "), SIdx, EIdx) + ThreadStats;
 						return FText::FromString(Out);
 					})
 					.AutoWrapText(true)
@@ -1525,7 +1042,7 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 		TWeakPtr<SFrameHoverWidget> WeakHover = HoverWidget;
 		TWeakPtr<SPerformanceGraph> WeakGraph = PerformanceGraph;
 		TSharedPtr<FVector2D> LocalHoverPos = HoverPos;
-		PerformanceGraph->OnHoverSampleChanged.BindLambda([WeakHover, WeakGraph, LocalHoverPos, VisibleThreads, RangeStatsCache](int32 Index, FVector2D Local)
+		PerformanceGraph->OnHoverSampleChanged.BindLambda([WeakHover, WeakGraph, LocalHoverPos, VisibleThreads, RangeStatsCache, SelectedItem](int32 Index, FVector2D Local)
 		{
 			TSharedPtr<SFrameHoverWidget> HW = WeakHover.Pin();
 			TSharedPtr<SPerformanceGraph> PG = WeakGraph.Pin();
@@ -1553,12 +1070,14 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 			{
 				if (PG->SampledFrameData.IsValidIndex(Index))
 				{
-					HW->SetFrameData(&PG->SampledFrameData[Index], Index);
+					TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+					const FSampledFrameData Frame = PG->SampledFrameData.GetFrame(Index);
+					HW->SetFrameData(&Frame, Item.IsValid() ? &Item->ThreadTimings : nullptr, Index);
 					HW->SetVisibility(EVisibility::Visible);
 				}
 				else
 				{
-					HW->SetFrameData(nullptr, INDEX_NONE);
+					HW->SetFrameData(nullptr, nullptr, INDEX_NONE);
 					HW->SetVisibility(EVisibility::Collapsed);
 				}
 			}
@@ -1604,7 +1123,7 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 		*RangeEndIndex = End;
 
 		// compute and push range stats to hover widget
-		TSharedPtr<FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
+		TSharedPtr<const FSampledGraphData> Item = SelectedItem.IsValid() ? *SelectedItem : nullptr;
 		TSharedPtr<SFrameHoverWidget> HW = WeakHover.Pin();
 
 		if (!Item.IsValid() || Item->FrameData.Num() == 0 || Start == INDEX_NONE || End == INDEX_NONE)
@@ -1643,28 +1162,41 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 			return;
 		}
 
-		float SumMs = 0.f;
-		float MinMs = FLT_MAX;
-		float MaxMs = -FLT_MAX;
-		int32 Count = 0;
-		for (int32 i = SIdx; i <= EIdx; ++i)
-		{
-			const float Ms = Item->FrameData[i].FrameMS;
-			SumMs += Ms;
-			MinMs = FMath::Min(MinMs, Ms);
-			MaxMs = FMath::Max(MaxMs, Ms);
-			++Count;
-		}
+		FPTStatAccumulator FrameAcc;
+		const TConstArrayView<float> FrameColumn = Item->FrameData.GetCurve((int32)EPerfCurve::Frame);
+		FrameAcc.AddColumn(FrameColumn.Slice(SIdx, EIdx - SIdx + 1));
 
 		SFrameHoverWidget::FRangeStats Stats;
-		Stats.bHasRange = (Count > 0);
+		Stats.bHasRange = !FrameAcc.IsEmpty();
 		Stats.StartIndex = SIdx;
 		Stats.EndIndex = EIdx;
-		Stats.NumFrames = Count;
-		Stats.AvgFrameMs = Count > 0 ? (SumMs / (float)Count) : 0.f;
-		Stats.MinFrameMs = (Count > 0 && MinMs != FLT_MAX) ? MinMs : 0.f;
-		Stats.MaxFrameMs = (Count > 0 && MaxMs != -FLT_MAX) ? MaxMs : 0.f;
+		Stats.NumFrames = (int32)FrameAcc.Count;
+		Stats.AvgFrameMs = (float)FrameAcc.Mean;
+		Stats.MinFrameMs = FrameAcc.GetMin();
+		Stats.MaxFrameMs = FrameAcc.GetMax();
+		Stats.StdDevFrameMs = (float)FrameAcc.GetStdDev();
+
+		if (Item->IsBucketed())
+		{
+			// Each sample is a bucket mean: weight by its frame count and take the real extremes from the bounds.
+			// StdDev and percentiles stay over bucket means, so they are flagged approximate.
+			const int32 Count = EIdx - SIdx + 1;
+			Stats.MinFrameMs = FMath::Min(Stats.MinFrameMs, FPTColumnKernels::MinMax(Item->BucketMin.GetCurve((int32)EPerfCurve::Frame).Slice(SIdx, Count)).Min);
+			Stats.MaxFrameMs = FMath::Max(Stats.MaxFrameMs, FPTColumnKernels::MinMax(Item->BucketMax.GetCurve((int32)EPerfCurve::Frame).Slice(SIdx, Count)).Max);
+			double WeightedSum = 0.0;
+			int64 Frames = 0;
+			for (int32 i = SIdx; i <= EIdx; ++i)
+			{
+				WeightedSum += (double)FrameColumn[i] * Item->BucketFrameCounts[i];
+				Frames += Item->BucketFrameCounts[i];
+			}
+			Stats.NumFrames = (int32)Frames;
+			Stats.AvgFrameMs = Frames > 0 ? (float)(WeightedSum / Frames) : 0.f;
+		}
+
 		Stats.AvgFPS = Stats.AvgFrameMs > KINDA_SMALL_NUMBER ? (1000.0f / Stats.AvgFrameMs) : 0.0f;
+		Stats.Percentiles = FPTPercentileEngine::ComputeFramePercentiles(Item->FrameData, SIdx, EIdx - SIdx + 1);
+		Stats.Percentiles.bExact &= Item->SamplingMode == EPTSamplingMode::EveryFrame;
 
 		if (RangeStatsCache.IsValid())
 		{
@@ -1719,3 +1251,27 @@ inline void OpenPerformanceAnalyzerWindow(TArray<FSampledGraphData> Sample)
 	FSlateApplication::Get().AddWindow(Window);
 }
 
+// Reopen a saved .ptcap capture. Columns stay memory-mapped, nothing is parsed back into per-frame structs.
+inline bool OpenPerformanceAnalyzerWindowFromFile(const FString& Filename)
+{
+	TArray<FSampledGraphData> Nodes;
+	if (!FPTCaptureFile::Open(Filename, Nodes))
+	{
+		return false;
+	}
+	OpenPerformanceAnalyzerWindow(MakeShared<const TArray<FSampledGraphData>>(MoveTemp(Nodes)));
+	return true;
+}
+
+// Comparison mode over two saved captures
+inline bool OpenCaptureComparisonFromFiles(const FString& BaselineFile, const FString& CandidateFile)
+{
+	TArray<FSampledGraphData> BaselineNodes;
+	TArray<FSampledGraphData> CandidateNodes;
+	if (!FPTCaptureFile::Open(BaselineFile, BaselineNodes) || !FPTCaptureFile::Open(CandidateFile, CandidateNodes))
+	{
+		return false;
+	}
+	OpenPerformanceAnalyzerWindow(MakeShared<const TArray<FSampledGraphData>>(MoveTemp(CandidateNodes)), MoveTemp(BaselineNodes));
+	return true;
+}
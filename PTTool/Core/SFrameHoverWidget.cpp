@@ -28,9 +28,10 @@ void SFrameHoverWidget::Construct(const FArguments& InArgs)
 	];
 }
 
-void SFrameHoverWidget::SetFrameData(const FSampledFrameData* InData, int32 InIndex)
+void SFrameHoverWidget::SetFrameData(const FSampledFrameData* InData, const FPTThreadTimingStore* InThreads, int32 InIndex)
 {
-	CurrentData = InData;
+	CurrentData = InData ? TOptional<FSampledFrameData>(*InData) : TOptional<FSampledFrameData>();
+	CurrentThreads = InThreads;
 	CurrentIndex = InIndex;
 	RebuildContents();
 }
@@ -42,7 +43,7 @@ void SFrameHoverWidget::RebuildContents()
 
 	ScrollBox->ClearChildren();
 
-	if (!CurrentData)
+	if (!CurrentData.IsSet())
 	{
 		ScrollBox->AddSlot()
 		[
@@ -52,21 +53,24 @@ void SFrameHoverWidget::RebuildContents()
 		return;
 	}
 
+	// Per-thread row for this frame is only available when the store covers CurrentIndex
+	const bool bHasThreads = CurrentThreads && CurrentIndex >= 0 && CurrentIndex < CurrentThreads->NumFrames && CurrentThreads->NumThreads() > 0;
+
 	// Identify bottleneck thread (max TimeMs). If thread data is missing/empty, no highlighting.
 	int32 BottleneckThreadIndex = INDEX_NONE;
 	float BottleneckTimeMs = -FLT_MAX;
-	if (CurrentData->ThreadData.Num() > 0)
+	if (bHasThreads)
 	{
-		for (int32 i = 0; i < CurrentData->ThreadData.Num(); ++i)
+		for (int32 i = 0; i < CurrentThreads->NumThreads(); ++i)
 		{
-			const FThreadSample& T = CurrentData->ThreadData[i];
-			if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(T.ThreadName))
+			if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(CurrentThreads->ThreadNames[i]))
 			{
 				continue;
 			}
-			if (T.TimeMs > BottleneckTimeMs)
+			const float TimeMs = CurrentThreads->GetTime(i, CurrentIndex);
+			if (TimeMs > BottleneckTimeMs)
 			{
-				BottleneckTimeMs = T.TimeMs;
+				BottleneckTimeMs = TimeMs;
 				BottleneckThreadIndex = i;
 			}
 		}
@@ -101,11 +105,24 @@ void SFrameHoverWidget::RebuildContents()
 		[
 			SNew(STextBlock)
 			.Text(FText::FromString(FString::Printf(
-				TEXT("AvgFPS %.1f | Avg %.2f ms | Min %.2f ms | Max %.2f ms"),
+				TEXT("AvgFPS %.1f | Avg %.2f ms | Min %.2f ms | Max %.2f ms | StdDev %.2f ms"),
 				RangeStats.AvgFPS,
 				RangeStats.AvgFrameMs,
 				RangeStats.MinFrameMs,
-				RangeStats.MaxFrameMs)))
+				RangeStats.MaxFrameMs,
+				RangeStats.StdDevFrameMs)))
+			.Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
+		];
+
+		ScrollBox->AddSlot().Padding(2)
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString(FString::Printf(
+				TEXT("P50 %.2f | P95 %.2f | P99 %.2f ms | 1%% Low %.1f FPS"),
+				RangeStats.Percentiles.P50.FrameMS,
+				RangeStats.Percentiles.P95.FrameMS,
+				RangeStats.Percentiles.P99.FrameMS,
+				RangeStats.Percentiles.OnePercentLowFPS)))
 			.Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
 		];
 
@@ -148,20 +165,21 @@ void SFrameHoverWidget::RebuildContents()
 	AddRow(TEXT("GPU"), CurrentData->GPUMS);
 
 	// Per-thread breakdown
-	if (CurrentData->ThreadData.Num() > 0)
+	if (bHasThreads)
 	{
 		ScrollBox->AddSlot().Padding(4)
 		[
 			SNew(STextBlock).Text(FText::FromString(TEXT("Threads:"))).Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
 		];
 
-		for (int32 i = 0; i < CurrentData->ThreadData.Num(); ++i)
+		for (int32 i = 0; i < CurrentThreads->NumThreads(); ++i)
 		{
-			const FThreadSample& T = CurrentData->ThreadData[i];
-			if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(T.ThreadName))
+			const FString& ThreadName = CurrentThreads->ThreadNames[i];
+			if (VisibleThreads.IsValid() && VisibleThreads->Num() > 0 && !VisibleThreads->Contains(ThreadName))
 			{
 				continue;
 			}
+			const float TimeMs = CurrentThreads->GetTime(i, CurrentIndex);
 
 			const bool bIsBottleneck = (i == BottleneckThreadIndex);
 
@@ -178,16 +196,16 @@ void SFrameHoverWidget::RebuildContents()
 				+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
 				[
 					SNew(STextBlock)
-					.Text(FText::FromString(T.ThreadName))
+					.Text(FText::FromString(ThreadName))
 					.ColorAndOpacity(RowColor)
 					.Font(RowFont)
 					.MinDesiredWidth(120)
-					.ToolTipText(FText::FromString(T.ThreadName))
+					.ToolTipText(FText::FromString(ThreadName))
 				]
 				+ SHorizontalBox::Slot().HAlign(HAlign_Right).VAlign(VAlign_Center)
 				[
 					SNew(STextBlock)
-					.Text(FText::FromString(FString::Printf(TEXT("%.2f ms"), T.TimeMs)))
+					.Text(FText::FromString(FString::Printf(TEXT("%.2f ms"), TimeMs)))
 					.ColorAndOpacity(RowColor)
 					.Font(RowFont)
 				]
@@ -12,8 +12,9 @@ public:
 
 	void Construct(const FArguments& InArgs);
 
-	// Update the widget to show a particular sampled frame (pointer may be null to clear)
-	void SetFrameData(const FSampledFrameData* InData, int32 InIndex = INDEX_NONE);
+	// Update the widget to show a particular sampled frame (pointer may be null to clear). The frame is copied.
+	// InThreads is the capture's per-thread store; InIndex selects the frame row in it.
+	void SetFrameData(const FSampledFrameData* InData, const FPTThreadTimingStore* InThreads, int32 InIndex = INDEX_NONE);
 
 	// Optional: filter which thread rows are shown. When nullptr or empty, shows all.
 	void SetVisibleThreadFilter(const TSharedPtr<const TSet<FString>>& InVisibleThreads)
@@ -32,7 +33,10 @@ public:
 		float AvgFrameMs = 0.f;
 		float MinFrameMs = 0.f;
 		float MaxFrameMs = 0.f;
+		float StdDevFrameMs = 0.f;
 		float AvgFPS = 0.f;
+
+		FPTFramePercentiles Percentiles;
 	};
 
 	void SetRangeStats(const FRangeStats& InStats)
@@ -48,7 +52,8 @@ public:
 	}
 
 private:
-	const FSampledFrameData* CurrentData = nullptr;
+	TOptional<FSampledFrameData> CurrentData;
+	const FPTThreadTimingStore* CurrentThreads = nullptr;
 	int32 CurrentIndex = INDEX_NONE;
 
 	TSharedPtr<class SScrollBox> ScrollBox;
@@ -14,12 +14,20 @@
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "AssetRegistry/IAssetRegistry.h"
 #include "PTTool/Core/PTGameMode.h"
+#include "PTTool/Core/PerformanceWindow.h"
+#include "PTTool/Core/PTCaptureFile.h"
+#include "PTTool/Core/PTSplineHeatmap.h"
+
+// File dialog for reopening captures
+#include "DesktopPlatformModule.h"
+#include "IDesktopPlatform.h"
 
 // For undo/redo transactions when editing/deleting actors
 #include "ScopedTransaction.h"
 
 // Slate
 #include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SSpinBox.h"
 #include "Widgets/Images/SImage.h"
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Layout/SSpacer.h"
@@ -28,7 +36,11 @@
 #include "Editor.h"
 
 #define LOCTEXT_NAMESPACE "PTToolEditorModeToolkit"
-void ExecuteTest();
+void ExecuteTest(int32 Repetitions);
+void OpenCapture();
+void CompareCaptures();
+void BakeHeatmap(int32 Curve, EPTHeatmapStat Stat);
+void ClearHeatmaps();
 class FAssetRegistryModule;
 
 namespace
@@ -102,7 +114,18 @@ namespace
 				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, PreTestCommand) ||
 				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, PostTestCommand) ||
 				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, TimeScaling) ||
-				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, bRecordPerformance));
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, bFixedTimestep) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, FixedFrameRate) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, WarmupFrames) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, bRecordPerformance) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, bRecordFPS) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, bRecordThreadTimes) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, bRecordMemory) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, SamplingMode) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, SamplingInterval) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, HitchSettings) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, bUseIndividualFile) ||
+				Name == GET_MEMBER_NAME_CHECKED(APTSplinePathActor, SavePath));
 		}));
 
 		In->ManageActorDetailsView->SetObject(nullptr);
@@ -618,19 +641,70 @@ void FPTToolEditorModeToolkit::Init(const TSharedPtr<IToolkitHost>& InitToolkitH
 
 				// Test 面板
 				+ SVerticalBox::Slot().AutoHeight().Padding(4)
+				[
+					SNew(SHorizontalBox)
+					.Visibility_Lambda([this]() { return SelectedTab == EPTToolTab::Test ? EVisibility::Visible : EVisibility::Collapsed; })
+					+ SHorizontalBox::Slot().FillWidth(1.f)
+					[
+						SNew(SButton)
+						.Text(FText::FromString("Start Test"))
+						.OnClicked_Lambda([this]()
+						{
+							UE_LOG(LogTemp, Log, TEXT("Test button clicked."));
+
+							ExecuteTest(TestRepetitions);
+
+							return FReply::Handled();
+						})
+					]
+					+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center).Padding(6, 0, 2, 0)
+					[
+						SNew(STextBlock)
+						.Text(FText::FromString("Passes"))
+					]
+					+ SHorizontalBox::Slot().AutoWidth()
+					[
+						SNew(SBox)
+						.MinDesiredWidth(50.f)
+						[
+							SNew(SSpinBox<int32>)
+							.ToolTipText(FText::FromString("Runs of the whole test plan; more than one reports mean, CV and confidence interval per node"))
+							.MinValue(1)
+							.MaxValue(100)
+							.Value_Lambda([this]() { return TestRepetitions; })
+							.OnValueChanged_Lambda([this](int32 Value) { TestRepetitions = Value; })
+						]
+					]
+				]
+				+ SVerticalBox::Slot().AutoHeight().Padding(4)
 				[
 					SNew(SButton)
 					.Visibility_Lambda([this]() { return SelectedTab == EPTToolTab::Test ? EVisibility::Visible : EVisibility::Collapsed; })
-					.Text(FText::FromString("Start Test"))
+					.Text(FText::FromString("Open Capture..."))
 					.OnClicked_Lambda([this]()
 					{
-						UE_LOG(LogTemp, Log, TEXT("Test button clicked."));
+						OpenCapture();
 
-						ExecuteTest();
+						return FReply::Handled();
+					})
+				]
+				+ SVerticalBox::Slot().AutoHeight().Padding(4)
+				[
+					SNew(SButton)
+					.Visibility_Lambda([this]() { return SelectedTab == EPTToolTab::Test ? EVisibility::Visible : EVisibility::Collapsed; })
+					.Text(FText::FromString("Compare Captures..."))
+					.ToolTipText(FText::FromString("Pick a baseline capture, then a candidate capture"))
+					.OnClicked_Lambda([this]()
+					{
+						CompareCaptures();
 
 						return FReply::Handled();
 					})
 				]
+				+ SVerticalBox::Slot().AutoHeight().Padding(4)
+				[
+					MakeHeatmapRow()
+				]
 			]
 		];
 
@@ -922,7 +996,7 @@ FString GetCurrentMapAssetPath()
 	}
 	return TEXT("");  // 出错时返回空字符串
 }
-void ExecuteTest()
+void ExecuteTest(int32 Repetitions)
 {
 	// 获取项目路径（.uproject）
 	FString ProjectPath = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
@@ -944,6 +1018,10 @@ void ExecuteTest()
 		*ProjectPath,
 		*MapAssetPath
 	);
+	if (Repetitions > 1)
+	{
+		Params += FString::Printf(TEXT(" -PTToolRepeat=%d"), Repetitions);
+	}
 
 	// 查找 UnrealEditor.exe（或 UnrealEditor-Win64-Debug.exe 视你的配置而定）
 	FString EditorExe = FPlatformProcess::GenerateApplicationPath(TEXT("UnrealEditor"), FApp::GetBuildConfiguration());
@@ -971,6 +1049,166 @@ void ExecuteTest()
 	}
 }
 
+// .ptcap file dialog, false when cancelled
+static bool PickCaptureFile(const TCHAR* Title, FString& OutFile)
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (!DesktopPlatform)
+	{
+		return false;
+	}
+
+	const FString DefaultDir = FPaths::Combine(FPaths::ProjectSavedDir(), PTTOOL_CAPTURE_SAVE_SUBDIR);
+	const FString FileTypes = FString::Printf(TEXT("PTTool Capture (*%s)|*%s"), PTTOOL_CAPTURE_FILE_EXTENSION, PTTOOL_CAPTURE_FILE_EXTENSION);
+
+	TArray<FString> Files;
+	const bool bOpened = DesktopPlatform->OpenFileDialog(
+		FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+		Title,
+		DefaultDir,
+		TEXT(""),
+		FileTypes,
+		EFileDialogFlags::None,
+		Files
+	);
+
+	if (bOpened && Files.Num() > 0)
+	{
+		OutFile = FPaths::ConvertRelativePathToFull(Files[0]);
+		return true;
+	}
+	return false;
+}
+
+void OpenCapture()
+{
+	FString File;
+	if (PickCaptureFile(TEXT("Open PTTool Capture"), File))
+	{
+		OpenPerformanceAnalyzerWindowFromFile(File);
+	}
+}
+
+void CompareCaptures()
+{
+	FString BaselineFile;
+	FString CandidateFile;
+	if (PickCaptureFile(TEXT("Baseline PTTool Capture"), BaselineFile) && PickCaptureFile(TEXT("Candidate PTTool Capture"), CandidateFile))
+	{
+		OpenCaptureComparisonFromFiles(BaselineFile, CandidateFile);
+	}
+}
+
+// Colors every spline of the capture in the editor viewport by the cost of Curve along its path
+void BakeHeatmap(int32 Curve, EPTHeatmapStat Stat)
+{
+	UWorld* World = GEditor ? GEditor->GetEditorWorldContext().World() : nullptr;
+	FString File;
+	if (!World || !PickCaptureFile(TEXT("Bake PTTool Capture Heatmap"), File))
+	{
+		return;
+	}
+
+	TArray<FSampledGraphData> Nodes;
+	FString Error;
+	if (!FPTCaptureFile::Open(File, Nodes, &Error))
+	{
+		UE_LOG(LogTemp, Error, TEXT("PTTool heatmap: cannot open %s: %s"), *File, *Error);
+		return;
+	}
+
+	constexpr float BinLengthCm = 100.f;
+	int32 NumBaked = 0;
+	for (TActorIterator<APTSplinePathActor> It(World); It; ++It)
+	{
+		APTSplinePathActor* Actor = *It;
+		const FSampledGraphData* Node = Nodes.FindByPredicate([Actor](const FSampledGraphData& N) { return N.SplineName == Actor->GetName(); });
+		if (!Node || !Actor->SplineComponent)
+		{
+			continue;
+		}
+
+		const float SplineLength = Actor->SplineComponent->GetSplineLength();
+		FPTSplineHeatmap Heatmap;
+		if (!Heatmap.Build(*Node, Curve, Stat, SplineLength, FMath::Clamp(FMath::CeilToInt(SplineLength / BinLengthCm), 1, 4096)))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("PTTool heatmap: %s has no camera path in this capture"), *Node->SplineName);
+			continue;
+		}
+		Actor->SplineComponent->ShowHeatmap(Heatmap);
+		UE_LOG(LogTemp, Log, TEXT("PTTool heatmap: %s %d bins, %.2f - %.2f ms"), *Node->SplineName, Heatmap.Num(), Heatmap.MinValue, Heatmap.MaxValue);
+		++NumBaked;
+	}
+	UE_LOG(LogTemp, Log, TEXT("PTTool heatmap: baked %d of %d nodes from %s"), NumBaked, Nodes.Num(), *FPaths::GetCleanFilename(File));
+}
+
+void ClearHeatmaps()
+{
+	UWorld* World = GEditor ? GEditor->GetEditorWorldContext().World() : nullptr;
+	for (TActorIterator<APTSplinePathActor> It(World); World && It; ++It)
+	{
+		if (It->SplineComponent)
+		{
+			It->SplineComponent->ClearHeatmap();
+		}
+	}
+}
+
+TSharedRef<SWidget> FPTToolEditorModeToolkit::MakeHeatmapRow()
+{
+	static const TCHAR* CurveNames[] = { TEXT("Frame"), TEXT("Game"), TEXT("Draw"), TEXT("RHI"), TEXT("GPU") };
+
+	return SNew(SHorizontalBox)
+		.Visibility_Lambda([this]() { return SelectedTab == EPTToolTab::Test ? EVisibility::Visible : EVisibility::Collapsed; })
+		+ SHorizontalBox::Slot().FillWidth(1.f)
+		[
+			SNew(SButton)
+			.Text(FText::FromString("Bake Heatmap..."))
+			.ToolTipText(FText::FromString("Pick a capture and color its splines in the viewport by cost along the path"))
+			.OnClicked_Lambda([this]()
+			{
+				BakeHeatmap(HeatmapCurve, HeatmapStat);
+
+				return FReply::Handled();
+			})
+		]
+		+ SHorizontalBox::Slot().AutoWidth().Padding(2, 0)
+		[
+			SNew(SButton)
+			.ToolTipText(FText::FromString("Curve used for the heatmap (click to cycle)"))
+			.Text_Lambda([this]() { return FText::FromString(CurveNames[HeatmapCurve]); })
+			.OnClicked_Lambda([this]()
+			{
+				HeatmapCurve = (HeatmapCurve + 1) % UE_ARRAY_COUNT(CurveNames);
+
+				return FReply::Handled();
+			})
+		]
+		+ SHorizontalBox::Slot().AutoWidth().Padding(2, 0)
+		[
+			SNew(SButton)
+			.ToolTipText(FText::FromString("Average or P95 of the samples in each slice of the path"))
+			.Text_Lambda([this]() { return FText::FromString(HeatmapStat == EPTHeatmapStat::P95 ? TEXT("P95") : TEXT("Avg")); })
+			.OnClicked_Lambda([this]()
+			{
+				HeatmapStat = HeatmapStat == EPTHeatmapStat::P95 ? EPTHeatmapStat::Average : EPTHeatmapStat::P95;
+
+				return FReply::Handled();
+			})
+		]
+		+ SHorizontalBox::Slot().AutoWidth()
+		[
+			SNew(SButton)
+			.Text(FText::FromString("Clear"))
+			.OnClicked_Lambda([]()
+			{
+				ClearHeatmaps();
+
+				return FReply::Handled();
+			})
+		];
+}
+
 // ------------------------------------------------------------
 // Manage list actions
 // ------------------------------------------------------------
@@ -1430,19 +1668,70 @@ TSharedRef<SWidget> FPTToolEditorModeToolkit::BuildStandaloneWidget()
 
 				// Test 面板
 				+ SVerticalBox::Slot().AutoHeight().Padding(4)
+				[
+					SNew(SHorizontalBox)
+					.Visibility_Lambda([this]() { return SelectedTab == EPTToolTab::Test ? EVisibility::Visible : EVisibility::Collapsed; })
+					+ SHorizontalBox::Slot().FillWidth(1.f)
+					[
+						SNew(SButton)
+						.Text(FText::FromString("Start Test"))
+						.OnClicked_Lambda([this]()
+						{
+							UE_LOG(LogTemp, Log, TEXT("Test button clicked."));
+
+							ExecuteTest(TestRepetitions);
+
+							return FReply::Handled();
+						})
+					]
+					+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center).Padding(6, 0, 2, 0)
+					[
+						SNew(STextBlock)
+						.Text(FText::FromString("Passes"))
+					]
+					+ SHorizontalBox::Slot().AutoWidth()
+					[
+						SNew(SBox)
+						.MinDesiredWidth(50.f)
+						[
+							SNew(SSpinBox<int32>)
+							.ToolTipText(FText::FromString("Runs of the whole test plan; more than one reports mean, CV and confidence interval per node"))
+							.MinValue(1)
+							.MaxValue(100)
+							.Value_Lambda([this]() { return TestRepetitions; })
+							.OnValueChanged_Lambda([this](int32 Value) { TestRepetitions = Value; })
+						]
+					]
+				]
+				+ SVerticalBox::Slot().AutoHeight().Padding(4)
 				[
 					SNew(SButton)
 					.Visibility_Lambda([this]() { return SelectedTab == EPTToolTab::Test ? EVisibility::Visible : EVisibility::Collapsed; })
-					.Text(FText::FromString("Start Test"))
+					.Text(FText::FromString("Open Capture..."))
 					.OnClicked_Lambda([this]()
 					{
-						UE_LOG(LogTemp, Log, TEXT("Test button clicked."));
+						OpenCapture();
 
-						ExecuteTest();
+						return FReply::Handled();
+					})
+				]
+				+ SVerticalBox::Slot().AutoHeight().Padding(4)
+				[
+					SNew(SButton)
+					.Visibility_Lambda([this]() { return SelectedTab == EPTToolTab::Test ? EVisibility::Visible : EVisibility::Collapsed; })
+					.Text(FText::FromString("Compare Captures..."))
+					.ToolTipText(FText::FromString("Pick a baseline capture, then a candidate capture"))
+					.OnClicked_Lambda([this]()
+					{
+						CompareCaptures();
 
 						return FReply::Handled();
 					})
 				]
+				+ SVerticalBox::Slot().AutoHeight().Padding(4)
+				[
+					MakeHeatmapRow()
+				]
 			]
 		];
 
@@ -5,6 +5,7 @@
 #include "Toolkits/BaseToolkit.h"
 #include "PTToolSettingsObject.h"
 #include "PTTool/Core/PTSplineManager.h"
+#include "PTTool/Core/PTSplineHeatmap.h"
 // Slate widgets
 #include "Widgets/Views/STableRow.h"
 
@@ -120,6 +121,9 @@ public:
 	void MoveSplineActorRowDown(const FSplineActorRowPtr& Row);
 	void SwapSplineActorOrders(APTSplinePathActor* A, APTSplinePathActor* B);
 
+	// Test tab: bake a capture as a heatmap on the splines in the viewport
+	TSharedRef<SWidget> MakeHeatmapRow();
+
 public:
 	EPTToolTab SelectedTab;
 
@@ -144,6 +148,13 @@ public:
 
 	UPTToolSettingsObject* SettingsObject = nullptr;
 
+	// Runs of the whole test plan per Start Test (-PTToolRepeat)
+	int32 TestRepetitions = 1;
+
+	// Heatmap bake options (EPerfCurve index, statistic per path slice)
+	int32 HeatmapCurve = 0;
+	EPTHeatmapStat HeatmapStat = EPTHeatmapStat::Average;
+
 	UPTSplineManager* InitializePTSplineManager();
 
 private:
@@ -5,6 +5,8 @@
 #include "PTToolLegacyEdMode.h"
 #include "EditorModeRegistry.h"
 #include "PTToolEditorModeToolkit.h"
+#include "PTMetricProvider.h"
+#include "RHI.h"
 
 
 #include "Framework/Docking/TabManager.h"
@@ -60,6 +62,10 @@ void FPTToolModule::StartupModule()
 		.SetDisplayName(LOCTEXT("PTToolLegacyTabDisplayName", "PTTool"))
 		.SetMenuType(ETabSpawnerMenuType::Hidden);
 
+	// RHI counters of the last frame the RHI finished, GPU 0
+	BuiltInMetrics.Add(FPTMetricRegistry::Get().RegisterMetric(TEXT("Draw Calls"), TEXT("calls"), [] { return (float)GNumDrawCallsRHI[0]; }));
+	BuiltInMetrics.Add(FPTMetricRegistry::Get().RegisterMetric(TEXT("Primitives"), TEXT("prims"), [] { return (float)GNumPrimitivesDrawnRHI[0]; }));
+
 	UE_LOG(LogTemp, Log, TEXT("PTToolModule: Legacy FEdMode registered with ID: %s"),
 		*FPTToolLegacyEdMode::EM_PTToolLegacyEdModeId.ToString());
 	
@@ -73,6 +79,12 @@ void FPTToolModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	for (const TSharedRef<IPTMetricProvider>& Metric : BuiltInMetrics)
+	{
+		FPTMetricRegistry::Get().Unregister(Metric);
+	}
+	BuiltInMetrics.Reset();
+
 	// Unregister the dockable tab
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(PTToolLegacyTabId);
 
@@ -4,6 +4,8 @@
 
 #include "Modules/ModuleManager.h"
 
+class IPTMetricProvider;
+
 /**
  * This is the module definition for the editor mode. You can implement custom functionality
  * as your plugin module starts up and shuts down. See IModuleInterface for more extensibility options.
@@ -18,4 +20,8 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	// Draw calls / primitives, recorded with every capture through FPTMetricRegistry
+	TArray<TSharedRef<IPTMetricProvider>> BuiltInMetrics;
 };
@@ -57,6 +57,8 @@ public class PTTool : ModuleRules
 				"ApplicationCore", // <-- 添加：提供平台剪贴板等功能
 				"ImageWrapper", // <-- 添加：用于保存 PNG
 				"UMG", // <-- 添加：用于 FWidgetRenderer
+				"DesktopPlatform", // 打开 .ptcap 文件对话框
+				"Json", // -PTToolBatch 结果摘要
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);